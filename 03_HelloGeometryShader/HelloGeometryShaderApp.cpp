@@ -1,5 +1,6 @@
 #include "HelloGeometryShaderApp.h"
-#include "TeapotModel.h"
+#include "TeapotMeshConverter.h"
+#include "MeshletBuilder.h"
 #include "VulkanBookUtil.h"
 
 #include <glm/gtc/matrix_transform.hpp>
@@ -20,6 +21,28 @@ HelloGeometryShaderApp::HelloGeometryShaderApp()
     vec3(0.0f, 0.0f, 0.0f)
   );
   m_mode = DrawMode_Flat;
+  m_vertexFormat = VertexQuantizer::NormalEncoding_Float32;
+  m_loadedVertexFormat = VertexQuantizer::NormalEncoding_Float32;
+  m_teapotVertexStride = 0;
+  m_isClusterCulling = false;
+  m_visibleClusterCount = 0;
+  m_flatShadeMethod = FlatShadeMethod_GeometryShader;
+  m_normalLineSource = NormalLineSource_GeometryShader;
+  m_normalLineDescriptorSet = VK_NULL_HANDLE;
+  m_normalLineVertexCount = 0;
+  m_isNormalLineDirty = true;
+  m_isTimestampSupported = false;
+  m_timestampPool = VK_NULL_HANDLE;
+  m_timestampPeriod = 1.0;
+  for (auto& v : m_flatShadeMilliseconds)
+  {
+    v = 0.0;
+  }
+  for (auto& v : m_normalLineMilliseconds)
+  {
+    v = 0.0;
+  }
+  m_generateMilliseconds = 0.0;
 }
 
 void HelloGeometryShaderApp::Prepare()
@@ -45,6 +68,23 @@ void HelloGeometryShaderApp::Prepare()
     c.commandBuffer = CreateCommandBuffer(false); // R}hobt@JnԂɂȂ.
   }
 
+  // f`(tbg)/@`Ɛ̎Ԃv^CX^v(C[WƂ 2 Ԃ̊Jn/I).
+  VkPhysicalDeviceProperties physProps;
+  vkGetPhysicalDeviceProperties(m_physicalDevice, &physProps);
+  m_isTimestampSupported = physProps.limits.timestampComputeAndGraphics == VK_TRUE;
+  m_timestampPeriod = physProps.limits.timestampPeriod;
+  m_timestampTargets.assign(imageCount, nullptr);
+  m_hasGenerateTimestamps.assign(imageCount, false);
+  if (m_isTimestampSupported)
+  {
+    VkQueryPoolCreateInfo queryPoolCI{
+      VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO, nullptr, 0,
+      VK_QUERY_TYPE_TIMESTAMP, imageCount * 4, 0
+    };
+    auto result = vkCreateQueryPool(m_device, &queryPoolCI, nullptr, &m_timestampPool);
+    ThrowIfFailed(result, "vkCreateQueryPool failed.");
+  }
+
   PrepareTeapot();
 
   CreatePipeline();
@@ -56,14 +96,22 @@ void HelloGeometryShaderApp::Cleanup()
   {
     DestroyBuffer(ubo);
   }
-  DestroyBuffer(m_teapot.resVertexBuffer);
-  DestroyBuffer(m_teapot.resIndexBuffer);
+  DestroyTeapotModel();
 
   for (auto& v : m_descriptorSets)
   {
     DeallocateDescriptorSet(v);
   }
   m_descriptorSets.clear();
+  for (auto& frame : m_clusterCullFrames)
+  {
+    DestroyBuffer(frame.parameters);
+    DeallocateDescriptorSet(frame.descriptorSet);
+  }
+  m_clusterCullFrames.clear();
+  DestroyBuffer(m_normalLineParameters);
+  DeallocateDescriptorSet(m_normalLineDescriptorSet);
+  vkDestroyQueryPool(m_device, m_timestampPool, nullptr);
 
   for (auto& v : m_pipelines)
   {
@@ -116,6 +164,8 @@ void HelloGeometryShaderApp::Render()
   {
     MsgLoopMinimizedWindow();
   }
+  UpdateTeapotVertexFormat();
+
   uint32_t imageIndex = 0;
   auto result = m_swapchain->AcquireNextImage(&imageIndex, m_presentCompletedSem);
   if (result == VK_ERROR_OUT_OF_DATE_KHR)
@@ -165,14 +215,59 @@ void HelloGeometryShaderApp::Render()
     vkMapMemory(m_device, ubo.memory, 0, VK_WHOLE_SIZE, 0, &p);
     memcpy(p, &shaderParams, sizeof(ShaderParameters));
     vkUnmapMemory(m_device, ubo.memory);
+
+    // bVbg̋E̓fԂȂ̂ŁAƎ_fԂֈڂĔ肷.
+    ClusterCullParameters cullParams{};
+    MeshletBuilder::CalcFrustumPlanes(shaderParams.proj * shaderParams.view * shaderParams.world, cullParams.frustumPlanes);
+    cullParams.eyePosition = inverse(shaderParams.world) * vec4(m_camera.GetPosition(), 1.0f);
+    cullParams.isBackfaceCulling = (TeapotCullMode & VK_CULL_MODE_BACK_BIT) ? 1 : 0;
+    m_visibleClusterCount = 0;
+    for (const auto& meshlet : m_teapotMeshlets)
+    {
+      if (MeshletBuilder::IsVisible(meshlet, cullParams.frustumPlanes, vec3(cullParams.eyePosition), cullParams.isBackfaceCulling != 0))
+      {
+        ++m_visibleClusterCount;
+      }
+    }
+    ubo = m_clusterCullFrames[imageIndex].parameters;
+    vkMapMemory(m_device, ubo.memory, 0, VK_WHOLE_SIZE, 0, &p);
+    memcpy(p, &cullParams, sizeof(ClusterCullParameters));
+    vkUnmapMemory(m_device, ubo.memory);
   }
 
   auto fence = m_commandBuffers[imageIndex].fence;
   vkWaitForFences(m_device, 1, &fence, VK_TRUE, UINT64_MAX);
+  ReadTimestamps(imageIndex);
 
   auto command = m_commandBuffers[imageIndex].commandBuffer;
 
   vkBeginCommandBuffer(command, &commandBI);
+  if (m_isTimestampSupported)
+  {
+    vkCmdResetQueryPool(command, m_timestampPool, imageIndex * 4, 4);
+  }
+  m_timestampTargets[imageIndex] = nullptr;
+  m_hasGenerateTimestamps[imageIndex] = false;
+
+  if (m_isClusterCulling)
+  {
+    DispatchClusterCulling(command, imageIndex);
+  }
+  // @̐̓fǂݍݒƂ.
+  if (m_mode == DrawMode_NormalVector && m_normalLineSource == NormalLineSource_CachedBuffer && m_isNormalLineDirty)
+  {
+    if (m_isTimestampSupported)
+    {
+      vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timestampPool, imageIndex * 4 + 2);
+    }
+    DispatchNormalLines(command);
+    if (m_isTimestampSupported)
+    {
+      vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timestampPool, imageIndex * 4 + 3);
+      m_hasGenerateTimestamps[imageIndex] = true;
+    }
+    m_isNormalLineDirty = false;
+  }
   vkCmdBeginRenderPass(command, &rpBI, VK_SUBPASS_CONTENTS_INLINE);
 
   auto extent = m_swapchain->GetSurfaceExtent();
@@ -184,17 +279,51 @@ void HelloGeometryShaderApp::Render()
   vkCmdSetScissor(command, 0, 1, &scissor);
   vkCmdSetViewport(command, 0, 1, &viewport);
 
+  // NX^JÓARs[gVF[_[l߂CfbNXƕ`g.
+  const auto& cullFrame = m_clusterCullFrames[imageIndex];
+  auto indexBuffer = m_isClusterCulling ? cullFrame.indexBuffer.buffer : m_teapot.resIndexBuffer.buffer;
+  auto drawTeapot = [&]() {
+    if (m_isClusterCulling)
+    {
+      vkCmdDrawIndexedIndirect(command, cullFrame.drawCommand.buffer, 0, 1, sizeof(VkDrawIndexedIndirectCommand));
+    }
+    else
+    {
+      vkCmdDrawIndexed(command, m_teapot.indexCount, 1, 0, 0, 0);
+    }
+  };
+
   if (m_mode == DrawMode_Flat)
   {
     // tbgVF[fBO.
-    auto pipeline = m_pipelines[FlatShadePipeine];
     auto layout = GetPipelineLayout("u1");
-    vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
     vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &m_descriptorSets[imageIndex], 0, nullptr);
-    vkCmdBindIndexBuffer(command, m_teapot.resIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
     VkDeviceSize offsets[] = { 0 };
-    vkCmdBindVertexBuffers(command, 0, 1, &m_teapot.resVertexBuffer.buffer, offsets);
-    vkCmdDrawIndexed(command, m_teapot.indexCount, 1, 0, 0, 0);
+    if (m_isTimestampSupported)
+    {
+      vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timestampPool, imageIndex * 4);
+    }
+    if (m_flatShadeMethod == FlatShadeMethod_ProvokingVertex)
+    {
+      // _𕡐ʂ̃bVȂ̂ŁANX^JǑʂ͎gȂ.
+      vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelines[FlatProvokingPipeline]);
+      vkCmdBindIndexBuffer(command, m_flatTeapot.resIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+      vkCmdBindVertexBuffers(command, 0, 1, &m_flatTeapot.resVertexBuffer.buffer, offsets);
+      vkCmdDrawIndexed(command, m_flatTeapot.indexCount, 1, 0, 0, 0);
+    }
+    else
+    {
+      auto pipeline = m_flatShadeMethod == FlatShadeMethod_Derivative ? m_pipelines[FlatDerivativePipeline] : m_pipelines[FlatShadePipeine];
+      vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+      vkCmdBindIndexBuffer(command, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+      vkCmdBindVertexBuffers(command, 0, 1, &m_teapot.resVertexBuffer.buffer, offsets);
+      drawTeapot();
+    }
+    if (m_isTimestampSupported)
+    {
+      vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timestampPool, imageIndex * 4 + 1);
+      m_timestampTargets[imageIndex] = &m_flatShadeMilliseconds[m_flatShadeMethod];
+    }
   }
 
   if (m_mode == DrawMode_NormalVector)
@@ -204,15 +333,34 @@ void HelloGeometryShaderApp::Render()
     auto layout = GetPipelineLayout("u1");
     vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
     vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &m_descriptorSets[imageIndex], 0, nullptr);
-    vkCmdBindIndexBuffer(command, m_teapot.resIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdBindIndexBuffer(command, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
     VkDeviceSize offsets[] = { 0 };
     vkCmdBindVertexBuffers(command, 0, 1, &m_teapot.resVertexBuffer.buffer, offsets);
-    vkCmdDrawIndexed(command, m_teapot.indexCount, 1, 0, 0, 0);
+    drawTeapot();
 
     // @`.
-    pipeline = m_pipelines[NormalVectorPipeline];
-    vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
-    vkCmdDrawIndexed(command, m_teapot.indexCount, 1, 0, 0, 0);
+    if (m_isTimestampSupported)
+    {
+      vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timestampPool, imageIndex * 4);
+    }
+    if (m_normalLineSource == NormalLineSource_CachedBuffer)
+    {
+      pipeline = m_pipelines[NormalLinePipeline];
+      vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+      vkCmdBindVertexBuffers(command, 0, 1, &m_normalLineBuffer.buffer, offsets);
+      vkCmdDraw(command, m_normalLineVertexCount, 1, 0, 0);
+    }
+    else
+    {
+      pipeline = m_pipelines[NormalVectorPipeline];
+      vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+      drawTeapot();
+    }
+    if (m_isTimestampSupported)
+    {
+      vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timestampPool, imageIndex * 4 + 1);
+      m_timestampTargets[imageIndex] = &m_normalLineMilliseconds[m_normalLineSource];
+    }
   }
 
   RenderHUD(command);
@@ -278,10 +426,6 @@ bool HelloGeometryShaderApp::OnSizeChanged(uint32_t width, uint32_t height)
 
 void HelloGeometryShaderApp::PrepareTeapot()
 {
-  std::vector<TeapotModel::Vertex> vertices(std::begin(TeapotModel::TeapotVerticesPN), std::end(TeapotModel::TeapotVerticesPN));
-  std::vector<uint32_t> indices(std::begin(TeapotModel::TeapotIndices), std::end(TeapotModel::TeapotIndices));
-  m_teapot = CreateSimpleModel(vertices, indices);
-
   auto dsLayout = GetDescriptorSetLayout("u1");
 
   // fBXNv^Zbg.
@@ -317,28 +461,185 @@ void HelloGeometryShaderApp::PrepareTeapot()
     };
     vkUpdateDescriptorSets(m_device, 1, &writeDescSet, 0, nullptr);
   }
+
+  // NX^JOp̒萔obt@ƃfBXNv^Zbg.
+  // QƂobt@̓fƈꏏɍ̂ŁA݂ LoadTeapotModel ōs.
+  auto cullParams = CreateUniformBuffers(uint32_t(sizeof(ClusterCullParameters)), imageCount);
+  m_clusterCullFrames.resize(imageCount);
+  for (uint32_t i = 0; i < imageCount; ++i)
+  {
+    m_clusterCullFrames[i].parameters = cullParams[i];
+    m_clusterCullFrames[i].descriptorSet = AllocateDescriptorSet(GetDescriptorSetLayout("compute_cull"));
+  }
+  // @̐̐p.
+  m_normalLineParameters = CreateUniformBuffers(uint32_t(sizeof(NormalLineParameters)), 1)[0];
+  m_normalLineDescriptorSet = AllocateDescriptorSet(GetDescriptorSetLayout("compute_normal_line"));
+
+  LoadTeapotModel(VertexQuantizer::NormalEncoding(m_vertexFormat));
 }
 
-void HelloGeometryShaderApp::CreatePipeline()
+void HelloGeometryShaderApp::LoadTeapotModel(VertexQuantizer::NormalEncoding encoding)
 {
-  auto stride = uint32_t(sizeof(TeapotModel::Vertex));
-  VkVertexInputBindingDescription vibDesc{
-      0, // binding
-      stride,
-      VK_VERTEX_INPUT_RATE_VERTEX
-  };
-
-  array<VkVertexInputAttributeDescription, 2> inputAttribs{
+  // bVt@C TeapotMeshConverter ŎOɏoĂ.
+  MappedMeshFile meshFile;
+  if (!meshFile.Open(TeapotMeshConverter::GetFileName(encoding)))
+  {
+    throw book_util::VulkanException(std::string("Failed to load ") + TeapotMeshConverter::GetFileName(encoding) + " (run TeapotMeshConverter)");
+  }
+  m_teapot = CreateSimpleModel(
+    meshFile.GetVertexData(0), meshFile.GetVertexStride(0), meshFile.GetVertexCount(),
+    meshFile.GetIndexData(), meshFile.GetIndexCount());
+  meshFile.GetVertexInputDescriptions(m_teapotVertexBindings, m_teapotVertexAttributes);
+  m_teapotVertexStride = meshFile.GetVertexStride(0);
+  m_teapotOptimizeResult.before.acmr = meshFile.GetHeader().sourceAcmr;
+  m_teapotOptimizeResult.before.atvr = meshFile.GetHeader().sourceAtvr;
+  m_teapotOptimizeResult.after = MeshOptimizer::AnalyzeVertexCache(meshFile.GetIndexData(), meshFile.GetIndexCount(), meshFile.GetVertexCount());
+
+  // ʎq`ł͒_VF[_[ňʒuƖ@𕜌.
+  m_teapotDecodeParams = VertexQuantizer::GetDecodeParameters(meshFile);
+  m_teapotDecodeInfo = VertexQuantizer::GetSpecializationInfo(m_teapotDecodeParams);
+  m_loadedVertexFormat = encoding;
+
+  // tbgVF[fBOpɁAOp`̐擪̒_𑼂ƏdȂȂ悤IсA̖@ʖ@Œu.
+  {
+    std::vector<uint32_t> indices(meshFile.GetIndexData(), meshFile.GetIndexData() + meshFile.GetIndexCount());
+    auto vertexCount = meshFile.GetVertexCount();
+    auto duplicates = MeshOptimizer::GenerateProvokingIndices(indices, vertexCount);
+    auto stride = meshFile.GetVertexStride(0);
+    auto src = static_cast<const uint8_t*>(meshFile.GetVertexData(0));
+    std::vector<uint8_t> vertices(src, src + size_t(stride) * vertexCount);
+    for (auto v : duplicates)
     {
-      { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(TeapotModel::Vertex, Position) },
-      { 1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(TeapotModel::Vertex, Normal) },
+      vertices.insert(vertices.end(), src + size_t(stride) * v, src + size_t(stride) * (v + 1));
     }
-  };
+    uint32_t normalOffset = 0;
+    for (const auto& attr : m_teapotVertexAttributes)
+    {
+      if (attr.location == MeshFile::Semantic_Normal)
+      {
+        normalOffset = attr.offset;
+      }
+    }
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+      // flatGS Ɠߕ.
+      auto p0 = VertexQuantizer::ReadPosition(&vertices[size_t(stride) * indices[i + 0]], m_teapotDecodeParams);
+      auto p1 = VertexQuantizer::ReadPosition(&vertices[size_t(stride) * indices[i + 1]], m_teapotDecodeParams);
+      auto p2 = VertexQuantizer::ReadPosition(&vertices[size_t(stride) * indices[i + 2]], m_teapotDecodeParams);
+      auto normal = normalize(cross(normalize(p1 - p0), normalize(p2 - p0)));
+      VertexQuantizer::WriteNormal(&vertices[size_t(stride) * indices[i]], normalOffset, normal, encoding);
+    }
+    m_flatTeapot = CreateSimpleModel(
+      vertices.data(), stride, uint32_t(vertexCount + duplicates.size()),
+      indices.data(), uint32_t(indices.size()));
+  }
+
+  // bVbg̓Rs[gVF[_[QƂ.
+  if (meshFile.GetMeshletCount() == 0)
+  {
+    throw book_util::VulkanException(std::string("No meshlets in ") + TeapotMeshConverter::GetFileName(encoding));
+  }
+  m_teapotMeshlets.assign(meshFile.GetMeshletData(), meshFile.GetMeshletData() + meshFile.GetMeshletCount());
+  auto meshletBufferSize = uint32_t(sizeof(MeshFile::Meshlet) * m_teapotMeshlets.size());
+  m_meshletBuffer = CreateBuffer(
+    meshletBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  WriteToHostVisibleMemory(m_meshletBuffer.memory, meshletBufferSize, m_teapotMeshlets.data());
+
+  // JOʂ̃CfbNX͌̃CfbNX𒴂Ȃ.
+  auto indexBufferSize = uint32_t(sizeof(uint32_t) * m_teapot.indexCount);
+  for (auto& frame : m_clusterCullFrames)
+  {
+    frame.indexBuffer = CreateBuffer(
+      indexBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    frame.drawCommand = CreateBuffer(
+      uint32_t(sizeof(VkDrawIndexedIndirectCommand)),
+      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    VkDescriptorBufferInfo parameters{ frame.parameters.buffer, 0, VK_WHOLE_SIZE };
+    VkDescriptorBufferInfo meshlets{ m_meshletBuffer.buffer, 0, VK_WHOLE_SIZE };
+    VkDescriptorBufferInfo srcIndices{ m_teapot.resIndexBuffer.buffer, 0, VK_WHOLE_SIZE };
+    VkDescriptorBufferInfo dstIndices{ frame.indexBuffer.buffer, 0, VK_WHOLE_SIZE };
+    VkDescriptorBufferInfo drawCommand{ frame.drawCommand.buffer, 0, VK_WHOLE_SIZE };
+    std::vector<VkWriteDescriptorSet> writeDS = {
+      book_util::CreateWriteDescriptorSet(frame.descriptorSet, 0, &parameters),
+      book_util::CreateWriteDescriptorSet(frame.descriptorSet, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &meshlets),
+      book_util::CreateWriteDescriptorSet(frame.descriptorSet, 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &srcIndices),
+      book_util::CreateWriteDescriptorSet(frame.descriptorSet, 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &dstIndices),
+      book_util::CreateWriteDescriptorSet(frame.descriptorSet, 4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &drawCommand),
+    };
+    vkUpdateDescriptorSets(m_device, uint32_t(writeDS.size()), writeDS.data(), 0, nullptr);
+  }
+
+  // @̐̊i[. g͕`掞ɕKvɂȂĂ.
+  auto triangleCount = m_teapot.indexCount / 3;
+  m_normalLineVertexCount = triangleCount * 2;
+  m_normalLineBuffer = CreateBuffer(
+    uint32_t(sizeof(vec4) * m_normalLineVertexCount),
+    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  NormalLineParameters lineParams{ triangleCount, m_teapotVertexStride / 4, 0.1f };
+  WriteToHostVisibleMemory(m_normalLineParameters.memory, uint32_t(sizeof(lineParams)), &lineParams);
+  {
+    VkDescriptorBufferInfo parameters{ m_normalLineParameters.buffer, 0, VK_WHOLE_SIZE };
+    VkDescriptorBufferInfo vertices{ m_teapot.resVertexBuffer.buffer, 0, VK_WHOLE_SIZE };
+    VkDescriptorBufferInfo indices{ m_teapot.resIndexBuffer.buffer, 0, VK_WHOLE_SIZE };
+    VkDescriptorBufferInfo lines{ m_normalLineBuffer.buffer, 0, VK_WHOLE_SIZE };
+    std::vector<VkWriteDescriptorSet> writeDS = {
+      book_util::CreateWriteDescriptorSet(m_normalLineDescriptorSet, 0, &parameters),
+      book_util::CreateWriteDescriptorSet(m_normalLineDescriptorSet, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &vertices),
+      book_util::CreateWriteDescriptorSet(m_normalLineDescriptorSet, 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &indices),
+      book_util::CreateWriteDescriptorSet(m_normalLineDescriptorSet, 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &lines),
+    };
+    vkUpdateDescriptorSets(m_device, uint32_t(writeDS.size()), writeDS.data(), 0, nullptr);
+  }
+  m_isNormalLineDirty = true;
+}
+
+void HelloGeometryShaderApp::DestroyTeapotModel()
+{
+  DestroyBuffer(m_teapot.resVertexBuffer);
+  DestroyBuffer(m_teapot.resIndexBuffer);
+  DestroyBuffer(m_flatTeapot.resVertexBuffer);
+  DestroyBuffer(m_flatTeapot.resIndexBuffer);
+  DestroyBuffer(m_meshletBuffer);
+  DestroyBuffer(m_normalLineBuffer);
+  for (auto& frame : m_clusterCullFrames)
+  {
+    DestroyBuffer(frame.indexBuffer);
+    DestroyBuffer(frame.drawCommand);
+  }
+}
+
+void HelloGeometryShaderApp::UpdateTeapotVertexFormat()
+{
+  auto encoding = VertexQuantizer::NormalEncoding(m_vertexFormat);
+  if (encoding == m_loadedVertexFormat)
+  {
+    return;
+  }
+  vkDeviceWaitIdle(m_device);
+  DestroyTeapotModel();
+  for (auto& v : m_pipelines)
+  {
+    vkDestroyPipeline(m_device, v.second, nullptr);
+  }
+  m_pipelines.clear();
+
+  LoadTeapotModel(encoding);
+  CreatePipeline();
+}
+
+void HelloGeometryShaderApp::CreatePipeline()
+{
+  // _͂̓bVt@C̃Xg[`ɏ].
   VkPipelineVertexInputStateCreateInfo pipelineVisCI{
     VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
     nullptr, 0,
-    1, &vibDesc,
-    uint32_t(inputAttribs.size()), inputAttribs.data()
+    uint32_t(m_teapotVertexBindings.size()), m_teapotVertexBindings.data(),
+    uint32_t(m_teapotVertexAttributes.size()), m_teapotVertexAttributes.data()
   };
 
   auto blendAttachmentState = book_util::GetOpaqueColorBlendAttachmentState();
@@ -380,7 +681,7 @@ void HelloGeometryShaderApp::CreatePipeline()
   auto renderPass = GetRenderPass("default");
   auto layout = GetPipelineLayout("u1");
 
-  auto rasterizerState = book_util::GetDefaultRasterizerState();
+  auto rasterizerState = book_util::GetDefaultRasterizerState(TeapotCullMode);
   auto dsState = book_util::GetDefaultDepthStencilState();
 
   // DynamicState
@@ -421,6 +722,7 @@ void HelloGeometryShaderApp::CreatePipeline()
       book_util::LoadShader(m_device, "flatGS.spv", VK_SHADER_STAGE_GEOMETRY_BIT),
       book_util::LoadShader(m_device, "flatFS.spv", VK_SHADER_STAGE_FRAGMENT_BIT),
     };
+    shaderStages[0].pSpecializationInfo = &m_teapotDecodeInfo;
     pipelineCI.pStages = shaderStages.data();
     pipelineCI.stageCount = uint32_t(shaderStages.size());
 
@@ -431,6 +733,42 @@ void HelloGeometryShaderApp::CreatePipeline()
     book_util::DestroyShaderModules(m_device, shaderStages);
     m_pipelines[FlatShadePipeine] = pipeline;
   }
+  {
+    // WIgVF[_[gȂtbgVF[fBO(ʒu̕Δ).
+    std::vector<VkPipelineShaderStageCreateInfo> shaderStages
+    {
+      book_util::LoadShader(m_device, "flatDerivativeVS.spv", VK_SHADER_STAGE_VERTEX_BIT),
+      book_util::LoadShader(m_device, "flatDerivativeFS.spv", VK_SHADER_STAGE_FRAGMENT_BIT),
+    };
+    shaderStages[0].pSpecializationInfo = &m_teapotDecodeInfo;
+    pipelineCI.pStages = shaderStages.data();
+    pipelineCI.stageCount = uint32_t(shaderStages.size());
+
+    VkPipeline pipeline;
+    result = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &pipeline);
+    ThrowIfFailed(result, "vkCreateGraphicsPipeline Failed.");
+
+    book_util::DestroyShaderModules(m_device, shaderStages);
+    m_pipelines[FlatDerivativePipeline] = pipeline;
+  }
+  {
+    // WIgVF[_[gȂtbgVF[fBO(provoking vertex  flat ).
+    std::vector<VkPipelineShaderStageCreateInfo> shaderStages
+    {
+      book_util::LoadShader(m_device, "flatProvokingVS.spv", VK_SHADER_STAGE_VERTEX_BIT),
+      book_util::LoadShader(m_device, "flatProvokingFS.spv", VK_SHADER_STAGE_FRAGMENT_BIT),
+    };
+    shaderStages[0].pSpecializationInfo = &m_teapotDecodeInfo;
+    pipelineCI.pStages = shaderStages.data();
+    pipelineCI.stageCount = uint32_t(shaderStages.size());
+
+    VkPipeline pipeline;
+    result = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &pipeline);
+    ThrowIfFailed(result, "vkCreateGraphicsPipeline Failed.");
+
+    book_util::DestroyShaderModules(m_device, shaderStages);
+    m_pipelines[FlatProvokingPipeline] = pipeline;
+  }
 
   {
     // @`ppCvC̍\z.
@@ -440,6 +778,7 @@ void HelloGeometryShaderApp::CreatePipeline()
       book_util::LoadShader(m_device, "drawNormalGS.spv", VK_SHADER_STAGE_GEOMETRY_BIT),
       book_util::LoadShader(m_device, "drawNormalFS.spv", VK_SHADER_STAGE_FRAGMENT_BIT),
     };
+    shaderStages[0].pSpecializationInfo = &m_teapotDecodeInfo;
     pipelineCI.pStages = shaderStages.data();
     pipelineCI.stageCount = uint32_t(shaderStages.size());
 
@@ -457,6 +796,7 @@ void HelloGeometryShaderApp::CreatePipeline()
       book_util::LoadShader(m_device, "shaderVS.spv", VK_SHADER_STAGE_VERTEX_BIT),
       book_util::LoadShader(m_device, "shaderFS.spv", VK_SHADER_STAGE_FRAGMENT_BIT),
     };
+    shaderStages[0].pSpecializationInfo = &m_teapotDecodeInfo;
     pipelineCI.pStages = shaderStages.data();
     pipelineCI.stageCount = uint32_t(shaderStages.size());
 
@@ -467,7 +807,153 @@ void HelloGeometryShaderApp::CreatePipeline()
     book_util::DestroyShaderModules(m_device, shaderStages);
     m_pipelines[SmoothShadePipeline] = pipeline;
   }
+  {
+    // Rs[gVF[_[ō@̐`pCvC̍\z.
+    VkVertexInputBindingDescription lineBinding{ 0, uint32_t(sizeof(vec4)), VK_VERTEX_INPUT_RATE_VERTEX };
+    VkVertexInputAttributeDescription lineAttribute{ 0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, 0 };
+    VkPipelineVertexInputStateCreateInfo lineVisCI{
+      VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+      nullptr, 0,
+      1, &lineBinding,
+      1, &lineAttribute
+    };
+    auto lineInputAssemblyCI = inputAssemblyCI;
+    lineInputAssemblyCI.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
 
+    std::vector<VkPipelineShaderStageCreateInfo> shaderStages
+    {
+      book_util::LoadShader(m_device, "normalLineVS.spv", VK_SHADER_STAGE_VERTEX_BIT),
+      book_util::LoadShader(m_device, "drawNormalFS.spv", VK_SHADER_STAGE_FRAGMENT_BIT),
+    };
+    pipelineCI.pStages = shaderStages.data();
+    pipelineCI.stageCount = uint32_t(shaderStages.size());
+    pipelineCI.pVertexInputState = &lineVisCI;
+    pipelineCI.pInputAssemblyState = &lineInputAssemblyCI;
+
+    VkPipeline pipeline;
+    result = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &pipeline);
+    ThrowIfFailed(result, "vkCreateGraphicsPipeline Failed.");
+
+    book_util::DestroyShaderModules(m_device, shaderStages);
+    m_pipelines[NormalLinePipeline] = pipeline;
+  }
+  {
+    // NX^JOp̃Rs[gpCvC̍\z.
+    auto computeStage = book_util::LoadShader(m_device, "clusterCullCS.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+    VkComputePipelineCreateInfo computePipelineCI{
+      VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO, nullptr, 0,
+      computeStage,
+      GetPipelineLayout("compute_cull"),
+      VK_NULL_HANDLE,
+      0,
+    };
+    VkPipeline pipeline;
+    result = vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &computePipelineCI, nullptr, &pipeline);
+    ThrowIfFailed(result, "vkCreateComputePipelines Failed.");
+    vkDestroyShaderModule(m_device, computeStage.module, nullptr);
+    m_pipelines[ClusterCullPipeline] = pipeline;
+  }
+  {
+    // @̐Rs[gpCvC̍\z. _͒̕_VF[_[Ɠꉻ萔ōs.
+    auto computeStage = book_util::LoadShader(m_device, "normalLineCS.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+    computeStage.pSpecializationInfo = &m_teapotDecodeInfo;
+    VkComputePipelineCreateInfo computePipelineCI{
+      VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO, nullptr, 0,
+      computeStage,
+      GetPipelineLayout("compute_normal_line"),
+      VK_NULL_HANDLE,
+      0,
+    };
+    VkPipeline pipeline;
+    result = vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &computePipelineCI, nullptr, &pipeline);
+    ThrowIfFailed(result, "vkCreateComputePipelines Failed.");
+    vkDestroyShaderModule(m_device, computeStage.module, nullptr);
+    m_pipelines[NormalLineGeneratePipeline] = pipeline;
+  }
+}
+
+void HelloGeometryShaderApp::DispatchClusterCulling(VkCommandBuffer command, uint32_t imageIndex)
+{
+  const auto& frame = m_clusterCullFrames[imageIndex];
+
+  // CfbNX 0 ɖ߂Ă珑o.
+  VkDrawIndexedIndirectCommand args{ 0, 1, 0, 0, 0 };
+  vkCmdUpdateBuffer(command, frame.drawCommand.buffer, 0, sizeof(args), &args);
+  VkBufferMemoryBarrier barrier{
+    VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER, nullptr,
+    VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+    frame.drawCommand.buffer, 0, VK_WHOLE_SIZE
+  };
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+    0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+  vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelines[ClusterCullPipeline]);
+  vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_COMPUTE, GetPipelineLayout("compute_cull"), 0, 1, &frame.descriptorSet, 0, nullptr);
+  vkCmdDispatch(command, uint32_t(m_teapotMeshlets.size()), 1, 1);
+
+  // CfbNXobt@, `ƂĎQƂł悤ɂ.
+  std::array<VkBufferMemoryBarrier, 2> barriers = { barrier, barrier };
+  barriers[0].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  barriers[0].dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+  barriers[1].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  barriers[1].dstAccessMask = VK_ACCESS_INDEX_READ_BIT;
+  barriers[1].buffer = frame.indexBuffer.buffer;
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+    VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+    0, 0, nullptr, uint32_t(barriers.size()), barriers.data(), 0, nullptr);
+}
+
+void HelloGeometryShaderApp::DispatchNormalLines(VkCommandBuffer command)
+{
+  vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelines[NormalLineGeneratePipeline]);
+  vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_COMPUTE, GetPipelineLayout("compute_normal_line"), 0, 1, &m_normalLineDescriptorSet, 0, nullptr);
+  auto triangleCount = m_normalLineVertexCount / 2;
+  vkCmdDispatch(command, (triangleCount + 63) / 64, 1, 1);
+
+  // _obt@ƂĎQƂł悤ɂ.
+  VkBufferMemoryBarrier barrier{
+    VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER, nullptr,
+    VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+    m_normalLineBuffer.buffer, 0, VK_WHOLE_SIZE
+  };
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+    0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+void HelloGeometryShaderApp::ReadTimestamps(uint32_t imageIndex)
+{
+  if (!m_isTimestampSupported)
+  {
+    return;
+  }
+  // tFX҂Ȃ̂Ōʂ͎擾ł.
+  uint64_t timestamps[2];
+  auto target = m_timestampTargets[imageIndex];
+  if (target != nullptr)
+  {
+    auto result = vkGetQueryPoolResults(
+      m_device, m_timestampPool, imageIndex * 4, 2,
+      sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result == VK_SUCCESS)
+    {
+      *target = double(timestamps[1] - timestamps[0]) * m_timestampPeriod * 1.0e-6;
+    }
+  }
+  if (m_hasGenerateTimestamps[imageIndex])
+  {
+    auto result = vkGetQueryPoolResults(
+      m_device, m_timestampPool, imageIndex * 4 + 2, 2,
+      sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result == VK_SUCCESS)
+    {
+      m_generateMilliseconds = double(timestamps[1] - timestamps[0]) * m_timestampPeriod * 1.0e-6;
+    }
+  }
 }
 
 void HelloGeometryShaderApp::RenderHUD(VkCommandBuffer command)
@@ -481,6 +967,29 @@ void HelloGeometryShaderApp::RenderHUD(VkCommandBuffer command)
   ImGui::Begin("Information");
   ImGui::Text("Framerate: %.1f FPS", ImGui::GetIO().Framerate);
   ImGui::Combo("Mode", (int*)&m_mode, "Flat\0NormalVector\0\0");
+  if (m_mode == DrawMode_Flat)
+  {
+    ImGui::Combo("Flat Shading", &m_flatShadeMethod, "GeometryShader\0Derivative\0ProvokingVertex\0\0");
+    ImGui::Text("GPU flat: GS %.3f ms, Derivative %.3f ms, Provoking %.3f ms",
+      m_flatShadeMilliseconds[FlatShadeMethod_GeometryShader],
+      m_flatShadeMilliseconds[FlatShadeMethod_Derivative],
+      m_flatShadeMilliseconds[FlatShadeMethod_ProvokingVertex]);
+    ImGui::Text("Provoking vertex mesh: %u vertices", m_flatTeapot.vertexCount);
+  }
+  if (m_mode == DrawMode_NormalVector)
+  {
+    ImGui::Combo("Normal Lines", &m_normalLineSource, "GeometryShader\0CachedBuffer\0\0");
+    ImGui::Text("GPU normal lines: GS %.3f ms, Cached %.3f ms",
+      m_normalLineMilliseconds[NormalLineSource_GeometryShader], m_normalLineMilliseconds[NormalLineSource_CachedBuffer]);
+    ImGui::Text("GPU normal line generation: %.3f ms", m_generateMilliseconds);
+  }
+  ImGui::Text("Teapot ACMR: %.3f -> %.3f, ATVR: %.3f -> %.3f",
+    m_teapotOptimizeResult.before.acmr, m_teapotOptimizeResult.after.acmr,
+    m_teapotOptimizeResult.before.atvr, m_teapotOptimizeResult.after.atvr);
+  ImGui::Combo("Vertex Format", &m_vertexFormat, "Float32\0Unorm16 + Oct16\0Unorm16 + 10:10:10:2\0\0");
+  ImGui::Text("Vertex Stride: %u bytes", m_teapotVertexStride);
+  ImGui::Checkbox("Cluster Culling", &m_isClusterCulling);
+  ImGui::Text("Visible Clusters: %u / %u", m_visibleClusterCount, uint32_t(m_teapotMeshlets.size()));
   ImGui::End();
 
   ImGui::Render();
@@ -510,6 +1019,35 @@ void HelloGeometryShaderApp::CreateSampleLayouts()
   ThrowIfFailed(result, "vkCreateDescriptorSetLayout Failed (u1).");
   RegisterLayout("u1", dsLayout); dsLayout = VK_NULL_HANDLE;
 
+  // NX^JOp.
+  // 0: uniformBuffer, 1: bVbg, 2: ̃CfbNX, 3: l߂CfbNX, 4: `.
+  dsLayoutBindings = {
+    { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, },
+    { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, },
+    { 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, },
+    { 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, },
+    { 4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, },
+  };
+  dsLayoutCI.pBindings = dsLayoutBindings.data();
+  dsLayoutCI.bindingCount = uint32_t(dsLayoutBindings.size());
+  result = vkCreateDescriptorSetLayout(m_device, &dsLayoutCI, nullptr, &dsLayout);
+  ThrowIfFailed(result, "vkCreateDescriptorSetLayout Failed (compute_cull).");
+  RegisterLayout("compute_cull", dsLayout); dsLayout = VK_NULL_HANDLE;
+
+  // @̐̐p.
+  // 0: uniformBuffer, 1: _, 2: CfbNX, 3: ̒_.
+  dsLayoutBindings = {
+    { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, },
+    { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, },
+    { 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, },
+    { 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, },
+  };
+  dsLayoutCI.pBindings = dsLayoutBindings.data();
+  dsLayoutCI.bindingCount = uint32_t(dsLayoutBindings.size());
+  result = vkCreateDescriptorSetLayout(m_device, &dsLayoutCI, nullptr, &dsLayout);
+  ThrowIfFailed(result, "vkCreateDescriptorSetLayout Failed (compute_normal_line).");
+  RegisterLayout("compute_normal_line", dsLayout); dsLayout = VK_NULL_HANDLE;
+
 
   // pCvCCAEg̏.
   VkPipelineLayoutCreateInfo layoutCI{
@@ -523,4 +1061,15 @@ void HelloGeometryShaderApp::CreateSampleLayouts()
   ThrowIfFailed(result, "vkCreatePipelineLayout Failed(u1).");
   RegisterLayout("u1", layout); layout = VK_NULL_HANDLE;
 
+  dsLayout = GetDescriptorSetLayout("compute_cull");
+  layoutCI.pSetLayouts = &dsLayout;
+  result = vkCreatePipelineLayout(m_device, &layoutCI, nullptr, &layout);
+  ThrowIfFailed(result, "vkCreatePipelineLayout Failed(compute_cull).");
+  RegisterLayout("compute_cull", layout); layout = VK_NULL_HANDLE;
+
+  dsLayout = GetDescriptorSetLayout("compute_normal_line");
+  layoutCI.pSetLayouts = &dsLayout;
+  result = vkCreatePipelineLayout(m_device, &layoutCI, nullptr, &layout);
+  ThrowIfFailed(result, "vkCreatePipelineLayout Failed(compute_normal_line).");
+  RegisterLayout("compute_normal_line", layout); layout = VK_NULL_HANDLE;
 }
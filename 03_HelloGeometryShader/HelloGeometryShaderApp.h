@@ -2,6 +2,9 @@
 #include "VulkanAppBase.h"
 #include <glm/glm.hpp>
 #include "Camera.h"
+#include "MeshOptimizer.h"
+#include "MeshFile.h"
+#include "VertexQuantizer.h"
 
 class HelloGeometryShaderApp : public VulkanAppBase
 {
@@ -24,6 +27,20 @@ public:
     glm::mat4 proj;
     glm::vec4 lightDir;
   };
+  // NX^JOp. ʂƎ_̓f.
+  struct ClusterCullParameters
+  {
+    glm::vec4 frustumPlanes[6];
+    glm::vec4 eyePosition;
+    uint32_t isBackfaceCulling; // 0 Ȃ@~ɂ锻sȂ.
+  };
+  // @̐̐p.
+  struct NormalLineParameters
+  {
+    uint32_t triangleCount;
+    uint32_t vertexStride; // 4 oCgP.
+    float lineLength;
+  };
 
 private:
   // {AvŎgp郌CAEg(fBXNv^CAEg/pCvCCAEg)쐬.
@@ -33,6 +50,19 @@ private:
   void PrepareTeapot();
   void CreatePipeline();
 
+  // w肵_`̃bVt@CeB[|bgǂݍ.
+  void LoadTeapotModel(VertexQuantizer::NormalEncoding encoding);
+  void DestroyTeapotModel();
+  // HUD Œ_`ύXĂ΁AfƃpCvC蒼.
+  void UpdateTeapotVertexFormat();
+
+  // 郁bVbg̎Op`CfbNXobt@ɋl߁AԐڕ`̈o.
+  void DispatchClusterCulling(VkCommandBuffer command, uint32_t imageIndex);
+  // Op`Ƃ̖@̐𒸓_obt@ɏo.
+  void DispatchNormalLines(VkCommandBuffer command);
+  // tFX҂ɁÃC[WŌvԂo.
+  void ReadTimestamps(uint32_t imageIndex);
+
   void RenderHUD(VkCommandBuffer command);
 private:
   ImageObject m_depthBuffer;
@@ -52,11 +82,76 @@ private:
 
   Camera m_camera;
   ModelData m_teapot;
+  ModelData m_flatTeapot; // Op`̐擪̒_ɖʖ@.
+  MeshOptimizer::Result m_teapotOptimizeResult; // _LbV̍œKO(ϊ)ƌ(ǂݍ񂾃bV).
+  std::vector<VkVertexInputBindingDescription> m_teapotVertexBindings;
+  std::vector<VkVertexInputAttributeDescription> m_teapotVertexAttributes;
+  uint32_t m_teapotVertexStride;
+  VertexQuantizer::DecodeParameters m_teapotDecodeParams;
+  VkSpecializationInfo m_teapotDecodeInfo; // _VF[_[̓ꉻ萔(m_teapotDecodeParams Q).
+  int m_vertexFormat; // HUD őI𒆂̌`(VertexQuantizer::NormalEncoding).
+  VertexQuantizer::NormalEncoding m_loadedVertexFormat;
   std::vector<BufferObject> m_uniformBuffers;
 
+  std::vector<MeshFile::Meshlet> m_teapotMeshlets;
+  BufferObject m_meshletBuffer;
+  struct ClusterCullFrame
+  {
+    BufferObject parameters;  // ClusterCullParameters.
+    BufferObject indexBuffer; // 郁bVbg̎Op`l߂.
+    BufferObject drawCommand; // VkDrawIndexedIndirectCommand.
+    VkDescriptorSet descriptorSet;
+  };
+  std::vector<ClusterCullFrame> m_clusterCullFrames;
+  bool m_isClusterCulling;
+  uint32_t m_visibleClusterCount; // HUD \p CPU œ.
+
+  // @̐̕`@.
+  enum NormalLineSource
+  {
+    NormalLineSource_GeometryShader, // t[ drawNormalGS ō.
+    NormalLineSource_CachedBuffer,   // Rs[gVF[_[ōĂ_obt@`.
+    NormalLineSource_Count,
+  };
+  int m_normalLineSource;
+  BufferObject m_normalLineBuffer;
+  BufferObject m_normalLineParameters;
+  VkDescriptorSet m_normalLineDescriptorSet;
+  uint32_t m_normalLineVertexCount;
+  bool m_isNormalLineDirty; // fǂݍݒ蒼.
+
+  // tbgVF[fBO̕@.
+  enum FlatShadeMethod
+  {
+    FlatShadeMethod_GeometryShader,  // flatGS Ŗʖ@߂.
+    FlatShadeMethod_Derivative,      // tOgVF[_[ňʒu̕Δʖ@߂.
+    FlatShadeMethod_ProvokingVertex, // m_flatTeapot ̖ʖ@ flat œn.
+    FlatShadeMethod_Count,
+  };
+  int m_flatShadeMethod;
+
+  // f`(tbg)/@`Ɛ̎Ԃ̌v(^CX^v). C[WƂ 4 .
+  bool m_isTimestampSupported;
+  VkQueryPool m_timestampPool;
+  double m_timestampPeriod; // imb/JEg.
+  std::vector<double*> m_timestampTargets; // vʂ̏ݐ. vȂ nullptr.
+  std::vector<bool> m_hasGenerateTimestamps;
+  double m_flatShadeMilliseconds[FlatShadeMethod_Count];
+  double m_normalLineMilliseconds[NormalLineSource_Count];
+  double m_generateMilliseconds;
+
   const std::string FlatShadePipeine = "flatShade";
+  const std::string FlatDerivativePipeline = "flatDerivative";
+  const std::string FlatProvokingPipeline = "flatProvoking";
   const std::string SmoothShadePipeline = "smoothShade";
   const std::string NormalVectorPipeline = "drawNormalVector";
+  const std::string ClusterCullPipeline = "clusterCull";
+  const std::string NormalLinePipeline = "drawNormalLine";
+  const std::string NormalLineGeneratePipeline = "generateNormalLine";
+
+  // eB[|bg̕`pCvC̃JO[h. ʂ悤wʃJO͂Ȃ.
+  // bVbg̖@~ɂ锻͔wʃJOƂLɂ.
+  const VkCullModeFlags TeapotCullMode = VK_CULL_MODE_NONE;
 
   enum DrawMode
   {
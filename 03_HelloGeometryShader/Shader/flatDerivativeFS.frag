@@ -0,0 +1,28 @@
+#version 450
+
+layout(location=0) in vec3 inPosition;
+layout(location=1) in vec3 inNormal;
+
+layout(location=0) out vec4 outColor;
+
+layout(set=0, binding=0)
+uniform SceneParameters
+{
+  mat4  world;
+  mat4  view;
+  mat4  proj;
+  vec4  lightDir;
+};
+
+void main()
+{
+  // אڃsNZƂ̈ʒu͎̍Op`̖ʏɂ̂ŁÅOςʖ@ɂȂ.
+  vec3 normal = normalize(cross(dFdx(inPosition), dFdy(inPosition)));
+  // ʂ̌ŕς邽߁A_@Ɠɑ.
+  if (dot(normal, inNormal) < 0)
+  {
+    normal = -normal;
+  }
+  float nl = dot(normal, normalize(lightDir.xyz));
+  outColor = vec4(clamp(nl, 0, 1).xxx, 1);
+}
@@ -0,0 +1,35 @@
+#version 450
+#extension GL_GOOGLE_include_directive : enable
+
+layout(location=0) in vec4 inPos;
+layout(location=1) in vec4 inNormal;
+
+// provoking vertex(Op`̐擪̒_)̒lOp`ŜɎg.
+layout(location=0) flat out vec3 outColor;
+
+out gl_PerVertex
+{
+  vec4 gl_Position;
+};
+
+layout(set=0, binding=0)
+uniform SceneParameters
+{
+  mat4  world;
+  mat4  view;
+  mat4  proj;
+  vec4  lightDir;
+};
+
+#include "../../common/quantize.glsl"
+
+void main()
+{
+  vec4 pos = DecodePosition(inPos);
+  vec3 normal = DecodeNormal(inNormal);
+  gl_Position = proj * view * world * pos;
+
+  // provoking vertex ɂ͖ʖ@Ă.
+  float nl = dot(mat3(world) * normal, normalize(lightDir.xyz));
+  outColor = clamp(nl, 0, 1).xxx;
+}
@@ -1,7 +1,8 @@
 #version 450
+#extension GL_GOOGLE_include_directive : enable
 
 layout(location=0) in vec4 inPos;
-layout(location=1) in vec3 inNormal;
+layout(location=1) in vec4 inNormal;
 
 layout(location=0) out vec3 outNormal;
 
@@ -19,8 +20,12 @@ uniform SceneParameters
   vec4  lightDir;
 };
 
+#include "../../common/quantize.glsl"
+
 void main()
 {
-  gl_Position = inPos;
-  outNormal = mat3(world) * inNormal;
+  vec4 pos = DecodePosition(inPos);
+  vec3 normal = DecodeNormal(inNormal);
+  gl_Position = pos;
+  outNormal = mat3(world) * normal;
 }
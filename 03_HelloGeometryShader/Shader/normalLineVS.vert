@@ -0,0 +1,26 @@
+#version 450
+
+layout(location=0) in vec4 inPos;
+
+layout(location=0) out vec3 outColor;
+
+out gl_PerVertex
+{
+  vec4 gl_Position;
+};
+
+layout(set=0, binding=0)
+uniform SceneParameters
+{
+  mat4  world;
+  mat4  view;
+  mat4  proj;
+  vec4  lightDir;
+};
+
+// ̓Rs[gVF[_[ō쐬ς(f).
+void main()
+{
+  gl_Position = proj * view * world * inPos;
+  outColor = vec3(0,0,1);
+}
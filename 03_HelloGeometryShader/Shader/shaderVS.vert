@@ -1,7 +1,8 @@
 #version 450
+#extension GL_GOOGLE_include_directive : enable
 
 layout(location=0) in vec4 inPos;
-layout(location=1) in vec3 inNormal;
+layout(location=1) in vec4 inNormal;
 
 layout(location=0) out vec4 outColor;
 
@@ -19,10 +20,14 @@ uniform SceneParameters
   vec4  lightDir;
 };
 
+#include "../../common/quantize.glsl"
+
 void main()
 {
-  gl_Position = proj * view * world * inPos;
-  vec3 worldNormal = mat3(world) * inNormal;
+  vec4 pos = DecodePosition(inPos);
+  vec3 normal = DecodeNormal(inNormal);
+  gl_Position = proj * view * world * pos;
+  vec3 worldNormal = mat3(world) * normal;
   float nl = dot(worldNormal, normalize(lightDir.xyz));
   float l = clamp(nl, 0, 1);
   outColor = vec4(l,l,l, 1); 
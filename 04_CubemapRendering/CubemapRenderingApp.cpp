@@ -1,5 +1,6 @@
 #include "CubemapRenderingApp.h"
-#include "TeapotModel.h"
+#include "TeapotMeshConverter.h"
+#include "MeshletBuilder.h"
 #include "VulkanBookUtil.h"
 #include "stb_image.h"
 
@@ -10,6 +11,9 @@
 #include "examples/imgui_impl_glfw.h"
 
 #include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 using namespace std;
 
@@ -20,6 +24,48 @@ CubemapRenderingApp::CubemapRenderingApp()
     glm::vec3(0.0f, 0.0f, 0.0f)
   );
   m_mode = Mode_StaticCubemap;
+  m_vertexFormat = VertexQuantizer::NormalEncoding_Float32;
+  m_loadedVertexFormat = VertexQuantizer::NormalEncoding_Float32;
+  m_teapotVertexStride = 0;
+  m_isMultiviewSupported = false;
+  m_isLayerOutputSupported = false;
+  m_aroundTeapotsLayered.pipeline = VK_NULL_HANDLE;
+  m_aroundTeapotsLayered.instanceCount = 0;
+  for (auto& mask : m_faceVisibility)
+  {
+    mask = 0x3F;
+  }
+  m_isFaceCulling = true;
+  m_isClusterCulling = false;
+  m_faceDrawTriangles = 0;
+  m_isScheduledUpdate = true;
+  m_faceUpdateBudget = 6;
+  m_sceneRevision = 0;
+  for (auto& state : m_faceStates)
+  {
+    state.isValid = false;
+  }
+  m_nextFace = 0;
+  m_pendingFaces = 0;
+  m_cycleFaces = 0;
+  m_renderedFaces = 0;
+  m_scheduledMode = m_mode;
+  m_scheduledLightDir = glm::vec4(0.0f);
+  m_isTimestampSupported = false;
+  m_timestampPool = VK_NULL_HANDLE;
+  m_timestampPeriod = 1.0;
+  for (auto& ms : m_cubemapMilliseconds)
+  {
+    ms = 0.0;
+  }
+  m_filterMilliseconds = 0.0;
+  m_roughness = 0.0f;
+  m_metallic = 1.0f;
+  m_dsPrefilterFromDisplay = VK_NULL_HANDLE;
+  m_prefilterPipeline = VK_NULL_HANDLE;
+  m_irradiancePipeline = VK_NULL_HANDLE;
+  m_irradianceReducePipeline = VK_NULL_HANDLE;
+  m_prefilteredSampler = VK_NULL_HANDLE;
 }
 
 void CubemapRenderingApp::Prepare()
@@ -29,6 +75,26 @@ void CubemapRenderingApp::Prepare()
   auto colorFormat = m_swapchain->GetSurfaceFormat().format;
   RegisterRenderPass("default", CreateRenderPass(colorFormat, VK_FORMAT_D32_SFLOAT));
   RegisterRenderPass("cubemap", CreateRenderPass(CubemapFormat, VK_FORMAT_D32_SFLOAT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+  // 6 (C[ 0..5)֓ɕ`悷}`r[̃_[pX.
+  m_isMultiviewSupported = m_multiviewFeatures.multiview == VK_TRUE;
+  if (m_isMultiviewSupported)
+  {
+    RegisterRenderPass("cubemap_multiview", CreateRenderPass(CubemapFormat, VK_FORMAT_D32_SFLOAT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 0x3F));
+  }
+  // _VF[_[ gl_Layer o͂ł邩(foCXgׂ͂ėLĂ).
+  {
+    uint32_t count = 0;
+    vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &count, nullptr);
+    std::vector<VkExtensionProperties> extensions(count);
+    vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &count, extensions.data());
+    for (const auto& v : extensions)
+    {
+      if (strcmp(v.extensionName, VK_EXT_SHADER_VIEWPORT_INDEX_LAYER_EXTENSION_NAME) == 0)
+      {
+        m_isLayerOutputSupported = true;
+      }
+    }
+  }
   
   // fvXobt@.
   auto extent = m_swapchain->GetSurfaceExtent();
@@ -46,20 +112,86 @@ void CubemapRenderingApp::Prepare()
     c.commandBuffer = CreateCommandBuffer(false); // R}hobt@JnԂɂȂ.
   }
 
+  // L[u}bv`̎Ԃv^CX^v.
+  VkPhysicalDeviceProperties physProps;
+  vkGetPhysicalDeviceProperties(m_physicalDevice, &physProps);
+  m_isTimestampSupported = physProps.limits.timestampComputeAndGraphics == VK_TRUE;
+  m_timestampPeriod = physProps.limits.timestampPeriod;
+  m_timestampModes.assign(imageCount, Mode_StaticCubemap);
+  m_isFilterTimed.assign(imageCount, false);
+  if (m_isTimestampSupported)
+  {
+    VkQueryPoolCreateInfo queryPoolCI{
+      VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO, nullptr, 0,
+      VK_QUERY_TYPE_TIMESTAMP, imageCount * TimestampsPerImage, 0
+    };
+    auto result = vkCreateQueryPool(m_device, &queryPoolCI, nullptr, &m_timestampPool);
+    ThrowIfFailed(result, "vkCreateQueryPool failed.");
+  }
+
   PrepareSceneResource();
+  PrepareEnvironmentFilter();
 
   // `^[Qbg̏.
   PrepareRenderTargetForMultiPass();
   PrepareRenderTargetForSinglePass();
+  PrepareRenderTargetForMultiview();
 
   PrepareCenterTeapotDescriptors();
   PrepareAroundTeapotDescriptors();
 
-  // eB[|bg̃WIg[h.
-  std::vector<TeapotModel::Vertex> vertices(std::begin(TeapotModel::TeapotVerticesPN), std::end(TeapotModel::TeapotVerticesPN));
-  std::vector<uint32_t> indices(std::begin(TeapotModel::TeapotIndices), std::end(TeapotModel::TeapotIndices));
-  m_teapot = CreateSimpleModel(vertices, indices);
+  // eB[|bg̃WIg[h(pCvC̒_͂Ō܂).
+  LoadTeapotModel(VertexQuantizer::NormalEncoding(m_vertexFormat));
+  CreateTeapotPipelines();
+}
 
+void CubemapRenderingApp::LoadTeapotModel(VertexQuantizer::NormalEncoding encoding)
+{
+  // bVt@C TeapotMeshConverter ŎOɏoĂ.
+  MappedMeshFile meshFile;
+  if (!meshFile.Open(TeapotMeshConverter::GetFileName(encoding)))
+  {
+    throw book_util::VulkanException(std::string("Failed to load ") + TeapotMeshConverter::GetFileName(encoding) + " (run TeapotMeshConverter)");
+  }
+  m_teapot = CreateSimpleModel(
+    meshFile.GetVertexData(0), meshFile.GetVertexStride(0), meshFile.GetVertexCount(),
+    meshFile.GetIndexData(), meshFile.GetIndexCount());
+  meshFile.GetVertexInputDescriptions(m_teapotVertexBindings, m_teapotVertexAttributes);
+  m_teapotVertexStride = meshFile.GetVertexStride(0);
+  m_teapotOptimizeResult.before.acmr = meshFile.GetHeader().sourceAcmr;
+  m_teapotOptimizeResult.before.atvr = meshFile.GetHeader().sourceAtvr;
+  m_teapotOptimizeResult.after = MeshOptimizer::AnalyzeVertexCache(meshFile.GetIndexData(), meshFile.GetIndexCount(), meshFile.GetVertexCount());
+
+  // ʎq`ł͒_VF[_[ňʒuƖ@𕜌.
+  m_teapotDecodeParams = VertexQuantizer::GetDecodeParameters(meshFile);
+  m_teapotDecodeInfo = VertexQuantizer::GetSpecializationInfo(m_teapotDecodeParams);
+  m_loadedVertexFormat = encoding;
+
+  // ʂƂ̉Ɏg܋.
+  const auto& header = meshFile.GetHeader();
+  glm::vec3 boundsMin(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+  glm::vec3 boundsMax(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+  m_teapotBoundingSphere = glm::vec4((boundsMin + boundsMax) * 0.5f, glm::length(boundsMax - boundsMin) * 0.5f);
+  m_teapotMeshlets.assign(meshFile.GetMeshletData(), meshFile.GetMeshletData() + meshFile.GetMeshletCount());
+}
+
+void CubemapRenderingApp::UpdateTeapotVertexFormat()
+{
+  auto encoding = VertexQuantizer::NormalEncoding(m_vertexFormat);
+  if (encoding == m_loadedVertexFormat)
+  {
+    return;
+  }
+  vkDeviceWaitIdle(m_device);
+  DestroyBuffer(m_teapot.resVertexBuffer);
+  DestroyBuffer(m_teapot.resIndexBuffer);
+  DestroyTeapotPipelines();
+
+  LoadTeapotModel(encoding);
+  CreateTeapotPipelines();
+
+  // _̐xς̂ŃL[u}bv`.
+  ++m_sceneRevision;
 }
 
 void CubemapRenderingApp::Cleanup()
@@ -84,8 +216,14 @@ void CubemapRenderingApp::Cleanup()
   // AroundTeapots(Cube)
   {
     vkDestroyPipeline(m_device, m_aroundTeapotsToCubemap.pipeline, nullptr);
+    vkDestroyPipeline(m_device, m_aroundTeapotsToCubemap.multiviewPipeline, nullptr);
     for (auto bufferObj : m_aroundTeapotsToCubemap.cameraViewUniform) DestroyBuffer(bufferObj);
   }
+  // AroundTeapots(Layered)
+  {
+    vkDestroyPipeline(m_device, m_aroundTeapotsLayered.pipeline, nullptr);
+    for (auto bufferObj : m_aroundTeapotsLayered.instanceUniform) DestroyBuffer(bufferObj);
+  }
   // CenterTeapot
   {
     vkDestroyPipeline(m_device, m_centerTeapot.pipeline, nullptr);
@@ -105,9 +243,31 @@ void CubemapRenderingApp::Cleanup()
     DestroyImage(m_cubeScene.depth);
     DestroyFramebuffers(1, &m_cubeScene.framebuffer);
   }
+  if (m_isMultiviewSupported)
+  {
+    DestroyFramebuffers(1, &m_cubeMultiviewScene.framebuffer);
+  }
+  vkDestroyQueryPool(m_device, m_timestampPool, nullptr);
+
+  // PrefilteredEnvironment
+  for (auto env : { &m_prefilteredStatic, &m_prefilteredDynamic })
+  {
+    for (auto view : env->storageViews) vkDestroyImageView(m_device, view, nullptr);
+    DestroyImage(env->image);
+    DestroyBuffer(env->irradiance);
+  }
+  for (auto view : m_filterSource.storageViews) vkDestroyImageView(m_device, view, nullptr);
+  DestroyImage(m_filterSource.image);
+  DestroyBuffer(m_shPartials);
+  for (auto bufferObj : m_prefilterUniform) DestroyBuffer(bufferObj);
+  vkDestroyPipeline(m_device, m_prefilterPipeline, nullptr);
+  vkDestroyPipeline(m_device, m_irradiancePipeline, nullptr);
+  vkDestroyPipeline(m_device, m_irradianceReducePipeline, nullptr);
+  vkDestroySampler(m_device, m_prefilteredSampler, nullptr);
 
   DestroyBuffer(m_cubemapEnvUniform);
   DestroyImage(m_cubemapRendered);
+  DestroyImage(m_cubemapDisplay);
   DestroyImage(m_staticCubemap);
   vkDestroySampler(m_device, m_cubemapSampler, nullptr);
 
@@ -153,10 +313,11 @@ void CubemapRenderingApp::CreateSampleLayouts()
   // fBXNv^ZbgCAEg̏.
   std::vector<VkDescriptorSetLayoutBinding > dsLayoutBindings;
 
-  // 0: uniformBuffer, 1: texture(+sampler) gpVF[_[pCAEg.
+  // 0: uniformBuffer, 1: texture(+sampler), 2: storageBuffer gpVF[_[pCAEg.
   dsLayoutBindings = {
     { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_ALL, },
     { 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT },
+    { 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT },
   };
   VkDescriptorSetLayoutCreateInfo dsLayoutCI{
     VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
@@ -169,7 +330,7 @@ void CubemapRenderingApp::CreateSampleLayouts()
 
   result = vkCreateDescriptorSetLayout(m_device, &dsLayoutCI, nullptr, &dsLayout);
   ThrowIfFailed(result, "vkCreateDescriptorSetLayout Failed.");
-  RegisterLayout("u1t1", dsLayout);
+  RegisterLayout("u1t1b1", dsLayout);
 
   // 0: uniformBuffer, 1: uniformBuffer gpVF[_[pCAEg.
   dsLayoutBindings = {
@@ -182,17 +343,53 @@ void CubemapRenderingApp::CreateSampleLayouts()
   ThrowIfFailed(result, "vkCreateDescriptorSetLayout Failed.");
   RegisterLayout("u2", dsLayout);
 
+  // 0: uniformBuffer, 1: uniformBuffer, 2: uniformBuffer gpVF[_[pCAEg.
+  dsLayoutBindings = {
+    { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_ALL, },
+    { 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_ALL },
+    { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT },
+  };
+  dsLayoutCI.bindingCount = uint32_t(dsLayoutBindings.size());
+  dsLayoutCI.pBindings = dsLayoutBindings.data();
+  result = vkCreateDescriptorSetLayout(m_device, &dsLayoutCI, nullptr, &dsLayout);
+  ThrowIfFailed(result, "vkCreateDescriptorSetLayout Failed.");
+  RegisterLayout("u3", dsLayout);
+
+  // L[u}bṽvtB^p. 0: p[^, 1: QƂL[u}bv, 2: ރx.
+  dsLayoutBindings = {
+    { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT },
+    { 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT },
+    { 2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT },
+  };
+  dsLayoutCI.bindingCount = uint32_t(dsLayoutBindings.size());
+  dsLayoutCI.pBindings = dsLayoutBindings.data();
+  result = vkCreateDescriptorSetLayout(m_device, &dsLayoutCI, nullptr, &dsLayout);
+  ThrowIfFailed(result, "vkCreateDescriptorSetLayout Failed.");
+  RegisterLayout("compute_prefilter", dsLayout);
+
+  // ʒa֐ւ̎ˉep. 0: ˉe郌x, 1: [NO[v̕a, 2: W̏ݐ.
+  dsLayoutBindings = {
+    { 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT },
+    { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT },
+    { 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT },
+  };
+  dsLayoutCI.bindingCount = uint32_t(dsLayoutBindings.size());
+  dsLayoutCI.pBindings = dsLayoutBindings.data();
+  result = vkCreateDescriptorSetLayout(m_device, &dsLayoutCI, nullptr, &dsLayout);
+  ThrowIfFailed(result, "vkCreateDescriptorSetLayout Failed.");
+  RegisterLayout("compute_irradiance", dsLayout);
+
   // pCvCCAEg̏
   VkPipelineLayoutCreateInfo layoutCI{
     VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO, nullptr, 0,
   };
   VkPipelineLayout layout;
-  dsLayout = GetDescriptorSetLayout("u1t1");
+  dsLayout = GetDescriptorSetLayout("u1t1b1");
   layoutCI.setLayoutCount = 1;
   layoutCI.pSetLayouts = &dsLayout;
   result = vkCreatePipelineLayout(m_device, &layoutCI, nullptr, &layout);
   ThrowIfFailed(result, "vkCreatePipelineLayout Failed.");
-  RegisterLayout("u1t1", layout);
+  RegisterLayout("u1t1b1", layout);
 
   dsLayout = GetDescriptorSetLayout("u2");
   layoutCI.setLayoutCount = 1;
@@ -201,6 +398,26 @@ void CubemapRenderingApp::CreateSampleLayouts()
   ThrowIfFailed(result, "vkCreatePipelineLayout Failed.");
   RegisterLayout("u2", layout);
 
+  dsLayout = GetDescriptorSetLayout("u3");
+  layoutCI.setLayoutCount = 1;
+  layoutCI.pSetLayouts = &dsLayout;
+  result = vkCreatePipelineLayout(m_device, &layoutCI, nullptr, &layout);
+  ThrowIfFailed(result, "vkCreatePipelineLayout Failed.");
+  RegisterLayout("u3", layout);
+
+  dsLayout = GetDescriptorSetLayout("compute_prefilter");
+  layoutCI.setLayoutCount = 1;
+  layoutCI.pSetLayouts = &dsLayout;
+  result = vkCreatePipelineLayout(m_device, &layoutCI, nullptr, &layout);
+  ThrowIfFailed(result, "vkCreatePipelineLayout Failed.");
+  RegisterLayout("compute_prefilter", layout);
+
+  dsLayout = GetDescriptorSetLayout("compute_irradiance");
+  layoutCI.setLayoutCount = 1;
+  layoutCI.pSetLayouts = &dsLayout;
+  result = vkCreatePipelineLayout(m_device, &layoutCI, nullptr, &layout);
+  ThrowIfFailed(result, "vkCreatePipelineLayout Failed.");
+  RegisterLayout("compute_irradiance", layout);
 }
 
 
@@ -210,6 +427,12 @@ void CubemapRenderingApp::Render()
   {
     MsgLoopMinimizedWindow();
   }
+  UpdateTeapotVertexFormat();
+
+  // HUD Ő؂ւẴt[̃oAHȂ悤AɒlĂ.
+  auto isScheduledUpdate = m_isScheduledUpdate;
+  uint32_t publishFaces = 0;
+
   auto result = m_swapchain->AcquireNextImage(&m_imageIndex, m_presentCompletedSem);
   if (result == VK_ERROR_OUT_OF_DATE_KHR)
   {
@@ -230,6 +453,7 @@ void CubemapRenderingApp::Render()
     shaderParams.proj = m_projection;
     shaderParams.lightDir = glm::vec4(0.0f, 10.0f, 10.0f, 0.0f);
     shaderParams.cameraPos = glm::vec4(m_camera.GetPosition(), 1);
+    shaderParams.material = glm::vec4(m_roughness, m_metallic, float(PrefilterLevels - 1), 0.0f);
 
     auto ubo = m_centerTeapot.sceneUBO[m_imageIndex];
     void* p;
@@ -281,7 +505,52 @@ void CubemapRenderingApp::Render()
       allViews.proj = glm::perspectiveFovRH(
         glm::radians(45.0f), float(CubeEdge), float(CubeEdge), 0.1f, 100.f);
       allViews.lightDir = shaderParams.lightDir;
+
+      // eʂ̎ŃeB[|bg̉sAgݍ킹`悷.
+      auto& faceViewProj = m_faceViewProj;
+      for (int face = 0; face < 6; ++face)
+      {
+        faceViewProj[face] = allViews.proj * allViews.view[face];
+      }
+      UpdateFaceVisibility(faceViewProj);
+      BuildFaceDrawLists(faceViewProj);
+      for (int teapot = 0; teapot < 6; ++teapot)
+      {
+        allViews.faceMasks[teapot] = glm::uvec4(m_faceVisibility[teapot], 0, 0, 0);
+      }
       WriteToHostVisibleMemory(m_aroundTeapotsToCubemap.cameraViewUniform[m_imageIndex].memory, sizeof(allViews), &allViews);
+
+      LayeredInstanceParameters layered{};
+      uint32_t instanceCount = 0;
+      for (uint32_t face = 0; face < 6; ++face)
+      {
+        for (uint32_t teapot = 0; teapot < 6; ++teapot)
+        {
+          if (m_faceVisibility[teapot] & (1u << face))
+          {
+            layered.instances[instanceCount++].x = teapot | (face << 4);
+          }
+        }
+      }
+      m_aroundTeapotsLayered.instanceCount = instanceCount;
+      WriteToHostVisibleMemory(m_aroundTeapotsLayered.instanceUniform[m_imageIndex].memory, sizeof(layered), &layered);
+    }
+
+    // ̃t[ŕ`悷L[u}bv̖ʂ߂.
+    // XPW[gȂΖt[ 6 ʂׂĂ`悷.
+    m_renderedFaces = 0;
+    if (m_mode != Mode_StaticCubemap)
+    {
+      m_renderedFaces = isScheduledUpdate ? ScheduleCubemapFaces(shaderParams.lightDir, publishFaces) : 0x3F;
+    }
+    if (!isScheduledUpdate)
+    {
+      for (auto& state : m_faceStates)
+      {
+        state.isValid = false;
+      }
+      m_pendingFaces = 0;
+      m_cycleFaces = 0;
     }
   }
 
@@ -314,26 +583,81 @@ void CubemapRenderingApp::Render()
 
   auto fence = m_commandBuffers[m_imageIndex].fence;
   vkWaitForFences(m_device, 1, &fence, VK_TRUE, UINT64_MAX);
+  ReadTimestamps(m_imageIndex);
 
   auto command = m_commandBuffers[m_imageIndex].commandBuffer;
 
   vkBeginCommandBuffer(command, &commandBI);
+  auto queryBase = m_imageIndex * TimestampsPerImage;
+  if (m_isTimestampSupported)
+  {
+    vkCmdResetQueryPool(command, m_timestampPool, queryBase, TimestampsPerImage);
+  }
+  m_timestampModes[m_imageIndex] = Mode_StaticCubemap;
+  m_isFilterTimed[m_imageIndex] = false;
 
-  if (m_mode != Mode_StaticCubemap)
+  if (m_renderedFaces != 0)
   {
-    switch (m_mode)
+    if (m_isTimestampSupported)
+    {
+      vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timestampPool, queryBase);
+    }
+    // ꕔ̖ʂ`Ƃ͖ʂƂ̃pXg(C[܂Ƃ߂ĕ`pX͑SʂNA邽).
+    auto mode = m_renderedFaces == 0x3F ? m_mode : Mode_MultiPassCubemap;
+    switch (mode)
     {
     case Mode_MultiPassCubemap:
-      RenderCubemapFaces(command);
+      RenderCubemapFaces(command, m_renderedFaces);
       break;
     case Mode_SinglePassCubemap:
       RenderCubemapOnce(command);
       break;
+    case Mode_MultiviewCubemap:
+      RenderCubemapMultiview(command);
+      break;
+    case Mode_LayeredCubemap:
+      RenderCubemapLayered(command);
+      break;
+    }
+    if (m_isTimestampSupported)
+    {
+      vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timestampPool, queryBase + 1);
+      m_timestampModes[m_imageIndex] = m_renderedFaces == 0x3F ? m_mode : Mode_StaticCubemap;
+    }
+  }
+  // IȃL[u}bvςƂvtB^Ƌʒa֐蒼.
+  VkDescriptorSet dsFilterSource = VK_NULL_HANDLE;
+  if (isScheduledUpdate)
+  {
+    // `̓J[A^b`ĝ܂܁Aʂ\pփRs[.
+    if (publishFaces != 0)
+    {
+      PublishCubemapFaces(command, publishFaces);
+      dsFilterSource = m_dsPrefilterFromDisplay;
+    }
+  }
+  else
+  {
+    // `悵eeNX`ƂĎg߂̃oAݒ.
+    BarrierRTToTexture(command);
+    if (m_renderedFaces != 0)
+    {
+      dsFilterSource = m_prefilteredDynamic.dsCopySource;
+    }
+  }
+  if (dsFilterSource != VK_NULL_HANDLE)
+  {
+    if (m_isTimestampSupported)
+    {
+      vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timestampPool, queryBase + 2);
+    }
+    FilterEnvironment(command, m_prefilteredDynamic, dsFilterSource);
+    if (m_isTimestampSupported)
+    {
+      vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timestampPool, queryBase + 3);
+      m_isFilterTimed[m_imageIndex] = true;
     }
-
   }
-  // `悵eeNX`ƂĎg߂̃oAݒ.
-  BarrierRTToTexture(command);
 
   vkCmdBeginRenderPass(command, &rpBI, VK_SUBPASS_CONTENTS_INLINE);
  
@@ -346,7 +670,10 @@ void CubemapRenderingApp::Render()
   vkCmdEndRenderPass(command);
 
   // ̕`ɔăoAݒ.
-  BarrierTextureToRT(command);
+  if (!isScheduledUpdate)
+  {
+    BarrierTextureToRT(command);
+  }
 
   vkEndCommandBuffer(command);
 
@@ -424,7 +751,7 @@ void CubemapRenderingApp::PrepareSceneResource()
       6, // arrayLayers
       VK_SAMPLE_COUNT_1_BIT,
       VK_IMAGE_TILING_OPTIMAL,
-      VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+      VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
       VK_SHARING_MODE_EXCLUSIVE,
       0, nullptr,
       VK_IMAGE_LAYOUT_UNDEFINED
@@ -452,13 +779,23 @@ void CubemapRenderingApp::PrepareSceneResource()
   result = vkCreateImageView(m_device, &viewCI, nullptr, &m_cubemapRendered.view);
   ThrowIfFailed(result, "vkCreateImageView Failed.");
 
+  // \p̃L[u}bv. `悵IʂRs[邽߁A`r̖ʂ邱Ƃ͂Ȃ.
+  imageCI.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+  result = vkCreateImage(m_device, &imageCI, nullptr, &m_cubemapDisplay.image);
+  ThrowIfFailed(result, "vkCreateImage Failed.");
+  m_cubemapDisplay.memory = AllocateMemory(m_cubemapDisplay.image, memProps);
+  vkBindImageMemory(m_device, m_cubemapDisplay.image, m_cubemapDisplay.memory, 0);
+  viewCI.image = m_cubemapDisplay.image;
+  result = vkCreateImageView(m_device, &viewCI, nullptr, &m_cubemapDisplay.view);
+  ThrowIfFailed(result, "vkCreateImageView Failed.");
+
   // ӃIuWFNg̔zup̃jtH[obt@̏.
   // ʒuJ[̕ύXȂ߁Aobt@OȂ.
   VkMemoryPropertyFlags uboMemoryProps = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
   auto bufferSize = uint32_t(sizeof(TeapotInstanceParameters));
   m_cubemapEnvUniform = CreateBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, uboMemoryProps);
   { // .
-    TeapotInstanceParameters params{};
+    auto& params = m_cubemapEnvParams;
     params.world[0] = glm::translate(glm::mat4(1.0f), glm::vec3(5.0f, 0.0f, 0.0f));
     params.world[1] = glm::translate(glm::mat4(1.0f), glm::vec3(-5.0f, 0.0f, 0.0f));
     params.world[2] = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 5.0f, 0.0f));
@@ -520,6 +857,24 @@ void CubemapRenderingApp::PrepareSceneResource()
     1, &imageBarrier
   );
 
+  // ŏ̖ʂ낤܂ł́A\pL[u}bv`掞̔wiFŖ߂Ă.
+  imageBarrier.image = m_cubemapDisplay.image;
+  imageBarrier.srcAccessMask = 0;
+  imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+    0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+  VkClearColorValue clearColor = { { 0.5f, 0.75f, 1.0f, 0.0f } };
+  vkCmdClearColorImage(command, m_cubemapDisplay.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearColor, 1, &imageBarrier.subresourceRange);
+  imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  imageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  imageBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+    0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
   FinishCommandBuffer(command);
   DestroyCommandBuffer(command);
 }
@@ -655,24 +1010,13 @@ VkPipeline CubemapRenderingApp::CreateRenderTeapotPipeline(
   std::vector<VkPipelineShaderStageCreateInfo> shaderStages)
 {
   // pCvC.
-  auto stride = uint32_t(sizeof(TeapotModel::Vertex));
-  VkVertexInputBindingDescription vibDesc{
-      0, // binding
-      stride,
-      VK_VERTEX_INPUT_RATE_VERTEX
-  };
-
-  array<VkVertexInputAttributeDescription, 2> inputAttribs{
-    {
-      { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(TeapotModel::Vertex, Position) },
-      { 1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(TeapotModel::Vertex, Normal) },
-    }
-  };
+  // _͂̓bVt@C̃Xg[`ɏ]A_VF[_[ɕp̒ln.
+  shaderStages[0].pSpecializationInfo = &m_teapotDecodeInfo;
   VkPipelineVertexInputStateCreateInfo pipelineVisCI{
     VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
     nullptr, 0,
-    1, &vibDesc,
-    uint32_t(inputAttribs.size()), inputAttribs.data()
+    uint32_t(m_teapotVertexBindings.size()), m_teapotVertexBindings.data(),
+    uint32_t(m_teapotVertexAttributes.size()), m_teapotVertexAttributes.data()
   };
 
   auto blendAttachmentState = book_util::GetOpaqueColorBlendAttachmentState();
@@ -744,15 +1088,233 @@ VkPipeline CubemapRenderingApp::CreateRenderTeapotPipeline(
 }
 
 
+void CubemapRenderingApp::PrepareEnvironmentFilter()
+{
+  VkResult result;
+
+  // x̃p[^. e r ̃x alpha = r^2  GGX ŏݍ񂾂̂Ƃ.
+  // x 0  alpha = 0 Ȃ̂ł̂܂܎ʂ(̃L[u}bvtB^Ƃɂg).
+  m_prefilterUniform = CreateUniformBuffers(uint32_t(sizeof(PrefilterParameters)), PrefilterLevels);
+  for (uint32_t level = 0; level < PrefilterLevels; ++level)
+  {
+    float roughness = float(level) / float(PrefilterLevels - 1);
+    PrefilterParameters params{};
+    params.params = glm::vec4(roughness * roughness, float(PrefilterSampleCount), 0.0f, 0.0f);
+    WriteToHostVisibleMemory(m_prefilterUniform[level].memory, sizeof(params), &params);
+  }
+
+  // ̃eB[|bgeɉ~bvQƂ邽߁AуvtB^ŃtB^̃~bvQƂ邽߂̃Tv[.
+  VkSamplerCreateInfo samplerCI{
+    VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO, nullptr,
+    0,
+    VK_FILTER_LINEAR,
+    VK_FILTER_LINEAR,
+    VK_SAMPLER_MIPMAP_MODE_LINEAR,
+    VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+    VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+    VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+    0.0f,
+    VK_FALSE,
+    1.0f,
+    VK_FALSE,
+    VK_COMPARE_OP_NEVER,
+    0.0f,
+    float(FilterSourceLevels),
+    VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE,
+    VK_FALSE
+  };
+  result = vkCreateSampler(m_device, &samplerCI, nullptr, &m_prefilteredSampler);
+  ThrowIfFailed(result, "vkCreateSampler failed.");
+
+  VkImageCreateInfo imageCI{
+    VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO, nullptr,
+    VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT,
+    VK_IMAGE_TYPE_2D,
+    VK_FORMAT_R16G16B16A16_SFLOAT,
+    { CubeEdge, CubeEdge, 1 },
+    PrefilterLevels, // mipLevels
+    6, // arrayLayers
+    VK_SAMPLE_COUNT_1_BIT,
+    VK_IMAGE_TILING_OPTIMAL,
+    VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
+    VK_SHARING_MODE_EXCLUSIVE,
+    0, nullptr,
+    VK_IMAGE_LAYOUT_UNDEFINED
+  };
+
+  // tB^. k̓ubgōs.
+  imageCI.mipLevels = FilterSourceLevels;
+  imageCI.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+  result = vkCreateImage(m_device, &imageCI, nullptr, &m_filterSource.image.image);
+  ThrowIfFailed(result, "vkCreateImage Failed.");
+  m_filterSource.image.memory = AllocateMemory(m_filterSource.image.image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  vkBindImageMemory(m_device, m_filterSource.image.image, m_filterSource.image.memory, 0);
+  {
+    VkImageViewCreateInfo viewCI{
+      VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+      nullptr, 0,
+      m_filterSource.image.image,
+      VK_IMAGE_VIEW_TYPE_CUBE, imageCI.format,
+      book_util::DefaultComponentMapping(),
+      { VK_IMAGE_ASPECT_COLOR_BIT, 0, FilterSourceLevels, 0, 6 }
+    };
+    result = vkCreateImageView(m_device, &viewCI, nullptr, &m_filterSource.image.view);
+    ThrowIfFailed(result, "vkCreateImageView Failed.");
+    m_filterSource.storageViews.resize(FilterSourceLevels);
+    viewCI.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    for (uint32_t level = 0; level < FilterSourceLevels; ++level)
+    {
+      viewCI.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 6 };
+      result = vkCreateImageView(m_device, &viewCI, nullptr, &m_filterSource.storageViews[level]);
+      ThrowIfFailed(result, "vkCreateImageView Failed.");
+    }
+  }
+  imageCI.mipLevels = PrefilterLevels;
+  imageCI.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+
+  // ˉe郌x 8x8 eNZ̃[NO[vŏa.
+  auto irradianceEdge = CubeEdge >> IrradianceSourceLevel;
+  auto irradianceGroups = ((irradianceEdge + 7) / 8) * ((irradianceEdge + 7) / 8) * 6;
+  m_shPartials = CreateBuffer(uint32_t(sizeof(glm::vec4) * 9 * irradianceGroups), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+  auto irradianceLayout = GetDescriptorSetLayout("compute_irradiance");
+  auto prepareEnvironment = [&](PrefilteredEnvironment& env, VkImageView source) {
+    result = vkCreateImage(m_device, &imageCI, nullptr, &env.image.image);
+    ThrowIfFailed(result, "vkCreateImage Failed.");
+    env.image.memory = AllocateMemory(env.image.image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    vkBindImageMemory(m_device, env.image.image, env.image.memory, 0);
+
+    // TvOp(Sx)̃L[u}bṽr[ƁAXg[WC[Wp(x)̃r[.
+    VkImageViewCreateInfo viewCI{
+      VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+      nullptr, 0,
+      env.image.image,
+      VK_IMAGE_VIEW_TYPE_CUBE, imageCI.format,
+      book_util::DefaultComponentMapping(),
+      { VK_IMAGE_ASPECT_COLOR_BIT, 0, PrefilterLevels, 0, 6 }
+    };
+    result = vkCreateImageView(m_device, &viewCI, nullptr, &env.image.view);
+    ThrowIfFailed(result, "vkCreateImageView Failed.");
+
+    env.storageViews.resize(PrefilterLevels);
+    viewCI.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    for (uint32_t level = 0; level < PrefilterLevels; ++level)
+    {
+      viewCI.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 6 };
+      result = vkCreateImageView(m_device, &viewCI, nullptr, &env.storageViews[level]);
+      ThrowIfFailed(result, "vkCreateImageView Failed.");
+    }
+
+    env.dsCopySource = CreatePrefilterDescriptorSet(0, source, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_filterSource.storageViews[0]);
+    env.dsLevels.resize(PrefilterLevels);
+    for (uint32_t level = 0; level < PrefilterLevels; ++level)
+    {
+      env.dsLevels[level] = CreatePrefilterDescriptorSet(level, m_filterSource.image.view, VK_IMAGE_LAYOUT_GENERAL, env.storageViews[level]);
+    }
+
+    env.irradiance = CreateBuffer(uint32_t(sizeof(glm::vec4) * 9), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    env.dsIrradiance = AllocateDescriptorSet(irradianceLayout);
+    VkDescriptorImageInfo srcLevelInfo{
+      VK_NULL_HANDLE, m_filterSource.storageViews[IrradianceSourceLevel], VK_IMAGE_LAYOUT_GENERAL
+    };
+    VkDescriptorBufferInfo partialsInfo{
+      m_shPartials.buffer, 0, VK_WHOLE_SIZE
+    };
+    VkDescriptorBufferInfo irradianceInfo{
+      env.irradiance.buffer, 0, VK_WHOLE_SIZE
+    };
+    std::vector<VkWriteDescriptorSet> writeSet = {
+      book_util::CreateWriteDescriptorSet(env.dsIrradiance, 0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &srcLevelInfo),
+      book_util::CreateWriteDescriptorSet(env.dsIrradiance, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &partialsInfo),
+      book_util::CreateWriteDescriptorSet(env.dsIrradiance, 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &irradianceInfo),
+    };
+    vkUpdateDescriptorSets(m_device, uint32_t(writeSet.size()), writeSet.data(), 0, nullptr);
+  };
+  prepareEnvironment(m_prefilteredStatic, m_staticCubemap.view);
+  prepareEnvironment(m_prefilteredDynamic, m_cubemapRendered.view);
+  m_dsPrefilterFromDisplay = CreatePrefilterDescriptorSet(0, m_cubemapDisplay.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_filterSource.storageViews[0]);
+
+  auto computeStage = book_util::LoadShader(m_device, "prefilterCS.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+  VkComputePipelineCreateInfo pipelineCI{
+    VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO, nullptr, 0,
+    computeStage,
+    GetPipelineLayout("compute_prefilter"),
+    VK_NULL_HANDLE, 0
+  };
+  result = vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &m_prefilterPipeline);
+  ThrowIfFailed(result, "vkCreateComputePipelines failed.");
+  vkDestroyShaderModule(m_device, computeStage.module, nullptr);
+
+  computeStage = book_util::LoadShader(m_device, "shProjectCS.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+  pipelineCI.stage = computeStage;
+  pipelineCI.layout = GetPipelineLayout("compute_irradiance");
+  result = vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &m_irradiancePipeline);
+  ThrowIfFailed(result, "vkCreateComputePipelines failed.");
+  vkDestroyShaderModule(m_device, computeStage.module, nullptr);
+
+  computeStage = book_util::LoadShader(m_device, "shReduceCS.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+  pipelineCI.stage = computeStage;
+  result = vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &m_irradianceReducePipeline);
+  ThrowIfFailed(result, "vkCreateComputePipelines failed.");
+  vkDestroyShaderModule(m_device, computeStage.module, nullptr);
+
+  // ȍ~ GENERAL ̂܂܏݂ƎQƂs.
+  // ÓIȃL[u}bv͂ňxAIȂ͕̂\p̏e(wiF)Ă.
+  auto command = CreateCommandBuffer();
+  VkImageMemoryBarrier imageBarriers[3];
+  VkImage images[] = { m_prefilteredStatic.image.image, m_prefilteredDynamic.image.image, m_filterSource.image.image };
+  for (int i = 0; i < 3; ++i)
+  {
+    imageBarriers[i] = VkImageMemoryBarrier{
+      VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER, nullptr,
+      0, VK_ACCESS_SHADER_WRITE_BIT,
+      VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+      VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+      images[i],
+      { VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, 6 }
+    };
+  }
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+    0, 0, nullptr, 0, nullptr,
+    _countof(imageBarriers), imageBarriers);
+  FilterEnvironment(command, m_prefilteredStatic, m_prefilteredStatic.dsCopySource);
+  FilterEnvironment(command, m_prefilteredDynamic, m_dsPrefilterFromDisplay);
+  FinishCommandBuffer(command);
+  DestroyCommandBuffer(command);
+}
+
+VkDescriptorSet CubemapRenderingApp::CreatePrefilterDescriptorSet(uint32_t level, VkImageView source, VkImageLayout sourceLayout, VkImageView dest)
+{
+  auto ds = AllocateDescriptorSet(GetDescriptorSetLayout("compute_prefilter"));
+  VkDescriptorBufferInfo paramsInfo{
+    m_prefilterUniform[level].buffer, 0, VK_WHOLE_SIZE
+  };
+  // Qƌ͌̃L[u}bv(SHADER_READ_ONLY_OPTIMAL)AtB^̑Sx(GENERAL).
+  VkDescriptorImageInfo srcInfo{
+    m_prefilteredSampler, source, sourceLayout
+  };
+  VkDescriptorImageInfo destInfo{
+    VK_NULL_HANDLE, dest, VK_IMAGE_LAYOUT_GENERAL
+  };
+  std::vector<VkWriteDescriptorSet> writeSet = {
+    book_util::CreateWriteDescriptorSet(ds, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &paramsInfo),
+    book_util::CreateWriteDescriptorSet(ds, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &srcInfo),
+    book_util::CreateWriteDescriptorSet(ds, 2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &destInfo),
+  };
+  vkUpdateDescriptorSets(m_device, uint32_t(writeSet.size()), writeSet.data(), 0, nullptr);
+  return ds;
+}
+
 void CubemapRenderingApp::PrepareCenterTeapotDescriptors()
 {
-  auto dsLayout = GetDescriptorSetLayout("u1t1");
+  auto dsLayout = GetDescriptorSetLayout("u1t1b1");
   auto imageCount = m_swapchain->GetImageCount();
 
   auto bufferSize = uint32_t(sizeof(ShaderParameters));
   m_centerTeapot.sceneUBO = CreateUniformBuffers(bufferSize, imageCount);
 
-  // t@Cǂݍ񂾃L[u}bvgpĕ`悷pX̃fBXNv^.
+  // t@Cǂݍ񂾃L[u}bvvtB^̂gpĕ`悷pX̃fBXNv^.
   m_centerTeapot.dsCubemapStatic.resize(imageCount);
   for (uint32_t i = 0; i < imageCount; ++i)
   {
@@ -763,49 +1325,42 @@ void CubemapRenderingApp::PrepareCenterTeapotDescriptors()
       m_centerTeapot.sceneUBO[i].buffer, 0, VK_WHOLE_SIZE
     };
     VkDescriptorImageInfo  staticCubemap{
-      m_cubemapSampler, m_staticCubemap.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+      m_prefilteredSampler, m_prefilteredStatic.image.view, VK_IMAGE_LAYOUT_GENERAL
+    };
+    VkDescriptorBufferInfo irradiance{
+      m_prefilteredStatic.irradiance.buffer, 0, VK_WHOLE_SIZE
     };
     std::vector<VkWriteDescriptorSet> writeSet = {
       book_util::CreateWriteDescriptorSet(ds, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &sceneUbo),
       book_util::CreateWriteDescriptorSet(ds, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &staticCubemap),
+      book_util::CreateWriteDescriptorSet(ds, 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &irradiance),
     };
     vkUpdateDescriptorSets(m_device, uint32_t(writeSet.size()), writeSet.data(), 0, nullptr);
   }
 
-  // Iɕ`悵L[u}bvgpĕ`悷pX̃fBXNv^.
-  m_centerTeapot.dsCubemapRendered.resize(imageCount);
+  // Iɕ`悵L[u}bvvtB^̂gpĕ`悷pX̃fBXNv^.
+  m_centerTeapot.dsCubemapDynamic.resize(imageCount);
   for (uint32_t i = 0; i < imageCount; ++i)
   {
     auto ds = AllocateDescriptorSet(dsLayout);
-    m_centerTeapot.dsCubemapRendered[i] = ds;
+    m_centerTeapot.dsCubemapDynamic[i] = ds;
 
     VkDescriptorBufferInfo sceneUbo{
       m_centerTeapot.sceneUBO[i].buffer, 0, VK_WHOLE_SIZE
     };
-    VkDescriptorImageInfo renderedCubemap{
-      m_cubemapSampler, m_cubemapRendered.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    VkDescriptorImageInfo dynamicCubemap{
+      m_prefilteredSampler, m_prefilteredDynamic.image.view, VK_IMAGE_LAYOUT_GENERAL
+    };
+    VkDescriptorBufferInfo irradiance{
+      m_prefilteredDynamic.irradiance.buffer, 0, VK_WHOLE_SIZE
     };
     std::vector<VkWriteDescriptorSet> writeSet = {
       book_util::CreateWriteDescriptorSet(ds, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &sceneUbo),
-      book_util::CreateWriteDescriptorSet(ds, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &renderedCubemap),
+      book_util::CreateWriteDescriptorSet(ds, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &dynamicCubemap),
+      book_util::CreateWriteDescriptorSet(ds, 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &irradiance),
     };
     vkUpdateDescriptorSets(m_device, uint32_t(writeSet.size()), writeSet.data(), 0, nullptr);
   }
-
-  std::vector<VkPipelineShaderStageCreateInfo> shaderStages = {
-    book_util::LoadShader(m_device, "shaderVS.spv", VK_SHADER_STAGE_VERTEX_BIT),
-    book_util::LoadShader(m_device, "shaderFS.spv", VK_SHADER_STAGE_FRAGMENT_BIT),
-  };
-  auto extent = m_swapchain->GetSurfaceExtent();
-  auto renderPass = GetRenderPass("default");
-  auto layout = GetPipelineLayout("u1t1");
-  m_centerTeapot.pipeline = CreateRenderTeapotPipeline(
-    "default",
-    extent.width, extent.height,
-    "u1t1",
-    shaderStages
-  );
-  book_util::DestroyShaderModules(m_device, shaderStages);
 }
 
 void CubemapRenderingApp::PrepareAroundTeapotDescriptors()
@@ -867,6 +1422,32 @@ void CubemapRenderingApp::PrepareAroundTeapotDescriptors()
     vkUpdateDescriptorSets(m_device, uint32_t(writeSet.size()), writeSet.data(), 0, nullptr);
   }
 
+  // gl_Layer o͔ł̃fBXNv^. r[s̓VOpX̂̂L.
+  bufferSize = uint32_t(sizeof(LayeredInstanceParameters));
+  m_aroundTeapotsLayered.instanceUniform = CreateUniformBuffers(bufferSize, imageCount);
+  m_aroundTeapotsLayered.descriptors.resize(imageCount);
+  for (uint32_t i = 0; i < imageCount; ++i)
+  {
+    auto ds = AllocateDescriptorSet(GetDescriptorSetLayout("u3"));
+    m_aroundTeapotsLayered.descriptors[i] = ds;
+
+    VkDescriptorBufferInfo instanceUbo{
+      m_cubemapEnvUniform.buffer, 0, VK_WHOLE_SIZE
+    };
+    VkDescriptorBufferInfo viewProjParamUbo{
+      m_aroundTeapotsToCubemap.cameraViewUniform[i].buffer, 0, VK_WHOLE_SIZE
+    };
+    VkDescriptorBufferInfo layeredUbo{
+      m_aroundTeapotsLayered.instanceUniform[i].buffer, 0, VK_WHOLE_SIZE
+    };
+    std::vector<VkWriteDescriptorSet> writeSet = {
+      book_util::CreateWriteDescriptorSet(ds, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &instanceUbo),
+      book_util::CreateWriteDescriptorSet(ds, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &viewProjParamUbo),
+      book_util::CreateWriteDescriptorSet(ds, 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, &layeredUbo),
+    };
+    vkUpdateDescriptorSets(m_device, uint32_t(writeSet.size()), writeSet.data(), 0, nullptr);
+  }
+
   // C̕`pXŕ`悷邽߂̃fBXNv^.
   m_aroundTeapotsToMain.cameraViewUniform.resize(imageCount);
   m_aroundTeapotsToMain.descriptors.resize(imageCount);
@@ -887,9 +1468,24 @@ void CubemapRenderingApp::PrepareAroundTeapotDescriptors()
     };
     vkUpdateDescriptorSets(m_device, uint32_t(writeSet.size()), writeSet.data(), 0, nullptr);
   }
-  
-  
-  std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
+}
+
+void CubemapRenderingApp::CreateTeapotPipelines()
+{
+  // ̃eB[|bg.
+  auto extent = m_swapchain->GetSurfaceExtent();
+  std::vector<VkPipelineShaderStageCreateInfo> shaderStages = {
+    book_util::LoadShader(m_device, "shaderVS.spv", VK_SHADER_STAGE_VERTEX_BIT),
+    book_util::LoadShader(m_device, "shaderFS.spv", VK_SHADER_STAGE_FRAGMENT_BIT),
+  };
+  m_centerTeapot.pipeline = CreateRenderTeapotPipeline(
+    "default",
+    extent.width, extent.height,
+    "u1t1b1",
+    shaderStages
+  );
+  book_util::DestroyShaderModules(m_device, shaderStages);
+
   // }``pX.
   shaderStages = {
     book_util::LoadShader(m_device, "teapotsVS.spv", VK_SHADER_STAGE_VERTEX_BIT),
@@ -909,8 +1505,33 @@ void CubemapRenderingApp::PrepareAroundTeapotDescriptors()
     "cubemap", CubeEdge, CubeEdge, "u2", shaderStages);
   book_util::DestroyShaderModules(m_device, shaderStages);
 
+  // }`r[`pX. gl_ViewIndex ŖʂIԂ̂ŃWIgVF[_[͕sv.
+  m_aroundTeapotsToCubemap.multiviewPipeline = VK_NULL_HANDLE;
+  if (m_isMultiviewSupported)
+  {
+    shaderStages = {
+      book_util::LoadShader(m_device, "cubemapMultiviewVS.spv", VK_SHADER_STAGE_VERTEX_BIT),
+      book_util::LoadShader(m_device, "cubemapFS.spv", VK_SHADER_STAGE_FRAGMENT_BIT),
+    };
+    m_aroundTeapotsToCubemap.multiviewPipeline = CreateRenderTeapotPipeline(
+      "cubemap_multiview", CubeEdge, CubeEdge, "u2", shaderStages);
+    book_util::DestroyShaderModules(m_device, shaderStages);
+  }
+
+  // _VF[_[ gl_Layer w肷`pX. WIgVF[_[͕sv.
+  m_aroundTeapotsLayered.pipeline = VK_NULL_HANDLE;
+  if (m_isLayerOutputSupported)
+  {
+    shaderStages = {
+      book_util::LoadShader(m_device, "cubemapLayeredVS.spv", VK_SHADER_STAGE_VERTEX_BIT),
+      book_util::LoadShader(m_device, "cubemapFS.spv", VK_SHADER_STAGE_FRAGMENT_BIT),
+    };
+    m_aroundTeapotsLayered.pipeline = CreateRenderTeapotPipeline(
+      "cubemap", CubeEdge, CubeEdge, "u3", shaderStages);
+    book_util::DestroyShaderModules(m_device, shaderStages);
+  }
+
   // C`pX.
-  auto extent = m_swapchain->GetSurfaceExtent();
   shaderStages = {
     book_util::LoadShader(m_device, "teapotsVS.spv", VK_SHADER_STAGE_VERTEX_BIT),
     book_util::LoadShader(m_device, "teapotsFS.spv", VK_SHADER_STAGE_FRAGMENT_BIT),
@@ -920,6 +1541,16 @@ void CubemapRenderingApp::PrepareAroundTeapotDescriptors()
   book_util::DestroyShaderModules(m_device, shaderStages);
 }
 
+void CubemapRenderingApp::DestroyTeapotPipelines()
+{
+  vkDestroyPipeline(m_device, m_centerTeapot.pipeline, nullptr);
+  vkDestroyPipeline(m_device, m_aroundTeapotsToFace.pipeline, nullptr);
+  vkDestroyPipeline(m_device, m_aroundTeapotsToCubemap.pipeline, nullptr);
+  vkDestroyPipeline(m_device, m_aroundTeapotsToCubemap.multiviewPipeline, nullptr);
+  vkDestroyPipeline(m_device, m_aroundTeapotsLayered.pipeline, nullptr);
+  vkDestroyPipeline(m_device, m_aroundTeapotsToMain.pipeline, nullptr);
+}
+
 
 void CubemapRenderingApp::PrepareRenderTargetForMultiPass()
 {
@@ -1004,7 +1635,7 @@ void CubemapRenderingApp::PrepareRenderTargetForSinglePass()
     VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO, nullptr,
     0,
     m_cubemapRendered.image,
-    VK_IMAGE_VIEW_TYPE_2D,
+    VK_IMAGE_VIEW_TYPE_2D_ARRAY,
     CubemapFormat,
     { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G,VK_COMPONENT_SWIZZLE_B,VK_COMPONENT_SWIZZLE_A },
     { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 6 }
@@ -1044,7 +1675,7 @@ void CubemapRenderingApp::PrepareRenderTargetForSinglePass()
     VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO, nullptr,
     0,
     m_cubeScene.depth.image,
-    VK_IMAGE_VIEW_TYPE_2D,
+    VK_IMAGE_VIEW_TYPE_2D_ARRAY,
     depthImageCI.format,
     { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G,VK_COMPONENT_SWIZZLE_B,VK_COMPONENT_SWIZZLE_A },
     { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 6 }
@@ -1071,8 +1702,32 @@ void CubemapRenderingApp::PrepareRenderTargetForSinglePass()
   }
 }
 
+void CubemapRenderingApp::PrepareRenderTargetForMultiview()
+{
+  if (!m_isMultiviewSupported)
+  {
+    return;
+  }
+  m_cubeMultiviewScene.renderPass = GetRenderPass("cubemap_multiview");
+
+  // }`r[ł̓t[obt@̃C[ 1 ƂA
+  // r[}XN̊erbgA^b`g(6 C[̃r[)̃C[ɑΉ.
+  std::array<VkImageView, 2> attachments;
+  attachments[0] = m_cubeScene.view;
+  attachments[1] = m_cubeScene.depth.view;
+  VkFramebufferCreateInfo fbCI{
+    VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO, nullptr,
+    0,
+    m_cubeMultiviewScene.renderPass,
+    uint32_t(attachments.size()), attachments.data(),
+    CubeEdge, CubeEdge, 1,
+  };
+  auto result = vkCreateFramebuffer(m_device, &fbCI, nullptr, &m_cubeMultiviewScene.framebuffer);
+  ThrowIfFailed(result, "vkCreateFramebuffer failed.");
+}
+
 
-void CubemapRenderingApp::RenderCubemapFaces(VkCommandBuffer command)
+void CubemapRenderingApp::RenderCubemapFaces(VkCommandBuffer command, uint32_t faceMask)
 {
   VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, };
   auto renderArea = VkRect2D{ VkOffset2D{0,0}, VkExtent2D{ CubeEdge, CubeEdge} };
@@ -1100,6 +1755,10 @@ void CubemapRenderingApp::RenderCubemapFaces(VkCommandBuffer command)
   };
   for (int face = 0; face < 6; ++face)
   {
+    if ((faceMask & (1u << face)) == 0)
+    {
+      continue;
+    }
     rpBI.framebuffer = m_cubeFaceScene.fbFaces[face];
     vkCmdBeginRenderPass(command, &rpBI, VK_SUBPASS_CONTENTS_INLINE);
 
@@ -1113,7 +1772,11 @@ void CubemapRenderingApp::RenderCubemapFaces(VkCommandBuffer command)
     VkDeviceSize offsets[] = { 0 };
     vkCmdBindIndexBuffer(command, m_teapot.resIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
     vkCmdBindVertexBuffers(command, 0, 1, &m_teapot.resVertexBuffer.buffer, offsets);
-    vkCmdDrawIndexed(command, m_teapot.indexCount, 6, 0, 0, 0);
+    // ̖ʂɉfeB[|bg(܂͂̃NX^)`悷.
+    for (const auto& draw : m_faceDraws[face])
+    {
+      vkCmdDrawIndexed(command, draw.indexCount, 1, draw.firstIndex, 0, draw.teapot);
+    }
     vkCmdEndRenderPass(command);
   }
 
@@ -1163,10 +1826,419 @@ void CubemapRenderingApp::RenderCubemapOnce(VkCommandBuffer command)
   vkCmdEndRenderPass(command);
 }
 
+void CubemapRenderingApp::RenderCubemapMultiview(VkCommandBuffer command)
+{
+  auto renderArea = VkRect2D{ VkOffset2D{0,0}, VkExtent2D{ CubeEdge, CubeEdge} };
+  array<VkClearValue, 2> clearValue = {
+   {
+     { 0.5f, 0.75f, 1.0f, 0.0f}, // for Color
+     { 1.0f, 0 }, // for Depth
+   }
+  };
+
+  VkRenderPassBeginInfo rpBI{
+    VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO, nullptr,
+    m_cubeMultiviewScene.renderPass,
+    m_cubeMultiviewScene.framebuffer,
+    renderArea,
+    uint32_t(clearValue.size()), clearValue.data()
+  };
+  VkViewport viewport = {
+    0.0f, 0.0f, float(CubeEdge), float(CubeEdge), 0.0f, 1.0f
+  };
+  VkRect2D scissor{
+    { 0, 0}, {CubeEdge, CubeEdge},
+  };
+
+  // 1 ̕`施߂r[}XN 6 ʂׂĂɑ΂Ďs.
+  vkCmdBeginRenderPass(command, &rpBI, VK_SUBPASS_CONTENTS_INLINE);
+
+  auto pipelineLayout = GetPipelineLayout("u2");
+  vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, m_aroundTeapotsToCubemap.multiviewPipeline);
+  vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &m_aroundTeapotsToCubemap.descriptors[m_imageIndex], 0, nullptr);
+
+  vkCmdSetScissor(command, 0, 1, &scissor);
+  vkCmdSetViewport(command, 0, 1, &viewport);
+
+  VkDeviceSize offsets[] = { 0 };
+  vkCmdBindIndexBuffer(command, m_teapot.resIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+  vkCmdBindVertexBuffers(command, 0, 1, &m_teapot.resVertexBuffer.buffer, offsets);
+  vkCmdDrawIndexed(command, m_teapot.indexCount, 6, 0, 0, 0);
+  vkCmdEndRenderPass(command);
+}
+
+void CubemapRenderingApp::RenderCubemapLayered(VkCommandBuffer command)
+{
+  auto renderArea = VkRect2D{ VkOffset2D{0,0}, VkExtent2D{ CubeEdge, CubeEdge} };
+  array<VkClearValue, 2> clearValue = {
+   {
+     { 0.5f, 0.75f, 1.0f, 0.0f}, // for Color
+     { 1.0f, 0 }, // for Depth
+   }
+  };
+
+  // 6 C[̃t[obt@ցACX^XƂɏo͐̃C[ςĕ`悷.
+  VkRenderPassBeginInfo rpBI{
+    VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO, nullptr,
+    m_cubeScene.renderPass,
+    m_cubeScene.framebuffer,
+    renderArea,
+    uint32_t(clearValue.size()), clearValue.data()
+  };
+  VkViewport viewport = {
+    0.0f, 0.0f, float(CubeEdge), float(CubeEdge), 0.0f, 1.0f
+  };
+  VkRect2D scissor{
+    { 0, 0}, {CubeEdge, CubeEdge},
+  };
+
+  vkCmdBeginRenderPass(command, &rpBI, VK_SUBPASS_CONTENTS_INLINE);
+
+  auto pipelineLayout = GetPipelineLayout("u3");
+  vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, m_aroundTeapotsLayered.pipeline);
+  vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &m_aroundTeapotsLayered.descriptors[m_imageIndex], 0, nullptr);
+
+  vkCmdSetScissor(command, 0, 1, &scissor);
+  vkCmdSetViewport(command, 0, 1, &viewport);
+
+  // Ŏc (eB[|bg, ) ̑gݍ킹̐CX^X`悷.
+  if (m_aroundTeapotsLayered.instanceCount > 0)
+  {
+    VkDeviceSize offsets[] = { 0 };
+    vkCmdBindIndexBuffer(command, m_teapot.resIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdBindVertexBuffers(command, 0, 1, &m_teapot.resVertexBuffer.buffer, offsets);
+    vkCmdDrawIndexed(command, m_teapot.indexCount, m_aroundTeapotsLayered.instanceCount, 0, 0, 0);
+  }
+  vkCmdEndRenderPass(command);
+}
+
+void CubemapRenderingApp::UpdateFaceVisibility(const glm::mat4 faceViewProj[6])
+{
+  glm::vec4 planes[6][6];
+  for (int face = 0; face < 6; ++face)
+  {
+    MeshletBuilder::CalcFrustumPlanes(faceViewProj[face], planes[face]);
+  }
+  for (int teapot = 0; teapot < 6; ++teapot)
+  {
+    if (!m_isFaceCulling)
+    {
+      m_faceVisibility[teapot] = 0x3F;
+      continue;
+    }
+    const auto& world = m_cubemapEnvParams.world[teapot];
+    auto center = glm::vec3(world * glm::vec4(glm::vec3(m_teapotBoundingSphere), 1.0f));
+    // gk܂ޏꍇɔāAł傫̊g嗦𔼌aɊ|.
+    auto scale = (std::max)(glm::length(glm::vec3(world[0])), (std::max)(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+    auto radius = m_teapotBoundingSphere.w * scale;
+
+    uint32_t mask = 0;
+    for (int face = 0; face < 6; ++face)
+    {
+      bool isVisible = true;
+      for (int i = 0; i < 6 && isVisible; ++i)
+      {
+        isVisible = glm::dot(glm::vec3(planes[face][i]), center) + planes[face][i].w >= -radius;
+      }
+      mask |= isVisible ? (1u << face) : 0u;
+    }
+    m_faceVisibility[teapot] = mask;
+  }
+}
+
+void CubemapRenderingApp::BuildFaceDrawLists(const glm::mat4 faceViewProj[6])
+{
+  m_faceDrawTriangles = 0;
+  for (int face = 0; face < 6; ++face)
+  {
+    auto& draws = m_faceDraws[face];
+    draws.clear();
+    for (uint32_t teapot = 0; teapot < 6; ++teapot)
+    {
+      if ((m_faceVisibility[teapot] & (1u << face)) == 0)
+      {
+        continue;
+      }
+      if (!m_isClusterCulling || m_teapotMeshlets.empty())
+      {
+        draws.push_back({ 0, m_teapot.indexCount, teapot });
+        m_faceDrawTriangles += m_teapot.indexCount / 3;
+        continue;
+      }
+      // fW̎Ǝ_Ŕ肵AAČ郁bVbg 1 ̕`ɂ܂Ƃ߂.
+      // pCvC͔wʃJOȂ(VK_CULL_MODE_NONE)̂ŁA@~ɂ锻͍sȂ.
+      const auto& world = m_cubemapEnvParams.world[teapot];
+      glm::vec4 planes[6];
+      MeshletBuilder::CalcFrustumPlanes(faceViewProj[face] * world, planes);
+      auto eye = glm::vec3(glm::inverse(world) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+      for (const auto& meshlet : m_teapotMeshlets)
+      {
+        if (!MeshletBuilder::IsVisible(meshlet, planes, eye, false))
+        {
+          continue;
+        }
+        if (!draws.empty() && draws.back().teapot == teapot &&
+          draws.back().firstIndex + draws.back().indexCount == meshlet.firstIndex)
+        {
+          draws.back().indexCount += meshlet.indexCount;
+        }
+        else
+        {
+          draws.push_back({ meshlet.firstIndex, meshlet.indexCount, teapot });
+        }
+        m_faceDrawTriangles += meshlet.indexCount / 3;
+      }
+    }
+  }
+}
+
+uint32_t CubemapRenderingApp::ScheduleCubemapFaces(const glm::vec4& lightDir, uint32_t& publishFaces)
+{
+  // `⃉Cgς炷ׂĂ̖ʂÂ̂Ƃ.
+  // ӃeB[|bg̔zu(m_cubemapEnvUniform)ꍇŔłi߂邱.
+  if (m_scheduledMode != m_mode || m_scheduledLightDir != lightDir)
+  {
+    ++m_sceneRevision;
+    m_scheduledMode = m_mode;
+    m_scheduledLightDir = lightDir;
+  }
+  // _(v[üʒu)ςʂÂ̂Ƃ.
+  uint32_t dirtyFaces = 0;
+  for (uint32_t face = 0; face < 6; ++face)
+  {
+    const auto& state = m_faceStates[face];
+    if (!state.isValid || state.sceneRevision != m_sceneRevision || state.viewProj != m_faceViewProj[face])
+    {
+      dirtyFaces |= 1u << face;
+    }
+  }
+
+  // XVTCN̊Jn_ŌÂʂoĂA\Z͈̔͂őȎ̖ʂ珇ɕ`悷.
+  // rŌÂȂʂ͎̃TCNŕ`(_Ăf~܂Ȃ悤).
+  if (m_cycleFaces == 0)
+  {
+    m_cycleFaces = dirtyFaces;
+  }
+  uint32_t faces = 0;
+  int count = 0;
+  auto start = m_nextFace;
+  for (uint32_t i = 0; i < 6 && count < m_faceUpdateBudget; ++i)
+  {
+    auto face = (start + i) % 6;
+    if (m_cycleFaces & (1u << face))
+    {
+      faces |= 1u << face;
+      m_nextFace = (face + 1) % 6;
+      ++count;
+
+      auto& state = m_faceStates[face];
+      state.viewProj = m_faceViewProj[face];
+      state.sceneRevision = m_sceneRevision;
+      state.isValid = true;
+    }
+  }
+  m_pendingFaces |= faces;
+  m_cycleFaces &= ~faces;
+
+  // TCN̖ʂׂĕ`_ł܂Ƃ߂Ĕf.
+  // 1 ʂfƁAV̖ʂ̌pڂŉf荞݂HČ邽.
+  publishFaces = 0;
+  if (m_cycleFaces == 0)
+  {
+    publishFaces = m_pendingFaces;
+    m_pendingFaces = 0;
+  }
+  return faces;
+}
+
+void CubemapRenderingApp::PublishCubemapFaces(VkCommandBuffer command, uint32_t faceMask)
+{
+  VkImageMemoryBarrier imageBarriers[2] = {
+    {
+      VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER, nullptr,
+      VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+      VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+      VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+      m_cubemapRendered.image,
+      { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 6 }
+    },
+    {
+      VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER, nullptr,
+      VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+      m_cubemapDisplay.image,
+      { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 6 }
+    },
+  };
+  // Õt[ł̕\p̎Q(vtB^)ÃoAő҂.
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+    VK_PIPELINE_STAGE_TRANSFER_BIT,
+    0, 0, nullptr, 0, nullptr,
+    _countof(imageBarriers), imageBarriers);
+
+  std::vector<VkImageCopy> regions;
+  for (uint32_t face = 0; face < 6; ++face)
+  {
+    if (faceMask & (1u << face))
+    {
+      VkImageCopy region{};
+      region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, face, 1 };
+      region.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, face, 1 };
+      region.extent = { CubeEdge, CubeEdge, 1 };
+      regions.push_back(region);
+    }
+  }
+  vkCmdCopyImage(command,
+    m_cubemapRendered.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+    m_cubemapDisplay.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+    uint32_t(regions.size()), regions.data());
+
+  // `͎̍XVɔăJ[A^b`g֖߂.
+  imageBarriers[0].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+  imageBarriers[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+  imageBarriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+  imageBarriers[0].newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  imageBarriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  imageBarriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  imageBarriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  imageBarriers[1].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_TRANSFER_BIT,
+    VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+    0, 0, nullptr, 0, nullptr,
+    _countof(imageBarriers), imageBarriers);
+}
+
+void CubemapRenderingApp::FilterEnvironment(VkCommandBuffer command, PrefilteredEnvironment& env, VkDescriptorSet dsSource)
+{
+  // Õt[̕`悪vtB^ʂƌWQƂÎ҂.
+  // tB^ƕa͐ÓI/Iŋp̂ŁAÕtB^̊҂.
+  VkImageMemoryBarrier imageBarrier{
+    VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER, nullptr,
+    VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+    VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+    env.image.image,
+    { VK_IMAGE_ASPECT_COLOR_BIT, 0, PrefilterLevels, 0, 6 }
+  };
+  VkBufferMemoryBarrier bufferBarrier{
+    VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER, nullptr,
+    VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+    env.irradiance.buffer, 0, VK_WHOLE_SIZE
+  };
+  VkMemoryBarrier scratchBarrier{
+    VK_STRUCTURE_TYPE_MEMORY_BARRIER, nullptr,
+    VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+    VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+  };
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+    0, 1, &scratchBarrier,
+    1, &bufferBarrier,
+    1, &imageBarrier);
+
+  // ̃L[u}bvtB^̃x 0 ֎ʂ.
+  auto pipelineLayout = GetPipelineLayout("compute_prefilter");
+  vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_COMPUTE, m_prefilterPipeline);
+  vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &dsSource, 0, nullptr);
+  uint32_t groups = (CubeEdge + 7) / 8;
+  vkCmdDispatch(command, groups, groups, 6);
+
+  // 2x2 ̕ςŏkĂ(傤ǔւ̐`tB^̃ubg).
+  VkImageMemoryBarrier sourceBarrier{
+    VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER, nullptr,
+    VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+    VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+    m_filterSource.image.image,
+    { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 6 }
+  };
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+    0, 0, nullptr,
+    0, nullptr,
+    1, &sourceBarrier);
+  for (uint32_t level = 1; level < FilterSourceLevels; ++level)
+  {
+    auto srcEdge = int32_t(CubeEdge >> (level - 1));
+    auto dstEdge = int32_t(CubeEdge >> level);
+    VkImageBlit region{
+      { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 6 },
+      { { 0, 0, 0 }, { srcEdge, srcEdge, 1 } },
+      { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 6 },
+      { { 0, 0, 0 }, { dstEdge, dstEdge, 1 } },
+    };
+    vkCmdBlitImage(command,
+      m_filterSource.image.image, VK_IMAGE_LAYOUT_GENERAL,
+      m_filterSource.image.image, VK_IMAGE_LAYOUT_GENERAL,
+      1, &region, VK_FILTER_LINEAR);
+
+    sourceBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    sourceBarrier.subresourceRange.baseMipLevel = level;
+    vkCmdPipelineBarrier(command,
+      VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+      0, 0, nullptr,
+      0, nullptr,
+      1, &sourceBarrier);
+  }
+  // Sx݂̏ȍ~̃Rs[gVF[_[猩悤ɂ.
+  sourceBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+  sourceBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  sourceBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, FilterSourceLevels, 0, 6 };
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+    0, 0, nullptr,
+    0, nullptr,
+    1, &sourceBarrier);
+
+  // ex̓tB^QƂ̂ŁAxԂ̑҂킹͗vȂ.
+  for (uint32_t level = 0; level < PrefilterLevels; ++level)
+  {
+    vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &env.dsLevels[level], 0, nullptr);
+    groups = ((CubeEdge >> level) + 7) / 8;
+    vkCmdDispatch(command, groups, groups, 6);
+  }
+
+  // kx 8x8 eNZˉeĕaAv.
+  pipelineLayout = GetPipelineLayout("compute_irradiance");
+  vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_COMPUTE, m_irradiancePipeline);
+  vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &env.dsIrradiance, 0, nullptr);
+  groups = ((CubeEdge >> IrradianceSourceLevel) + 7) / 8;
+  vkCmdDispatch(command, groups, groups, 6);
+
+  VkBufferMemoryBarrier partialsBarrier{
+    VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER, nullptr,
+    VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+    m_shPartials.buffer, 0, VK_WHOLE_SIZE
+  };
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+    0, 0, nullptr,
+    1, &partialsBarrier,
+    0, nullptr);
+  vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_COMPUTE, m_irradianceReducePipeline);
+  vkCmdDispatch(command, 1, 1, 1);
+
+  // ̃eB[|bg̕`ŎQƂł悤ɂ.
+  imageBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  imageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  bufferBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+    0, 0, nullptr,
+    1, &bufferBarrier,
+    1, &imageBarrier);
+}
 
 void CubemapRenderingApp::RenderToMain(VkCommandBuffer command)
 {
-  auto pipelineLayout = GetPipelineLayout("u1t1");
+  auto pipelineLayout = GetPipelineLayout("u1t1b1");
   auto imageIndex = m_imageIndex;
   auto extent = m_swapchain->GetSurfaceExtent();
   VkViewport viewport = book_util::GetViewportFlipped(float(extent.width), float(extent.height));
@@ -1184,7 +2256,7 @@ void CubemapRenderingApp::RenderToMain(VkCommandBuffer command)
   }
   else
   {
-    ds = m_centerTeapot.dsCubemapRendered[imageIndex];
+    ds = m_centerTeapot.dsCubemapDynamic[imageIndex];
   }
   vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &ds, 0, nullptr);
 
@@ -1213,7 +2285,51 @@ void CubemapRenderingApp::RenderHUD(VkCommandBuffer command)
   // ImGui EBWFbg`悷.
   ImGui::Begin("Information");
   ImGui::Text("Framerate: %.1f FPS", ImGui::GetIO().Framerate);
-  ImGui::Combo("Mode", (int*)&m_mode, "Static\0MultiPass\0SinglePass\0\0");
+  ImGui::Combo("Mode", (int*)&m_mode, "Static\0MultiPass\0SinglePass\0Multiview\0Layered\0\0");
+  if ((m_mode == Mode_MultiviewCubemap && !m_isMultiviewSupported) ||
+    (m_mode == Mode_LayeredCubemap && !m_isLayerOutputSupported))
+  {
+    // Ή̃foCXł̓WIgVF[_[łőp.
+    m_mode = Mode_SinglePassCubemap;
+  }
+  if (!m_isMultiviewSupported)
+  {
+    ImGui::Text("Multiview: not supported");
+  }
+  if (!m_isLayerOutputSupported)
+  {
+    ImGui::Text("Layered: VK_EXT_shader_viewport_index_layer not supported");
+  }
+  ImGui::Text("GPU cubemap: MultiPass %.3f ms, SinglePass(GS) %.3f ms",
+    m_cubemapMilliseconds[Mode_MultiPassCubemap],
+    m_cubemapMilliseconds[Mode_SinglePassCubemap]);
+  ImGui::Text("GPU cubemap: Multiview %.3f ms, Layered %.3f ms",
+    m_cubemapMilliseconds[Mode_MultiviewCubemap],
+    m_cubemapMilliseconds[Mode_LayeredCubemap]);
+  ImGui::Text("GPU prefilter + SH: %.3f ms", m_filterMilliseconds);
+  ImGui::SliderFloat("Roughness", &m_roughness, 0.0f, 1.0f);
+  ImGui::SliderFloat("Metallic", &m_metallic, 0.0f, 1.0f);
+  ImGui::Checkbox("Per-face Culling", &m_isFaceCulling);
+  ImGui::Checkbox("Cluster Culling (MultiPass)", &m_isClusterCulling);
+  ImGui::Text("Visible teapot faces: %u / %u", m_aroundTeapotsLayered.instanceCount, 6u * 6u);
+  ImGui::Text("MultiPass triangles: %u / %u", m_faceDrawTriangles, 6u * 6u * (m_teapot.indexCount / 3));
+  ImGui::Checkbox("Scheduled Update", &m_isScheduledUpdate);
+  ImGui::SliderInt("Faces / Frame", &m_faceUpdateBudget, 1, 6);
+  if (ImGui::Button("Force Update"))
+  {
+    ++m_sceneRevision;
+  }
+  auto countFaces = [](uint32_t mask) {
+    int count = 0;
+    for (; mask != 0; mask &= mask - 1) ++count;
+    return count;
+  };
+  ImGui::Text("Faces rendered: %d, pending: %d", countFaces(m_renderedFaces), countFaces(m_pendingFaces));
+  ImGui::Text("Teapot ACMR: %.3f -> %.3f, ATVR: %.3f -> %.3f",
+    m_teapotOptimizeResult.before.acmr, m_teapotOptimizeResult.after.acmr,
+    m_teapotOptimizeResult.before.atvr, m_teapotOptimizeResult.after.atvr);
+  ImGui::Combo("Vertex Format", &m_vertexFormat, "Float32\0Unorm16 + Oct16\0Unorm16 + 10:10:10:2\0\0");
+  ImGui::Text("Vertex Stride: %u bytes", m_teapotVertexStride);
   ImGui::End();
 
   ImGui::Render();
@@ -1223,6 +2339,37 @@ void CubemapRenderingApp::RenderHUD(VkCommandBuffer command)
 
 }
 
+void CubemapRenderingApp::ReadTimestamps(uint32_t imageIndex)
+{
+  if (!m_isTimestampSupported)
+  {
+    return;
+  }
+  // tFX҂Ȃ̂Ōʂ͎擾ł.
+  uint64_t timestamps[4];
+  auto queryBase = imageIndex * TimestampsPerImage;
+  if (m_timestampModes[imageIndex] != Mode_StaticCubemap)
+  {
+    auto result = vkGetQueryPoolResults(
+      m_device, m_timestampPool, queryBase, 2,
+      sizeof(uint64_t) * 2, timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result == VK_SUCCESS)
+    {
+      m_cubemapMilliseconds[m_timestampModes[imageIndex]] = double(timestamps[1] - timestamps[0]) * m_timestampPeriod * 1.0e-6;
+    }
+  }
+  if (m_isFilterTimed[imageIndex])
+  {
+    auto result = vkGetQueryPoolResults(
+      m_device, m_timestampPool, queryBase + 2, 2,
+      sizeof(uint64_t) * 2, &timestamps[2], sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result == VK_SUCCESS)
+    {
+      m_filterMilliseconds = double(timestamps[3] - timestamps[2]) * m_timestampPeriod * 1.0e-6;
+    }
+  }
+}
+
 void CubemapRenderingApp::BarrierRTToTexture(VkCommandBuffer command)
 {
   VkImageMemoryBarrier imageBarrier{
@@ -1239,7 +2386,7 @@ void CubemapRenderingApp::BarrierRTToTexture(VkCommandBuffer command)
   };
   vkCmdPipelineBarrier(command,
     VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
     0,
     0, nullptr, // memoryBarrier
     0, nullptr, // bufferMemoryBarrier
@@ -1262,7 +2409,7 @@ void CubemapRenderingApp::BarrierTextureToRT(VkCommandBuffer command)
           { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 6 }
   };
   vkCmdPipelineBarrier(command,
-    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
     VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
     0,
     0, nullptr, // memoryBarrier
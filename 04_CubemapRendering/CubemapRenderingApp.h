@@ -3,6 +3,9 @@
 #include <glm/glm.hpp>
 #include <array>
 #include "Camera.h"
+#include "MeshOptimizer.h"
+#include "MeshFile.h"
+#include "VertexQuantizer.h"
 
 class CubemapRenderingApp : public VulkanAppBase
 {
@@ -36,15 +39,48 @@ private:
 
   void PrepareRenderTargetForMultiPass();
   void PrepareRenderTargetForSinglePass();
+  void PrepareRenderTargetForMultiview();
 
+  // ʔ˗p̃vtB^ς݃L[u}bvƁAgU˗p̋ʒa֐Rs[gpX̏.
+  void PrepareEnvironmentFilter();
   void PrepareCenterTeapotDescriptors();
   void PrepareAroundTeapotDescriptors();
+  void CreateTeapotPipelines();
+  void DestroyTeapotPipelines();
 
-  void RenderCubemapFaces(VkCommandBuffer command);
+  // w肵_`̃bVt@CeB[|bgǂݍ.
+  void LoadTeapotModel(VertexQuantizer::NormalEncoding encoding);
+  // HUD Œ_`ύXĂ΁AfƃpCvC蒼.
+  void UpdateTeapotVertexFormat();
+
+  // ӃeB[|bgƂɁA܋ƌL[u}bv̖ʂrbgŋ߂.
+  // ׂ͂Ă̖ʂƂ.
+  void UpdateFaceVisibility(const glm::mat4 faceViewProj[6]);
+  // ʂƂ̕`惊Xg. NX^JOLȂ烁bVbgPʂōi荞.
+  void BuildFaceDrawLists(const glm::mat4 faceViewProj[6]);
+
+  // eÂȂʂA\Z͈̔͂ō`悷ʂI.
+  // Âʂׂĕ`_ŁA\p֔fʂ publishFaces ɕԂ.
+  uint32_t ScheduleCubemapFaces(const glm::vec4& lightDir, uint32_t& publishFaces);
+  // `悵Iʂ\p̃L[u}bv֔f.
+  void PublishCubemapFaces(VkCommandBuffer command, uint32_t faceMask);
+
+  // faceMask Ŏw肵ʂʂƂ̃pXŕ`悷.
+  void RenderCubemapFaces(VkCommandBuffer command, uint32_t faceMask = 0x3F);
   void RenderCubemapOnce(VkCommandBuffer command);
+  void RenderCubemapMultiview(VkCommandBuffer command);
+  void RenderCubemapLayered(VkCommandBuffer command);
   void RenderToMain(VkCommandBuffer command);
   void RenderHUD(VkCommandBuffer command);
 
+  struct PrefilteredEnvironment;
+  // source ̃L[u}bvvtB^ς݂̃~bvƋʒa֐̌W蒼.
+  // dsSource ̓x 0 Ƃ̃fBXNv^(̃L[u}bvQƂ).
+  void FilterEnvironment(VkCommandBuffer command, PrefilteredEnvironment& env, VkDescriptorSet dsSource);
+  VkDescriptorSet CreatePrefilterDescriptorSet(uint32_t level, VkImageView source, VkImageLayout sourceLayout, VkImageView dest);
+  // tFX҂̌ɁAO񂱂̃C[WŌvL[u}bv`掞Ԃǂݏo.
+  void ReadTimestamps(uint32_t imageIndex);
+
   // \[XoA̐ݒ.
   void BarrierRTToTexture(VkCommandBuffer command);
   void BarrierTextureToRT(VkCommandBuffer command);
@@ -64,8 +100,19 @@ private:
 
   Camera m_camera;
   ModelData m_teapot;
+  MeshOptimizer::Result m_teapotOptimizeResult; // _LbV̍œKO(ϊ)ƌ(ǂݍ񂾃bV).
+  std::vector<VkVertexInputBindingDescription> m_teapotVertexBindings;
+  std::vector<VkVertexInputAttributeDescription> m_teapotVertexAttributes;
+  uint32_t m_teapotVertexStride;
+  VertexQuantizer::DecodeParameters m_teapotDecodeParams;
+  VkSpecializationInfo m_teapotDecodeInfo; // _VF[_[̓ꉻ萔(m_teapotDecodeParams Q).
+  glm::vec4 m_teapotBoundingSphere; // fWł̕܋(xyz: S, w: a).
+  std::vector<MeshFile::Meshlet> m_teapotMeshlets;
+  int m_vertexFormat; // HUD őI𒆂̌`(VertexQuantizer::NormalEncoding).
+  VertexQuantizer::NormalEncoding m_loadedVertexFormat;
   ImageObject m_staticCubemap;
   ImageObject m_cubemapRendered;
+  ImageObject m_cubemapDisplay; // XVXPW[gpɒ̃eB[|bgQƂ(`r̖ʂȂ).
   VkSampler m_cubemapSampler;
 
   struct ShaderParameters
@@ -75,6 +122,7 @@ private:
     glm::mat4 proj;
     glm::vec4 lightDir;
     glm::vec4 cameraPos;
+    glm::vec4 material; // x: e, y: x, z: vtB^ς݃L[u}bv̍ő~bvx.
   };
 
   struct TeapotInstanceParameters {
@@ -92,8 +140,49 @@ private:
     glm::mat4 view[6];
     glm::mat4 proj;
     glm::vec4 lightDir;
+    glm::uvec4 faceMasks[6]; // x: ӃeB[|bgƂ̉Ȗ(WIgVF[_[ƃ}`r[̒_VF[_[Ŏgp).
   };
   BufferObject m_cubemapEnvUniform;
+  TeapotInstanceParameters m_cubemapEnvParams; // m_cubemapEnvUniform ɏ񂾓e(CPU ł̉p).
+  uint32_t m_faceVisibility[6]; // ӃeB[|bgƂ̉Ȗʂ̃rbg}XN.
+  bool m_isFaceCulling;
+  bool m_isClusterCulling;
+
+  // }`pXŊeʂɔs`. firstInstance ŃeB[|bgI.
+  struct CubeFaceDraw
+  {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t teapot;
+  };
+  std::vector<CubeFaceDraw> m_faceDraws[6];
+  uint32_t m_faceDrawTriangles; // 6 ʂ̕`惊Xg̎Op`̍v.
+  glm::mat4 m_faceViewProj[6];
+
+  // L[u}bv̍XVXPW[.
+  // ʂƂɕ`悵Ƃ̃V[̔łƎ_oĂAωʂ`.
+  struct CubeFaceState
+  {
+    glm::mat4 viewProj;
+    uint32_t sceneRevision;
+    bool isValid;
+  };
+  bool m_isScheduledUpdate;
+  int m_faceUpdateBudget; // 1 t[ŕ`悷ʂ̍ő吔.
+  uint32_t m_sceneRevision; // V[(zu, Cg, _`, `)ς邽тɐi߂.
+  CubeFaceState m_faceStates[6];
+  uint32_t m_nextFace; // \ZȂƂɏԂɉ񂷂߂̊Jnʒu.
+  uint32_t m_cycleFaces; // ̍XVTCNŕ`悪cĂ.
+  uint32_t m_pendingFaces; // `ς݂ŕ\p֖f̖.
+  uint32_t m_renderedFaces; // ̃t[ŕ`悵.
+  int m_scheduledMode;
+  glm::vec4 m_scheduledLightDir;
+
+  // gl_Layer o͔łŕ`悷CX^Ẍꗗ. x = eB[|bgԍ | ( << 4).
+  struct LayeredInstanceParameters
+  {
+    glm::uvec4 instances[6 * 6];
+  };
 
 
   // ӃeB[|bg:(To Main)
@@ -113,21 +202,68 @@ private:
   } m_aroundTeapotsToFace;
 
   // ӃeB[|bg:(To CubemapOnce)
+  // WIgVF[_[łƃ}`r[łœfBXNv^(6 ʕ̃r[s)g.
   struct AroundTeapotsToCubeScene
   {
     VkPipeline pipeline;
+    VkPipeline multiviewPipeline; // }`r[ΉȂ VK_NULL_HANDLE.
     std::vector<BufferObject> cameraViewUniform;
     std::vector<VkDescriptorSet> descriptors;
   } m_aroundTeapotsToCubemap;
 
+  // ӃeB[|bg:(To Cubemap, _VF[_[ gl_Layer w)
+  struct AroundTeapotsToCubeLayeredScene
+  {
+    VkPipeline pipeline; // gl_Layer o͔ΉȂ VK_NULL_HANDLE.
+    std::vector<BufferObject> instanceUniform;
+    std::vector<VkDescriptorSet> descriptors;
+    uint32_t instanceCount;
+  } m_aroundTeapotsLayered;
+
   // S̃eB[|bg.
+  // IȃL[u}bv́AXPW[̗Lɂ炸 m_prefilteredDynamic ʂĎQƂ.
   struct CenterTeapot
   {
     std::vector<VkDescriptorSet> dsCubemapStatic;
-    std::vector<VkDescriptorSet> dsCubemapRendered;
+    std::vector<VkDescriptorSet> dsCubemapDynamic;
     std::vector<BufferObject> sceneUBO;
     VkPipeline pipeline;
   } m_centerTeapot;
+  float m_roughness;
+  float m_metallic;
+
+  // GGX ŃvtB^L[u}bv(x i ̑e i / (PrefilterLevels - 1))
+  // ˏƓx̋ʒa֐̌W. CAEg͏ GENERAL ̂܂܎g.
+  struct PrefilterParameters
+  {
+    glm::vec4 params; // x: GGX  alpha, y: Tv.
+  };
+  struct PrefilteredEnvironment
+  {
+    ImageObject image; // view ͑Sx̃L[u}bv.
+    std::vector<VkImageView> storageViews; // ݗp(x 2D z).
+    VkDescriptorSet dsCopySource; // ̃L[u}bvtB^̃x 0 ֎ʂ.
+    std::vector<VkDescriptorSet> dsLevels; // ǂ̃xtB^̑SxQƂ.
+    VkDescriptorSet dsIrradiance;
+    BufferObject irradiance; // vec4 sh[9].
+  };
+  PrefilteredEnvironment m_prefilteredStatic;
+  PrefilteredEnvironment m_prefilteredDynamic;
+  VkDescriptorSet m_dsPrefilterFromDisplay; // XPW[gp͕\p̃L[u}bvʂ.
+  std::vector<BufferObject> m_prefilterUniform; // x PrefilterParameters.
+  VkPipeline m_prefilterPipeline;
+  VkPipeline m_irradiancePipeline;
+  VkPipeline m_irradianceReducePipeline;
+  VkSampler m_prefilteredSampler;
+
+  // vtB^Ƌʒa֐ւ̎ˉeŋptB^.
+  // ̃L[u}bv RGBA16F ֎ʂA2x2 ̕ς 1x1 ܂ŏk~bv.
+  struct FilterSource
+  {
+    ImageObject image; // view ͑Sx̃L[u}bv.
+    std::vector<VkImageView> storageViews; // x 2D z.
+  } m_filterSource;
+  BufferObject m_shPartials; // shProjectCS ̃[NO[v̕a.
 
   struct CubeFaceScene
   {
@@ -145,15 +281,41 @@ private:
     VkRenderPass renderPass;
   } m_cubeScene;
 
+  // }`r[p. r[ƃfvX m_cubeScene ̂̂L.
+  struct CubemapMultiviewScene
+  {
+    VkFramebuffer framebuffer;
+    VkRenderPass renderPass;
+  } m_cubeMultiviewScene;
+
 
   const uint32_t CubeEdge = 512;
   const VkFormat CubemapFormat = VK_FORMAT_R8G8B8A8_UNORM;
+  const uint32_t PrefilterLevels = 6; // 512  16 ܂.
+  const uint32_t PrefilterSampleCount = 32;
+  const uint32_t FilterSourceLevels = 10; // 512  1 ܂.
+  const uint32_t IrradianceSourceLevel = 2; // ʒa֐֎ˉetB^̃x(128x128).
   glm::mat4 m_projection;
 
   enum Mode {
     Mode_StaticCubemap,
     Mode_MultiPassCubemap,
     Mode_SinglePassCubemap,
+    Mode_MultiviewCubemap,
+    Mode_LayeredCubemap,
+    Mode_Count,
   };
   Mode m_mode;
+  bool m_isMultiviewSupported;
+  bool m_isLayerOutputSupported; // VK_EXT_shader_viewport_index_layer.
+
+  // L[u}bv`ƃtB^ GPU (C[WƂɊJn/I 2 NG).
+  bool m_isTimestampSupported;
+  VkQueryPool m_timestampPool;
+  double m_timestampPeriod; // imb/JEg.
+  std::vector<int> m_timestampModes; // v[h. vȂ Mode_StaticCubemap.
+  std::vector<bool> m_isFilterTimed;
+  double m_cubemapMilliseconds[Mode_Count];
+  double m_filterMilliseconds;
+  const uint32_t TimestampsPerImage = 4;
 };
\ No newline at end of file
@@ -0,0 +1,57 @@
+#version 450
+#extension GL_ARB_shader_viewport_layer_array : require
+#extension GL_GOOGLE_include_directive : enable
+// _VF[_[ gl_Layer w肵 6 ʂ֕`悷(VK_EXT_shader_viewport_index_layer).
+// CX^XƂɕ`悷eB[|bgƖʂꗗo.
+
+layout(location=0) in vec4 inPos;
+layout(location=1) in vec4 inNormal;
+
+layout(location=0) out vec3 outColor;
+layout(location=1) out vec3 outNormal;
+
+layout(set=0, binding=0)
+uniform CubemapEnvParameters
+{
+  mat4 world[6];
+  vec4 colors[6];
+};
+
+layout(set=0, binding=1)
+uniform ViewMatrices
+{
+  mat4 view[6];
+  mat4 proj;
+  vec4 lightDir;
+  uvec4 faceMasks[6];
+};
+
+layout(set=0, binding=2)
+uniform LayeredInstances
+{
+  uvec4 instances[36]; // x = eB[|bgԍ | ( << 4).
+};
+
+out gl_PerVertex
+{
+  vec4 gl_Position;
+};
+
+#include "../common/quantize.glsl"
+
+void main()
+{
+  uint instance = instances[gl_InstanceIndex].x;
+  uint teapot = instance & 0xFu;
+  uint face = instance >> 4;
+
+  vec4 pos = DecodePosition(inPos);
+  vec3 normal = DecodeNormal(inNormal);
+  gl_Position = proj * view[face] * world[teapot] * pos;
+  gl_Layer = int(face);
+  
+  vec3 worldNormal = mat3(world[teapot]) * normal;
+  float l = dot(worldNormal, normalize(lightDir.xyz)) * 0.5 + 0.5;
+  outColor = colors[teapot].xyz * l;
+  outNormal = worldNormal;
+}
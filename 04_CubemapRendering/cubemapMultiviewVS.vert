@@ -0,0 +1,54 @@
+#version 450
+#extension GL_EXT_multiview : require
+#extension GL_GOOGLE_include_directive : enable
+// }`r[ 6 ʂ֓ɕ`悷. ʂ gl_ViewIndex(r[}XÑrbgԍ)őI.
+// Sr[Œ_VF[_[ŝŁAȂ(faceMasks)ł̓Nbv̈̊O֏oĎ̂Ă.
+
+layout(location=0) in vec4 inPos;
+layout(location=1) in vec4 inNormal;
+
+layout(location=0) out vec3 outColor;
+layout(location=1) out vec3 outNormal;
+
+layout(set=0, binding=0)
+uniform CubemapEnvParameters
+{
+  mat4 world[6];
+  vec4 colors[6];
+};
+
+layout(set=0, binding=1)
+uniform ViewMatrices
+{
+  mat4 view[6];
+  mat4 proj;
+  vec4 lightDir;
+  uvec4 faceMasks[6];
+};
+
+out gl_PerVertex
+{
+  vec4 gl_Position;
+};
+
+#include "../common/quantize.glsl"
+
+void main()
+{
+  if ((faceMasks[gl_InstanceIndex].x & (1u << gl_ViewIndex)) == 0)
+  {
+    // Op`̑S_ʒuɂȂANbv.
+    gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+    outColor = vec3(0);
+    outNormal = vec3(0);
+    return;
+  }
+  vec4 pos = DecodePosition(inPos);
+  vec3 normal = DecodeNormal(inNormal);
+  gl_Position = proj * view[gl_ViewIndex] * world[gl_InstanceIndex] * pos;
+  
+  vec3 worldNormal = mat3(world[gl_InstanceIndex]) * normal;
+  float l = dot(worldNormal, normalize(lightDir.xyz)) * 0.5 + 0.5;
+  outColor = colors[gl_InstanceIndex].xyz * l;
+  outNormal = worldNormal;
+}
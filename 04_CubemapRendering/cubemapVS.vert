@@ -1,10 +1,12 @@
 #version 450
+#extension GL_GOOGLE_include_directive : enable
 
 layout(location=0) in vec4 inPos;
-layout(location=1) in vec3 inNormal;
+layout(location=1) in vec4 inNormal;
 
 layout(location=0) out vec3 outColor;
 layout(location=1) out vec3 outNormal;
+layout(location=2) flat out uint outTeapot; // WIgVF[_[Ŗʃ}XN.
 
 layout(set=0, binding=0)
 uniform CubemapEnvParameters
@@ -19,6 +21,7 @@ uniform ViewMatrices
   mat4 view[6];
   mat4 proj;
   vec4 lightDir;
+  uvec4 faceMasks[6];
 };
 
 out gl_PerVertex
@@ -26,12 +29,17 @@ out gl_PerVertex
   vec4 gl_Position;
 };
 
+#include "../common/quantize.glsl"
+
 void main()
 {
-  gl_Position =world[gl_InstanceIndex] * inPos;
+  vec4 pos = DecodePosition(inPos);
+  vec3 normal = DecodeNormal(inNormal);
+  gl_Position =world[gl_InstanceIndex] * pos;
   
-  vec3 worldNormal = mat3(world[gl_InstanceIndex]) * inNormal;
+  vec3 worldNormal = mat3(world[gl_InstanceIndex]) * normal;
   float l = dot(worldNormal, normalize(lightDir.xyz)) * 0.5 + 0.5;
   outColor = colors[gl_InstanceIndex].xyz * l;
   outNormal = worldNormal;
+  outTeapot = uint(gl_InstanceIndex);
 }
@@ -14,11 +14,33 @@ uniform SceneParameters
   mat4  proj;
   vec4  lightDir;
   vec4  cameraPos;
+  vec4  material; // x: e, y: x, z: vtB^ς݃L[u}bv̍ő~bvx.
 };
 
+// eɉ GGX łڂ~bvL[u}bv.
 layout(set=0, binding=1)
 uniform samplerCube samplerColor;
 
+// ˏƓx̋ʒa֐̌W(]ŏݍݍς).
+layout(set=0, binding=2)
+readonly buffer Irradiance
+{
+  vec4 sh[9];
+};
+
+vec3 IrradianceSH(vec3 n)
+{
+  return sh[0].rgb * 0.282095
+    + sh[1].rgb * (0.488603 * n.y)
+    + sh[2].rgb * (0.488603 * n.z)
+    + sh[3].rgb * (0.488603 * n.x)
+    + sh[4].rgb * (1.092548 * n.x * n.y)
+    + sh[5].rgb * (1.092548 * n.y * n.z)
+    + sh[6].rgb * (0.315392 * (3.0 * n.z * n.z - 1.0))
+    + sh[7].rgb * (1.092548 * n.x * n.z)
+    + sh[8].rgb * (0.546274 * (n.x * n.x - n.y * n.y));
+}
+
 void main()
 {
 //  vec3 toEye = normalize(cameraPos.xyz - inWorldPos.xyz);
@@ -32,10 +54,18 @@ void main()
 //  vec4 color = inColor;
 //  color.rgb += specular;
 
-  outColor = vec4(inColor, 1);
+  vec3 normal = normalize(inNormal);
+  vec3 toEye = normalize(cameraPos.xyz - inWorldPos.xyz);
+  vec3 r = reflect(-toEye, normal);
+  float roughness = material.x;
+  float metallic = material.y;
+
+  // ʔ˂͑eɑΉ~bv 1 QƂ邾. gU˂͋ʒa֐狁߂.
+  vec3 specular = textureLod(samplerColor, r, roughness * material.z).rgb;
+  vec3 diffuse = max(IrradianceSH(normal), vec3(0.0));
 
-  vec3 incident = normalize(inWorldPos.xyz - cameraPos.xyz);
-  vec3 r = reflect(incident, inNormal);
-  vec4 color = texture(samplerColor, r) * vec4(inColor,1);
-  outColor = color;
+  float f0 = mix(0.04, 1.0, metallic);
+  float fresnel = f0 + (max(1.0 - roughness, f0) - f0) * pow(1.0 - max(dot(normal, toEye), 0.0), 5.0);
+  vec3 color = diffuse * (1.0 - fresnel) * (1.0 - metallic) + specular * fresnel;
+  outColor = vec4(color * inColor, 1);
 }
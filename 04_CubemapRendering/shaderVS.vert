@@ -1,7 +1,8 @@
 #version 450
+#extension GL_GOOGLE_include_directive : enable
 
 layout(location=0) in vec4 inPos;
-layout(location=1) in vec3 inNormal;
+layout(location=1) in vec4 inNormal;
 
 layout(location=0) out vec3 outColor;
 layout(location=1) out vec3 outNormal;
@@ -22,13 +23,17 @@ uniform SceneParameters
   vec4  lightDir;
 };
 
+#include "../common/quantize.glsl"
+
 void main()
 {
-  gl_Position = proj * view * world * inPos;
+  vec4 pos = DecodePosition(inPos);
+  vec3 normal = DecodeNormal(inNormal);
+  gl_Position = proj * view * world * pos;
   
-  vec3 worldNormal = mat3(world) * inNormal;
+  vec3 worldNormal = mat3(world) * normal;
   float l = dot(worldNormal, normalize(lightDir.xyz)) * 0.5 + 0.5;
   outColor = vec3(l);
   outNormal = worldNormal;
-  outWorldPos = world * inPos;
+  outWorldPos = world * pos;
 }
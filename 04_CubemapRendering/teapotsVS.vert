@@ -1,7 +1,8 @@
 #version 450
+#extension GL_GOOGLE_include_directive : enable
 
 layout(location=0) in vec4 inPos;
-layout(location=1) in vec3 inNormal;
+layout(location=1) in vec4 inNormal;
 
 layout(location=0) out vec4 outColor;
 layout(location=1) out vec3 outNormal;
@@ -25,12 +26,16 @@ uniform ViewMatrices
   vec4 lightDir;
 };
 
+#include "../common/quantize.glsl"
+
 void main()
 {
+  vec4 pos = DecodePosition(inPos);
+  vec3 normal = DecodeNormal(inNormal);
   mat4 pv = proj * view;
-  gl_Position = pv * world[gl_InstanceIndex] * inPos;
+  gl_Position = pv * world[gl_InstanceIndex] * pos;
   
-  vec3 worldNormal = mat3(world[gl_InstanceIndex]) * inNormal;
+  vec3 worldNormal = mat3(world[gl_InstanceIndex]) * normal;
   float l = dot(worldNormal, normalize(lightDir.xyz)) * 0.5 + 0.5;
   outColor = colors[gl_InstanceIndex] * l;
   outNormal = worldNormal;
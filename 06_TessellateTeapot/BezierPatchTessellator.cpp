@@ -0,0 +1,200 @@
+#include "BezierPatchTessellator.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <emmintrin.h>
+
+namespace
+{
+  // 3 ̃o[X^CƂ̔.
+  void CalcBernsteinBasis(float t, float basis[4], float derivative[4])
+  {
+    float invT = 1.0f - t;
+    basis[0] = invT * invT * invT;
+    basis[1] = 3.0f * t * invT * invT;
+    basis[2] = 3.0f * t * t * invT;
+    basis[3] = t * t * t;
+    derivative[0] = -3.0f * invT * invT;
+    derivative[1] = 3.0f * invT * invT - 6.0f * t * invT;
+    derivative[2] = 6.0f * t * invT - 3.0f * t * t;
+    derivative[3] = 3.0f * t * t;
+  }
+
+  // w0*a + w1*b + w2*c + w3*d  xyz ɋ߂.
+  inline __m128 Combine4(const __m128 p[4], const float w[4])
+  {
+    __m128 r = _mm_mul_ps(p[0], _mm_set1_ps(w[0]));
+    r = _mm_add_ps(r, _mm_mul_ps(p[1], _mm_set1_ps(w[1])));
+    r = _mm_add_ps(r, _mm_mul_ps(p[2], _mm_set1_ps(w[2])));
+    return _mm_add_ps(r, _mm_mul_ps(p[3], _mm_set1_ps(w[3])));
+  }
+
+  inline __m128 Cross(__m128 a, __m128 b)
+  {
+    __m128 a1 = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 b1 = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 c = _mm_sub_ps(_mm_mul_ps(a, b1), _mm_mul_ps(a1, b));
+    return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+  }
+}
+
+BezierPatchTessellator::BezierPatchTessellator()
+  : m_threadCount(1)
+{
+}
+
+void BezierPatchTessellator::Setup(const std::vector<glm::vec3>& points, const std::vector<uint32_t>& indices, int threadCount)
+{
+  m_controlPoints.clear();
+  for (size_t i = 0; i + 16 <= indices.size(); i += 16)
+  {
+    for (int j = 0; j < 16; ++j)
+    {
+      m_controlPoints.push_back(glm::vec4(points[indices[i + j]], 0.0f));
+    }
+  }
+  if (threadCount <= 0)
+  {
+    threadCount = int(std::thread::hardware_concurrency());
+  }
+  m_threadCount = (std::max)(threadCount, 1);
+  ClearCache();
+}
+
+const BezierPatchTessellator::Mesh& BezierPatchTessellator::GetMesh(int level)
+{
+  level = (std::max)(level, 1);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& mesh = m_cache[level];
+  if (!mesh)
+  {
+    mesh.reset(new Mesh());
+    Tessellate(level, *mesh);
+  }
+  return *mesh;
+}
+
+bool BezierPatchTessellator::IsCached(int level) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_cache.find((std::max)(level, 1)) != m_cache.end();
+}
+
+void BezierPatchTessellator::ClearCache()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_cache.clear();
+}
+
+void BezierPatchTessellator::Tessellate(int level, Mesh& mesh) const
+{
+  level = (std::max)(level, 1);
+  auto patchCount = GetPatchCount();
+  auto verticesPerPatch = size_t(level + 1) * (level + 1);
+  auto indicesPerPatch = size_t(level) * level * 6;
+  mesh.vertices.resize(verticesPerPatch * patchCount);
+  mesh.indices.resize(indicesPerPatch * patchCount);
+
+  // pb`Pʂŏo͐悪܂Ă邽߁AXbhԂœɏ߂.
+  const uint32_t patchesPerJob = 4;
+  std::atomic<uint32_t> nextPatch(0);
+  auto worker = [&]() {
+    for (;;)
+    {
+      auto first = nextPatch.fetch_add(patchesPerJob);
+      if (first >= patchCount)
+      {
+        break;
+      }
+      TessellatePatches(level, first, (std::min)(patchesPerJob, patchCount - first), mesh);
+    }
+  };
+  auto threadCount = (std::min)(uint32_t(m_threadCount), (patchCount + patchesPerJob - 1) / patchesPerJob);
+  std::vector<std::thread> threads;
+  for (uint32_t i = 1; i < threadCount; ++i)
+  {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& t : threads)
+  {
+    t.join();
+  }
+}
+
+void BezierPatchTessellator::TessellatePatches(int level, uint32_t firstPatch, uint32_t patchCount, Mesh& mesh) const
+{
+  auto rowVertices = uint32_t(level + 1);
+  auto verticesPerPatch = size_t(rowVertices) * rowVertices;
+  auto indicesPerPatch = size_t(level) * level * 6;
+
+  // ͑Spb`ŋ.
+  std::vector<float> basis(rowVertices * 4), derivative(rowVertices * 4);
+  for (uint32_t i = 0; i < rowVertices; ++i)
+  {
+    CalcBernsteinBasis(float(i) / level, &basis[i * 4], &derivative[i * 4]);
+  }
+
+  for (uint32_t patch = firstPatch; patch < firstPatch + patchCount; ++patch)
+  {
+    __m128 cp[16];
+    for (int i = 0; i < 16; ++i)
+    {
+      cp[i] = _mm_loadu_ps(&m_controlPoints[patch * 16 + i].x);
+    }
+
+    auto* dstVertex = &mesh.vertices[patch * verticesPerPatch];
+    for (uint32_t iv = 0; iv < rowVertices; ++iv)
+    {
+      // v Œ肵 u  3 Ȑ̐_ƁA v ̔.
+      __m128 column[4], columnDv[4];
+      for (int j = 0; j < 4; ++j)
+      {
+        __m128 p[4] = { cp[j], cp[4 + j], cp[8 + j], cp[12 + j] };
+        column[j] = Combine4(p, &basis[iv * 4]);
+        columnDv[j] = Combine4(p, &derivative[iv * 4]);
+      }
+      for (uint32_t iu = 0; iu < rowVertices; ++iu)
+      {
+        __m128 pos = Combine4(column, &basis[iu * 4]);
+        __m128 du = Combine4(column, &derivative[iu * 4]);
+        __m128 dv = Combine4(columnDv, &basis[iu * 4]);
+
+        // tessTeapotTES.tese Ɠ cross(v ̐ڐ, u ̐ڐ).
+        alignas(16) float p[4], n[4];
+        _mm_store_ps(p, pos);
+        _mm_store_ps(n, Cross(dv, du));
+        auto normal = glm::vec3(n[0], n[1], n[2]);
+        float len = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+        if (len > 0.000001f)
+        {
+          normal = normal / len;
+        }
+        else
+        {
+          normal = glm::vec3(0.0f, p[1] < 0.0f ? -1.0f : 1.0f, 0.0f);
+        }
+        dstVertex->Position = glm::vec3(p[0], p[1], p[2]);
+        dstVertex->Normal = normal;
+        ++dstVertex;
+      }
+    }
+
+    // ebZ[^(ccw, ̈̌_͍)̏o͂ƓAcross(v , u ) \ɂȂŕׂ.
+    auto base = uint32_t(patch * verticesPerPatch);
+    auto* dstIndex = &mesh.indices[patch * indicesPerPatch];
+    for (uint32_t iv = 0; iv < uint32_t(level); ++iv)
+    {
+      for (uint32_t iu = 0; iu < uint32_t(level); ++iu)
+      {
+        uint32_t i00 = base + iv * rowVertices + iu;
+        uint32_t i10 = i00 + 1;
+        uint32_t i01 = i00 + rowVertices;
+        uint32_t i11 = i01 + 1;
+        *dstIndex++ = i00; *dstIndex++ = i01; *dstIndex++ = i10;
+        *dstIndex++ = i10; *dstIndex++ = i01; *dstIndex++ = i11;
+      }
+    }
+  }
+}
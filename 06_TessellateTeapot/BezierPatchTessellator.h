@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+
+// 16 _̑o 3 xWGpb` CPU ňlɕA@t̃CfbNXbV.
+// ebZ[VVF[_[gȂ̑ւƁAÓI LOD ̕`p.
+// ʂ͕(LOD)Ƃɕێčėp.
+class BezierPatchTessellator
+{
+public:
+  struct Vertex
+  {
+    glm::vec3 Position;
+    glm::vec3 Normal;
+  };
+  struct Mesh
+  {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+  };
+
+  BezierPatchTessellator();
+
+  // indices  16  1 pb`(u  4 ).
+  // threadCount  0 ̏ꍇ̓n[hEFÃXbhg.
+  void Setup(const std::vector<glm::vec3>& points, const std::vector<uint32_t>& indices, int threadCount = 0);
+
+  // 1 pb`̊eӂ level bVԂ. 쐬Ȃ쐬ăLbV.
+  const Mesh& GetMesh(int level);
+  bool IsCached(int level) const;
+  void ClearCache();
+
+  // LbVg킸ɍ쐬.
+  void Tessellate(int level, Mesh& mesh) const;
+
+  uint32_t GetPatchCount() const { return uint32_t(m_controlPoints.size() / 16); }
+
+private:
+  void TessellatePatches(int level, uint32_t firstPatch, uint32_t patchCount, Mesh& mesh) const;
+
+  std::vector<glm::vec4> m_controlPoints; // pb` 16 WJ.
+  int m_threadCount;
+
+  mutable std::mutex m_mutex;
+  std::map<int, std::unique_ptr<Mesh>> m_cache;
+};
@@ -0,0 +1,87 @@
+#include "TeapotInstanceSet.h"
+#include "FrustumPlanes.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <random>
+
+TeapotInstanceSet::TeapotInstanceSet()
+  : m_boundsCenter(0.0f), m_boundsRadius(0.0f)
+{
+}
+
+void TeapotInstanceSet::Setup(uint32_t maxCount, float spacing, const glm::vec3& boundsCenter, float boundsRadius)
+{
+  m_boundsCenter = boundsCenter;
+  m_boundsRadius = boundsRadius;
+  m_instances.clear();
+  m_instances.reserve(maxCount);
+
+  // ƕW̔{͌Œ̃V[hŌ߁A񓯂zuɂ.
+  std::mt19937 rng(12345);
+  std::uniform_real_distribution<float> yawDist(0.0f, glm::radians(360.0f));
+  std::uniform_real_distribution<float> scaleDist(0.5f, 1.0f);
+
+  for (int ring = 0; m_instances.size() < maxCount; ++ring)
+  {
+    // max(|x|,|z|) == ring ƂȂiq_ׂ.
+    int sideLength = ring * 2;
+    int cellCount = ring == 0 ? 1 : sideLength * 4;
+    for (int i = 0; i < cellCount && m_instances.size() < maxCount; ++i)
+    {
+      int x = -ring, z = -ring;
+      if (ring > 0)
+      {
+        int side = i / sideLength, offset = i % sideLength;
+        switch (side)
+        {
+        case 0: x = -ring + offset; z = -ring; break;
+        case 1: x = ring; z = -ring + offset; break;
+        case 2: x = ring - offset; z = ring; break;
+        default: x = -ring; z = ring - offset; break;
+        }
+      }
+
+      Instance instance;
+      float yaw = 0.0f, tessScale = 1.0f;
+      if (ring > 0)
+      {
+        yaw = yawDist(rng);
+        tessScale = scaleDist(rng);
+      }
+      auto position = glm::vec3(float(x), 0.0f, float(z)) * spacing;
+      instance.world = glm::rotate(glm::translate(glm::mat4(1.0f), position), yaw, glm::vec3(0.0f, 1.0f, 0.0f));
+      instance.invWorld = glm::inverse(instance.world);
+      instance.params = glm::vec4(tessScale, 0.0f, 0.0f, 0.0f);
+      m_instances.push_back(instance);
+    }
+  }
+}
+
+uint32_t TeapotInstanceSet::Cull(uint32_t count, const glm::mat4& viewProj, uint32_t* visibleIndices) const
+{
+  glm::vec4 planes[6];
+  CalcFrustumPlanes(viewProj, planes);
+
+  count = (std::min)(count, GetMaxCount());
+  uint32_t visibleCount = 0;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    // ]ƕsړ݂̂Ȃ̂ŁAE̔a͕ςȂ.
+    auto center = glm::vec3(m_instances[i].world * glm::vec4(m_boundsCenter, 1.0f));
+    bool isVisible = true;
+    for (int j = 0; j < 6 && isVisible; ++j)
+    {
+      isVisible = glm::dot(glm::vec3(planes[j]), center) + planes[j].w >= -m_boundsRadius;
+    }
+    if (isVisible)
+    {
+      visibleIndices[visibleCount++] = i;
+    }
+  }
+  return visibleCount;
+}
+
+void TeapotInstanceSet::CalcFrustumPlanes(const glm::mat4& viewProj, glm::vec4 planes[6])
+{
+  FrustumPlanes::Calc(viewProj, planes);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+// ̃eB[|bgCX^X`悷邽߂̔zuƁAɂCX^XJO.
+// zu͌_O֐`̗֏ɕׂ邽߁A擪牽gĂ_t߂ɂ܂Ƃ܂.
+class TeapotInstanceSet
+{
+public:
+  // VF[_[̃Xg[Wobt@(std430)Ɠ.
+  struct Instance
+  {
+    glm::mat4 world;
+    glm::mat4 invWorld; // pb`̗ʔŎ_fԂֈڂ̂Ɏg.
+    glm::vec4 params; // x: W̔{.
+  };
+
+  TeapotInstanceSet();
+
+  // 擪̃CX^X͌_ɉ]ȂŒuAW̔{ 1 Ƃ.
+  void Setup(uint32_t maxCount, float spacing, const glm::vec3& boundsCenter, float boundsRadius);
+
+  const std::vector<Instance>& GetInstances() const { return m_instances; }
+  uint32_t GetMaxCount() const { return uint32_t(m_instances.size()); }
+
+  // 擪 count ̂AƌCX^X̔ԍ visibleIndices ɏoČԂ.
+  uint32_t Cull(uint32_t count, const glm::mat4& viewProj, uint32_t* visibleIndices) const;
+
+  static void CalcFrustumPlanes(const glm::mat4& viewProj, glm::vec4 planes[6]);
+
+private:
+  std::vector<Instance> m_instances;
+  glm::vec3 m_boundsCenter; // fԂł̋E.
+  float m_boundsRadius;
+};
@@ -3,6 +3,7 @@
 #include <sstream>
 #include <iomanip>
 #include <Windows.h>
+#include <cmath>
 
 using namespace TeapotPatch;
 
@@ -20,4 +21,232 @@ std::vector<unsigned int> TeapotPatch::GetTeapotPatchIndices()
   return indices;
 }
 
+float TeapotPatch::CalcCurveTessFactor(const vec3& p0, const vec3& p1, const vec3& p2, const vec3& p3, const AdaptiveTessParams& params)
+{
+  const float MaxTessFactor = 64.0f;
+  vec3 center = (p0 + p3) * 0.5f;
+  float depth = (std::max)(-center.z, 0.1f);
+  float pixelsPerUnit = params.projScaleY * params.screenHeight * 0.5f / depth;
+
+  float len = (glm::distance(p0, p1) + glm::distance(p2, p3)) + glm::distance(p1, p2);
+  float lengthFactor = len * pixelsPerUnit / params.targetEdgePixels;
+
+  vec3 d0 = (p0 + p2) - 2.0f * p1;
+  vec3 d1 = (p1 + p3) - 2.0f * p2;
+  float m = (std::max)(glm::length(d0), glm::length(d1)) * pixelsPerUnit;
+  float curvatureFactor = std::sqrt(0.75f * m / params.curvatureTolerance);
+
+  return (std::min)((std::max)((std::max)(lengthFactor, curvatureFactor), 1.0f), MaxTessFactor);
+}
+
+void TeapotPatch::CalcAdaptiveTessLevels(const vec3 p[16], const AdaptiveTessParams& params, float outer[4], float inner[2])
+{
+  outer[0] = CalcCurveTessFactor(p[0], p[4], p[8], p[12], params);
+  outer[1] = CalcCurveTessFactor(p[0], p[1], p[2], p[3], params);
+  outer[2] = CalcCurveTessFactor(p[3], p[7], p[11], p[15], params);
+  outer[3] = CalcCurveTessFactor(p[12], p[13], p[14], p[15], params);
+
+  float innerU = (std::max)(outer[1], outer[3]);
+  float innerV = (std::max)(outer[0], outer[2]);
+  for (int i = 1; i < 3; ++i)
+  {
+    innerU = (std::max)(innerU, CalcCurveTessFactor(p[i * 4 + 0], p[i * 4 + 1], p[i * 4 + 2], p[i * 4 + 3], params));
+    innerV = (std::max)(innerV, CalcCurveTessFactor(p[i], p[i + 4], p[i + 8], p[i + 12], params));
+  }
+  inner[0] = innerU;
+  inner[1] = innerV;
+}
+
+namespace
+{
+  const float Pi = 3.14159265f;
+
+  // xNgQ܂މ~(, p)߂.  0 ̃xNg͌Ȃߏ.
+  bool CalcVectorCone(const vec3* vectors, int count, vec3& axis, float& angle)
+  {
+    std::vector<vec3> dirs;
+    vec3 sum(0.0f);
+    for (int i = 0; i < count; ++i)
+    {
+      float len = glm::length(vectors[i]);
+      if (len > 1.0e-6f)
+      {
+        dirs.push_back(vectors[i] / len);
+        sum = sum + dirs.back();
+      }
+    }
+    float sumLength = glm::length(sum);
+    if (sumLength < 1.0e-6f)
+    {
+      return false;
+    }
 
+    // ϕn߂āAłꂽxNg֎񂹂(ŏ܉~̋ߎ).
+    // ǂ̎ł̎łꂽxNg܂ł̊px͐pȂ̂ŁAł̂g.
+    const int Iterations = 200;
+    vec3 candidate = sum / sumLength;
+    float bestCos = -2.0f;
+    for (int k = 0; k < Iterations; ++k)
+    {
+      float minCos = 1.0f;
+      vec3 farthest = candidate;
+      for (const auto& d : dirs)
+      {
+        float c = glm::dot(candidate, d);
+        if (c < minCos)
+        {
+          minCos = c;
+          farthest = d;
+        }
+      }
+      if (minCos > bestCos)
+      {
+        bestCos = minCos;
+        axis = candidate;
+      }
+      vec3 next = candidate + (farthest - candidate) / float(k + 2);
+      if (glm::length(next) < 1.0e-6f)
+      {
+        break;
+      }
+      candidate = glm::normalize(next);
+    }
+    angle = std::acos((std::max)(bestCos, -1.0f));
+    return angle < Pi * 0.5f;
+  }
+
+  // 5 ̃xWGȐ̌WA [t0, t1] ̌̕W de Casteljau @ŋ߂.
+  void ExtractSegment(const vec3 src[6], float t0, float t1, vec3 dst[6])
+  {
+    // t1 ŕO߂.
+    vec3 work[6];
+    vec3 head[6];
+    std::copy(src, src + 6, work);
+    for (int r = 0; r < 6; ++r)
+    {
+      head[r] = work[0];
+      for (int j = 0; j < 5 - r; ++j)
+      {
+        work[j] = glm::mix(work[j], work[j + 1], t1);
+      }
+    }
+    // O t0 / t1 ŕ㔼߂.
+    float s = t1 > 0.0f ? t0 / t1 : 0.0f;
+    for (int r = 0; r < 6; ++r)
+    {
+      dst[5 - r] = head[5 - r];
+      for (int j = 0; j < 5 - r; ++j)
+      {
+        head[j] = glm::mix(head[j], head[j + 1], s);
+      }
+    }
+  }
+}
+
+std::vector<PatchCone> TeapotPatch::CalcPatchCones(const std::vector<vec3>& points, const std::vector<unsigned int>& indices)
+{
+  std::vector<PatchCone> cones;
+  for (size_t patch = 0; patch + 16 <= indices.size(); patch += 16)
+  {
+    vec3 cp[16];
+    for (int j = 0; j < 16; ++j)
+    {
+      cp[j] = points[indices[patch + j]];
+    }
+
+    // @ cross(Pv, Pu)  (5,5) ̃xWGȖʂɂȂ邽߁A 36 ̌WxNg̉~Ɏ܂.
+    // ( tessTeapotTES.tese ̖@Ɠ.)
+    static const float Binom2[3] = { 1.0f, 2.0f, 1.0f };
+    static const float Binom3[4] = { 1.0f, 3.0f, 3.0f, 1.0f };
+    static const float Binom5[6] = { 1.0f, 5.0f, 10.0f, 10.0f, 5.0f, 1.0f };
+    vec3 normals[36];
+    for (auto& n : normals)
+    {
+      n = vec3(0.0f);
+    }
+    for (int j = 0; j < 4; ++j)
+    {
+      for (int i = 0; i < 3; ++i)
+      {
+        // Pu ̌W(u: 2 , v: 3 ).
+        vec3 a = (cp[j * 4 + i + 1] - cp[j * 4 + i]) * 3.0f;
+        for (int l = 0; l < 3; ++l)
+        {
+          for (int k = 0; k < 4; ++k)
+          {
+            // Pv ̌W(u: 3 , v: 2 ).
+            vec3 b = (cp[(l + 1) * 4 + k] - cp[l * 4 + k]) * 3.0f;
+            int nu = i + k, nv = j + l;
+            float w = (Binom2[i] * Binom3[k] / Binom5[nu]) * (Binom3[j] * Binom2[l] / Binom5[nv]);
+            normals[nv * 6 + nu] += glm::cross(b, a) * w;
+          }
+        }
+      }
+    }
+
+    // W̉~̓pb`Ŝł͊ɂ邽߁ASubdivisionCount x SubdivisionCount ɕ
+    // pb`̌WW߂ĉ~߂. قǎۂ̖@̍Lɋ߂Â.
+    const int SubdivisionCount = 4;
+    std::vector<vec3> subNormals;
+    subNormals.reserve(SubdivisionCount * SubdivisionCount * 36);
+    for (int su = 0; su < SubdivisionCount; ++su)
+    {
+      float u0 = float(su) / SubdivisionCount, u1 = float(su + 1) / SubdivisionCount;
+      // u ɐ؂o.
+      vec3 rows[36];
+      for (int nv = 0; nv < 6; ++nv)
+      {
+        ExtractSegment(&normals[nv * 6], u0, u1, &rows[nv * 6]);
+      }
+      for (int sv = 0; sv < SubdivisionCount; ++sv)
+      {
+        float v0 = float(sv) / SubdivisionCount, v1 = float(sv + 1) / SubdivisionCount;
+        // v ɐ؂o.
+        for (int nu = 0; nu < 6; ++nu)
+        {
+          vec3 column[6], sub[6];
+          for (int nv = 0; nv < 6; ++nv)
+          {
+            column[nv] = rows[nv * 6 + nu];
+          }
+          ExtractSegment(column, v0, v1, sub);
+          subNormals.insert(subNormals.end(), sub, sub + 6);
+        }
+      }
+    }
+
+    PatchCone cone;
+    cone.axisAngle = glm::vec4(0.0f, 1.0f, 0.0f, Pi);
+    vec3 axis;
+    float angle;
+    if (CalcVectorCone(subNormals.data(), int(subNormals.size()), axis, angle))
+    {
+      cone.axisAngle = glm::vec4(axis, angle);
+    }
+    cones.push_back(cone);
+  }
+  return cones;
+}
+
+bool TeapotPatch::IsBackfacing(const PatchCone& cone, const vec3 controlPoints[16], const vec3& eye)
+{
+  // ~̂ǂ̖@Apb`(_̓ʕ)̂ǂ̓_ł_̔ΑĂΗ.
+  // _̕ (90x - p) ̊pxȂ͓̈ʂȂ̂ŁA_ׂ΂悢.
+  float angle = cone.axisAngle.w;
+  if (angle >= Pi * 0.5f)
+  {
+    return false;
+  }
+  float sinAngle = std::sin(angle);
+  auto axis = vec3(cone.axisAngle);
+  for (int i = 0; i < 16; ++i)
+  {
+    auto toPoint = controlPoints[i] - eye;
+    float d = glm::length(toPoint);
+    if (d < 1.0e-6f || glm::dot(axis, toPoint) <= sinAngle * d)
+    {
+      return false;
+    }
+  }
+  return true;
+}
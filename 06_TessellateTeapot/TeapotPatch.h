@@ -13,4 +13,27 @@ namespace TeapotPatch
 
   std::vector<vec3> GetTeapotPatchPoints();
   std::vector<unsigned int> GetTeapotPatchIndices();
+
+  // tessTeapotTCS.tesc ̓KIȕW̌vZ(CPU ).
+  struct AdaptiveTessParams
+  {
+    float projScaleY; // ˉes [1][1] vf.
+    float screenHeight;
+    float targetEdgePixels;
+    float curvatureTolerance;
+  };
+  // _̓r[Ԃ̍W. tɗ^ĂlɂȂ.
+  float CalcCurveTessFactor(const vec3& p0, const vec3& p1, const vec3& p2, const vec3& p3, const AdaptiveTessParams& params);
+  void CalcAdaptiveTessLevels(const vec3 viewPos[16], const AdaptiveTessParams& params, float outer[4], float inner[2]);
+
+  // pb`̖@(\)܂~.
+  // tessTeapotTCS.tesc Ńpb`Ŝǂ̔Ɏg.
+  struct PatchCone
+  {
+    glm::vec4 axisAngle; // xyz: , w: p(WA). ߂Ȃꍇ .
+  };
+  std::vector<PatchCone> CalcPatchCones(const std::vector<vec3>& points, const std::vector<unsigned int>& indices);
+
+  // controlPoints ̓pb` 16 _, eye ͓Wnł̎_.
+  bool IsBackfacing(const PatchCone& cone, const vec3 controlPoints[16], const vec3& eye);
 }
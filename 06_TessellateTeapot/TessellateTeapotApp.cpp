@@ -1,8 +1,10 @@
 #include "TessellateTeapotApp.h"
-#include "TeapotModel.h"
 #include "VulkanBookUtil.h"
 
 #include <array>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "imgui.h"
@@ -12,10 +14,20 @@
 #include "stb_image.h"
 
 #include "TeapotPatch.h"
+#include "QuadDomainTessellator.h"
 
 
 using namespace std;
 
+namespace
+{
+  // CX^XςȂ`掞Ԃvۂ̐ݒ.
+  const int SweepInstanceCounts[] = { 1, 16, 64, 256, 1024, 4096, 16384 };
+  const int SweepWarmupFrames = 30;
+  const int SweepMeasureFrames = 120;
+  const char* SweepResultFile = "teapot_instance_sweep.csv";
+}
+
 TessellateTeapotApp::TessellateTeapotApp()
 {
   m_camera.SetLookAt(
@@ -23,6 +35,24 @@ TessellateTeapotApp::TessellateTeapotApp()
     glm::vec3(0.0f, 0.0f, 0.0f)
   );
   m_tessFactor = 1.0f;
+  m_tessMode = TessMode_Adaptive;
+  m_targetEdgePixels = 16.0f;
+  m_curvatureTolerance = 0.5f;
+  m_isTessellationSupported = false;
+  m_cpuTeapotPipeline = VK_NULL_HANDLE;
+  m_lastCpuTessMilliseconds = 0.0;
+  m_isBackfaceCulling = true;
+  m_culledPatchCount = 0;
+  m_instanceCount = 1;
+  m_visibleInstanceCount = 0;
+  m_lastCullMilliseconds = 0.0;
+  m_isTimestampSupported = false;
+  m_timestampPool = VK_NULL_HANDLE;
+  m_timestampPeriod = 1.0;
+  m_lastGpuMilliseconds = 0.0;
+  m_isSweeping = false;
+  m_sweepStep = 0;
+  m_sweepFrame = 0;
 }
 
 void TessellateTeapotApp::Prepare()
@@ -48,6 +78,30 @@ void TessellateTeapotApp::Prepare()
     c.commandBuffer = CreateCommandBuffer(false); // R}hobt@JnԂɂȂ.
   }
 
+  VkPhysicalDeviceFeatures features{};
+  vkGetPhysicalDeviceFeatures(m_physicalDevice, &features);
+  m_isTessellationSupported = features.tessellationShader == VK_TRUE;
+  if (!m_isTessellationSupported)
+  {
+    m_tessMode = TessMode_Cpu;
+  }
+
+  // eB[|bg̕`掞Ԃv^CX^v(C[WƂɊJn/I 2 ).
+  VkPhysicalDeviceProperties physProps;
+  vkGetPhysicalDeviceProperties(m_physicalDevice, &physProps);
+  m_isTimestampSupported = physProps.limits.timestampComputeAndGraphics == VK_TRUE;
+  m_timestampPeriod = physProps.limits.timestampPeriod;
+  m_hasTimestamps.assign(imageCount, false);
+  if (m_isTimestampSupported)
+  {
+    VkQueryPoolCreateInfo queryPoolCI{
+      VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO, nullptr, 0,
+      VK_QUERY_TYPE_TIMESTAMP, imageCount * 2, 0
+    };
+    auto result = vkCreateQueryPool(m_device, &queryPoolCI, nullptr, &m_timestampPool);
+    ThrowIfFailed(result, "vkCreateQueryPool failed.");
+  }
+
   PrepareSceneResource();
 
   PrepareTessTeapot();
@@ -57,8 +111,22 @@ void TessellateTeapotApp::Cleanup()
 {
   DestroyBuffer(m_tessTeapot.resVertexBuffer);
   DestroyBuffer(m_tessTeapot.resIndexBuffer);
+  DestroyBuffer(m_patchConeBuffer);
+  DestroyBuffer(m_instanceBuffer);
+  for (auto& buffer : m_visibleInstanceBuffers)
+  {
+    DestroyBuffer(buffer);
+  }
+  vkDestroyQueryPool(m_device, m_timestampPool, nullptr);
 
   vkDestroyPipeline(m_device, m_tessTeapotPipeline, nullptr);
+  vkDestroyPipeline(m_device, m_cpuTeapotPipeline, nullptr);
+  for (auto& model : m_cpuTeapotModels)
+  {
+    DestroyBuffer(model.second.resVertexBuffer);
+    DestroyBuffer(model.second.resIndexBuffer);
+  }
+  m_cpuTeapotModels.clear();
   for (auto& ubo : m_tessTeapotUniform)
   {
     DestroyBuffer(ubo);
@@ -136,14 +204,19 @@ void TessellateTeapotApp::CreateSampleLayouts()
   ThrowIfFailed(result, "vkCreateDescriptorSetLayout Failed.");
   RegisterLayout("u2", dsLayout);
 
+  // 0: uniformBuffer, 1: storageBuffer(pb`̖@R[),
+  // 2: storageBuffer(CX^X), 3: storageBuffer(\CX^Xԍ) gpVF[_[pCAEg.
   dsLayoutBindings = {
     { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_ALL, },
+    { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT },
+    { 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT | VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT },
+    { 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT },
   };
   dsLayoutCI.bindingCount = uint32_t(dsLayoutBindings.size());
   dsLayoutCI.pBindings = dsLayoutBindings.data();
   result = vkCreateDescriptorSetLayout(m_device, &dsLayoutCI, nullptr, &dsLayout);
   ThrowIfFailed(result, "vkCreateDescriptorSetLayout Failed.");
-  RegisterLayout("u1", dsLayout);
+  RegisterLayout("u1s3", dsLayout);
 
   // pCvCCAEg̏
   VkPipelineLayoutCreateInfo layoutCI{
@@ -168,12 +241,12 @@ void TessellateTeapotApp::CreateSampleLayouts()
   ThrowIfFailed(result, "vkCreatePipelineLayout Failed.");
   RegisterLayout("u2", layout);
 
-  dsLayout = GetDescriptorSetLayout("u1");
+  dsLayout = GetDescriptorSetLayout("u1s3");
   layoutCI.setLayoutCount = 1;
   layoutCI.pSetLayouts = &dsLayout;
   result = vkCreatePipelineLayout(m_device, &layoutCI, nullptr, &layout);
   ThrowIfFailed(result, "vkCreatePipelineLayout Failed.");
-  RegisterLayout("u1", layout);
+  RegisterLayout("u1s3", layout);
 }
 
 void TessellateTeapotApp::Render()
@@ -229,15 +302,35 @@ void TessellateTeapotApp::Render()
     tessParams.cameraPos = glm::vec4(m_camera.GetPosition(), 0.0f);
     tessParams.tessOuterLevel = m_tessFactor;
     tessParams.tessInnerLevel = m_tessFactor;
+    tessParams.tessMode = float(m_tessMode);
+    tessParams.targetEdgePixels = m_targetEdgePixels;
+    tessParams.curvatureTolerance = m_curvatureTolerance;
+    tessParams.screenHeight = float(extent.height);
+    tessParams.backfaceCulling = m_isBackfaceCulling ? 1.0f : 0.0f;
     WriteToHostVisibleMemory(m_tessTeapotUniform[imageIndex].memory, sizeof(tessParams), &tessParams);
   }
 
   auto fence = m_commandBuffers[imageIndex].fence;
   vkWaitForFences(m_device, 1, &fence, VK_TRUE, UINT64_MAX);
+  ReadTeapotTimestamps(imageIndex);
+  UpdateInstanceSweep();
+  UpdateVisibleInstances(imageIndex);
+
+  // 쐬̕ł΁AR}h̋L^Oɍ쐬ē]Ă.
+  const ModelData* cpuTeapot = nullptr;
+  if (m_tessMode == TessMode_Cpu)
+  {
+    cpuTeapot = &GetCpuTeapotModel(int(m_tessFactor + 0.5f));
+  }
+  UpdatePatchCulling();
 
   auto command = m_commandBuffers[imageIndex].commandBuffer;
 
   vkBeginCommandBuffer(command, &commandBI);
+  if (m_isTimestampSupported)
+  {
+    vkCmdResetQueryPool(command, m_timestampPool, imageIndex * 2, 2);
+  }
 
   vkCmdBeginRenderPass(command, &rpBI, VK_SUBPASS_CONTENTS_INLINE);
   auto extent = m_swapchain->GetSurfaceExtent();
@@ -251,12 +344,55 @@ void TessellateTeapotApp::Render()
   vkCmdSetScissor(command, 0, 1, &scissor);
   vkCmdSetViewport(command, 0, 1, &viewport);
  
-  auto pipelineLayout = GetPipelineLayout("u1");
-  vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, m_tessTeapotPipeline);
-  vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &m_dsTeapot[imageIndex], 0, nullptr);
-  vkCmdBindIndexBuffer(command, m_tessTeapot.resIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
-  vkCmdBindVertexBuffers(command, 0, 1, &m_tessTeapot.resVertexBuffer.buffer, offsets);
-  vkCmdDrawIndexed(command, m_tessTeapot.indexCount, 1, 0, 0, 0);
+  auto pipelineLayout = GetPipelineLayout("u1s3");
+  if (m_isTimestampSupported)
+  {
+    vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timestampPool, imageIndex * 2);
+  }
+  if (m_visibleInstanceCount == 0)
+  {
+    // SCX^X̊O.
+  }
+  else if (cpuTeapot != nullptr)
+  {
+    vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, m_cpuTeapotPipeline);
+    vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &m_dsTeapot[imageIndex], 0, nullptr);
+    vkCmdBindIndexBuffer(command, cpuTeapot->resIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdBindVertexBuffers(command, 0, 1, &cpuTeapot->resVertexBuffer.buffer, offsets);
+
+    // bV̓pb`ɕł邽߁AłȂpb`̘A͈͂Ƃɕ`悷.
+    auto patchCount = uint32_t(m_isPatchCulled.size());
+    auto indicesPerPatch = cpuTeapot->indexCount / patchCount;
+    uint32_t first = 0;
+    while (first < patchCount)
+    {
+      if (m_isPatchCulled[first])
+      {
+        ++first;
+        continue;
+      }
+      auto last = first;
+      while (last < patchCount && !m_isPatchCulled[last])
+      {
+        ++last;
+      }
+      vkCmdDrawIndexed(command, (last - first) * indicesPerPatch, m_visibleInstanceCount, first * indicesPerPatch, 0, 0);
+      first = last;
+    }
+  }
+  else
+  {
+    vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, m_tessTeapotPipeline);
+    vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &m_dsTeapot[imageIndex], 0, nullptr);
+    vkCmdBindIndexBuffer(command, m_tessTeapot.resIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdBindVertexBuffers(command, 0, 1, &m_tessTeapot.resVertexBuffer.buffer, offsets);
+    vkCmdDrawIndexed(command, m_tessTeapot.indexCount, m_visibleInstanceCount, 0, 0, 0);
+  }
+  if (m_isTimestampSupported)
+  {
+    vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timestampPool, imageIndex * 2 + 1);
+    m_hasTimestamps[imageIndex] = true;
+  }
 
   RenderHUD(command);
   vkCmdEndRenderPass(command);
@@ -325,6 +461,48 @@ void TessellateTeapotApp::PrepareTessTeapot()
   auto teapotPoints = TeapotPatch::GetTeapotPatchPoints();
   auto teapotIndices = TeapotPatch::GetTeapotPatchIndices();
   m_tessTeapot = CreateSimpleModel(teapotPoints, teapotIndices);
+  m_teapotPoints = teapotPoints;
+  m_teapotIndices.assign(teapotIndices.begin(), teapotIndices.end());
+  m_cpuTessellator.Setup(m_teapotPoints, m_teapotIndices);
+
+  // pb`̖@R[߂ TCS QƂł悤]Ă.
+  m_patchCones = TeapotPatch::CalcPatchCones(teapotPoints, teapotIndices);
+  m_isPatchCulled.assign(m_patchCones.size(), false);
+  auto coneBufferSize = uint32_t(sizeof(TeapotPatch::PatchCone) * m_patchCones.size());
+  m_patchConeBuffer = CreateBuffer(
+    coneBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  WriteToHostVisibleMemory(m_patchConeBuffer.memory, coneBufferSize, m_patchCones.data());
+
+  // CX^X̔zu. E͐_(ʕpb`܂)狁߂.
+  auto boundsMin = teapotPoints[0], boundsMax = teapotPoints[0];
+  for (const auto& p : teapotPoints)
+  {
+    boundsMin = glm::min(boundsMin, p);
+    boundsMax = glm::max(boundsMax, p);
+  }
+  auto boundsCenter = (boundsMin + boundsMax) * 0.5f;
+  float boundsRadius = 0.0f;
+  for (const auto& p : teapotPoints)
+  {
+    boundsRadius = (std::max)(boundsRadius, glm::distance(boundsCenter, p));
+  }
+  m_instanceSet.Setup(MaxInstances, 3.0f, boundsCenter, boundsRadius);
+  auto instanceBufferSize = uint32_t(sizeof(TeapotInstanceSet::Instance) * MaxInstances);
+  m_instanceBuffer = CreateBuffer(
+    instanceBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  WriteToHostVisibleMemory(m_instanceBuffer.memory, instanceBufferSize, m_instanceSet.GetInstances().data());
+
+  // \CX^Xԍ͖t[邽߁AC[WƂɗpӂ.
+  m_visibleInstances.resize(MaxInstances);
+  m_visibleInstanceBuffers.resize(m_swapchain->GetImageCount());
+  for (auto& buffer : m_visibleInstanceBuffers)
+  {
+    buffer = CreateBuffer(
+      uint32_t(sizeof(uint32_t) * MaxInstances), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  }
 
   auto stride = uint32_t(sizeof(TeapotPatch::ControlPoint));
   VkVertexInputBindingDescription vibDesc{
@@ -410,13 +588,6 @@ void TessellateTeapotApp::PrepareTessTeapot()
 
   VkResult result;
 
-  // Cւ̕`p.
-  shaderStages = {
-    book_util::LoadShader(m_device, "tessTeapotVS.spv", VK_SHADER_STAGE_VERTEX_BIT),
-    book_util::LoadShader(m_device, "tessTeapotTCS.spv", VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT),
-    book_util::LoadShader(m_device, "tessTeapotTES.spv", VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT),
-    book_util::LoadShader(m_device, "tessTeapotFS.spv", VK_SHADER_STAGE_FRAGMENT_BIT),
-  };
   viewportStateCI.scissorCount = 1;
   viewportStateCI.pScissors = &scissorBackbuffer;
   viewportStateCI.viewportCount = 1;
@@ -425,14 +596,51 @@ void TessellateTeapotApp::PrepareTessTeapot()
   pipelineCI.pViewportState = &viewportStateCI;
   pipelineCI.pDynamicState = &pipelineDynamicStateCI;
   pipelineCI.renderPass = GetRenderPass("default");
-  pipelineCI.layout = GetPipelineLayout("u1");
-  pipelineCI.pTessellationState = &tessStateCI;
+  pipelineCI.layout = GetPipelineLayout("u1s3");
+  if (m_isTessellationSupported)
+  {
+    // Cւ̕`p.
+    // ebZ[VVF[_[̃W[͋@\ȂfoCXł͍쐬łȂ߁Ałǂݍ.
+    shaderStages = {
+      book_util::LoadShader(m_device, "tessTeapotVS.spv", VK_SHADER_STAGE_VERTEX_BIT),
+      book_util::LoadShader(m_device, "tessTeapotTCS.spv", VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT),
+      book_util::LoadShader(m_device, "tessTeapotTES.spv", VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT),
+      book_util::LoadShader(m_device, "tessTeapotFS.spv", VK_SHADER_STAGE_FRAGMENT_BIT),
+    };
+    pipelineCI.pTessellationState = &tessStateCI;
+    pipelineCI.pStages = shaderStages.data();
+    pipelineCI.stageCount = uint32_t(shaderStages.size());
+    result = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &m_tessTeapotPipeline);
+    ThrowIfFailed(result, "vkCreateGraphicsPipeline failed.");
+    book_util::DestroyShaderModules(m_device, shaderStages);
+  }
+  else
+  {
+    m_tessTeapotPipeline = VK_NULL_HANDLE;
+  }
+
+  // CPU ŕbV̕`p.
+  vibDesc.stride = uint32_t(sizeof(BezierPatchTessellator::Vertex));
+  array<VkVertexInputAttributeDescription, 2> meshAttribs{
+  {
+    { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(BezierPatchTessellator::Vertex, Position) },
+    { 1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(BezierPatchTessellator::Vertex, Normal) },
+  }
+  };
+  pipelineVisCI.vertexAttributeDescriptionCount = uint32_t(meshAttribs.size());
+  pipelineVisCI.pVertexAttributeDescriptions = meshAttribs.data();
+  inputAssemblyCI.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+  shaderStages = {
+    book_util::LoadShader(m_device, "teapotMeshVS.spv", VK_SHADER_STAGE_VERTEX_BIT),
+    book_util::LoadShader(m_device, "tessTeapotFS.spv", VK_SHADER_STAGE_FRAGMENT_BIT),
+  };
+  pipelineCI.pTessellationState = nullptr;
   pipelineCI.pStages = shaderStages.data();
   pipelineCI.stageCount = uint32_t(shaderStages.size());
-  result = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &m_tessTeapotPipeline);
+  result = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &m_cpuTeapotPipeline);
   ThrowIfFailed(result, "vkCreateGraphicsPipeline failed.");
 
-  auto dsLayout = GetDescriptorSetLayout("u1");
+  auto dsLayout = GetDescriptorSetLayout("u1s3");
   VkDescriptorSetAllocateInfo dsAI{
     VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, nullptr,
     m_descriptorPool,
@@ -454,15 +662,146 @@ void TessellateTeapotApp::PrepareTessTeapot()
       m_tessTeapotUniform[i].buffer,
       0, VK_WHOLE_SIZE
     };
-    VkWriteDescriptorSet writeDS = book_util::CreateWriteDescriptorSet(
-      m_dsTeapot[i], 0, &bufferInfo
-    );
-    vkUpdateDescriptorSets(m_device, 1, &writeDS, 0, nullptr);
+    VkDescriptorBufferInfo coneBufferInfo{
+      m_patchConeBuffer.buffer,
+      0, VK_WHOLE_SIZE
+    };
+    VkDescriptorBufferInfo instanceBufferInfo{
+      m_instanceBuffer.buffer,
+      0, VK_WHOLE_SIZE
+    };
+    VkDescriptorBufferInfo visibleBufferInfo{
+      m_visibleInstanceBuffers[i].buffer,
+      0, VK_WHOLE_SIZE
+    };
+    VkWriteDescriptorSet writeDS[] = {
+      book_util::CreateWriteDescriptorSet(m_dsTeapot[i], 0, &bufferInfo),
+      book_util::CreateWriteDescriptorSet(m_dsTeapot[i], 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &coneBufferInfo),
+      book_util::CreateWriteDescriptorSet(m_dsTeapot[i], 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &instanceBufferInfo),
+      book_util::CreateWriteDescriptorSet(m_dsTeapot[i], 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &visibleBufferInfo),
+    };
+    vkUpdateDescriptorSets(m_device, _countof(writeDS), writeDS, 0, nullptr);
   }
 
   book_util::DestroyShaderModules(m_device, shaderStages);
 }
 
+const ModelData& TessellateTeapotApp::GetCpuTeapotModel(int level)
+{
+  level = (std::max)(level, 1);
+  auto it = m_cpuTeapotModels.find(level);
+  if (it == m_cpuTeapotModels.end())
+  {
+    auto start = chrono::high_resolution_clock::now();
+    const auto& mesh = m_cpuTessellator.GetMesh(level);
+    m_lastCpuTessMilliseconds = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+    it = m_cpuTeapotModels.emplace(level, CreateSimpleModel(mesh.vertices, mesh.indices)).first;
+  }
+  return it->second;
+}
+
+void TessellateTeapotApp::UpdatePatchCulling()
+{
+  // [hsƐ擪CX^X̕ϊ͒PʍsȂ̂ŁAJʒû܂܃fԂ̎_Ƃ.
+  // CX^Xł CPU ŕbV̕`͈͂L邽߁Ał͉Ȃ.
+  auto eye = m_camera.GetPosition();
+  m_culledPatchCount = 0;
+  for (size_t i = 0; i < m_patchCones.size(); ++i)
+  {
+    if (m_instanceCount > 1)
+    {
+      m_isPatchCulled[i] = false;
+      continue;
+    }
+    glm::vec3 controlPoints[16];
+    for (int j = 0; j < 16; ++j)
+    {
+      controlPoints[j] = m_teapotPoints[m_teapotIndices[i * 16 + j]];
+    }
+    m_isPatchCulled[i] = m_isBackfaceCulling && TeapotPatch::IsBackfacing(m_patchCones[i], controlPoints, eye);
+    if (m_isPatchCulled[i])
+    {
+      m_culledPatchCount++;
+    }
+  }
+}
+
+void TessellateTeapotApp::UpdateVisibleInstances(uint32_t imageIndex)
+{
+  // [hs͒PʍsȂ̂ŁACX^X̕ϊ݂̂Ŕ肷.
+  auto start = chrono::high_resolution_clock::now();
+  auto viewProj = m_projection * m_camera.GetViewMatrix();
+  m_visibleInstanceCount = m_instanceSet.Cull(uint32_t(m_instanceCount), viewProj, m_visibleInstances.data());
+  m_lastCullMilliseconds = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+
+  if (m_visibleInstanceCount > 0)
+  {
+    WriteToHostVisibleMemory(
+      m_visibleInstanceBuffers[imageIndex].memory,
+      uint32_t(sizeof(uint32_t) * m_visibleInstanceCount), m_visibleInstances.data());
+  }
+}
+
+void TessellateTeapotApp::ReadTeapotTimestamps(uint32_t imageIndex)
+{
+  if (!m_isTimestampSupported || !m_hasTimestamps[imageIndex])
+  {
+    return;
+  }
+  // tFX҂Ȃ̂Ōʂ͎擾ł.
+  uint64_t timestamps[2];
+  auto result = vkGetQueryPoolResults(
+    m_device, m_timestampPool, imageIndex * 2, 2,
+    sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+  if (result == VK_SUCCESS)
+  {
+    m_lastGpuMilliseconds = double(timestamps[1] - timestamps[0]) * m_timestampPeriod * 1.0e-6;
+  }
+}
+
+void TessellateTeapotApp::UpdateInstanceSweep()
+{
+  if (!m_isSweeping)
+  {
+    return;
+  }
+  // ^CX^v͐t[Ô̂ǂ܂邽߁A؂ւ͏WvȂ.
+  if (m_sweepFrame >= SweepWarmupFrames)
+  {
+    m_sweepAccum.visibleInstances = m_visibleInstanceCount;
+    m_sweepAccum.gpuMilliseconds += m_lastGpuMilliseconds;
+    m_sweepAccum.frameMilliseconds += ImGui::GetIO().DeltaTime * 1000.0;
+  }
+  if (++m_sweepFrame < SweepWarmupFrames + SweepMeasureFrames)
+  {
+    return;
+  }
+
+  m_sweepAccum.gpuMilliseconds /= SweepMeasureFrames;
+  m_sweepAccum.frameMilliseconds /= SweepMeasureFrames;
+  m_sweepResults.push_back(m_sweepAccum);
+
+  if (++m_sweepStep < int(_countof(SweepInstanceCounts)))
+  {
+    m_instanceCount = SweepInstanceCounts[m_sweepStep];
+    m_sweepFrame = 0;
+    m_sweepAccum = InstanceSweepResult{ m_instanceCount, 0, 0.0, 0.0 };
+    return;
+  }
+
+  m_isSweeping = false;
+  std::ofstream outfile(SweepResultFile);
+  outfile << "instances,visible,patches,gpu_ms,frame_ms,patches_per_sec\n";
+  auto patchesPerInstance = uint64_t(m_patchCones.size());
+  for (const auto& r : m_sweepResults)
+  {
+    auto patches = r.visibleInstances * patchesPerInstance;
+    auto patchesPerSec = r.gpuMilliseconds > 0.0 ? double(patches) / (r.gpuMilliseconds * 1.0e-3) : 0.0;
+    outfile << r.instances << ',' << r.visibleInstances << ',' << patches << ','
+      << r.gpuMilliseconds << ',' << r.frameMilliseconds << ',' << patchesPerSec << '\n';
+  }
+}
+
 void TessellateTeapotApp::RenderHUD(VkCommandBuffer command)
 {
   // ImGui
@@ -474,7 +813,100 @@ void TessellateTeapotApp::RenderHUD(VkCommandBuffer command)
   ImGui::Begin("Information");
   ImGui::Text("Framerate: %.1f FPS", ImGui::GetIO().Framerate);
   //ImGui::Combo("Mode", (int*)&m_mode, "Static\0MultiPass\0SinglePass\0\0");
+  if (m_isTessellationSupported)
+  {
+    ImGui::Combo("TessMode", &m_tessMode, "Uniform\0Adaptive\0CPU\0\0");
+  }
+  else
+  {
+    ImGui::Text("TessMode: CPU (tessellationShader not supported)");
+  }
   ImGui::SliderFloat("TessFactor", &m_tessFactor, 1.0f, 32.0f, "%.1f");
+  ImGui::Checkbox("BackfaceCulling", &m_isBackfaceCulling);
+  if (m_isSweeping)
+  {
+    ImGui::Text("Instances: %d (Sweep %d/%d)", m_instanceCount, m_sweepStep + 1, int(_countof(SweepInstanceCounts)));
+  }
+  else
+  {
+    ImGui::SliderInt("Instances", &m_instanceCount, 1, int(MaxInstances));
+    if (m_isTimestampSupported && ImGui::Button("Sweep Instances"))
+    {
+      m_isSweeping = true;
+      m_sweepStep = 0;
+      m_sweepFrame = 0;
+      m_instanceCount = SweepInstanceCounts[0];
+      m_sweepAccum = InstanceSweepResult{ m_instanceCount, 0, 0.0, 0.0 };
+      m_sweepResults.clear();
+    }
+    if (!m_sweepResults.empty())
+    {
+      ImGui::Text("Sweep result: %s", SweepResultFile);
+    }
+  }
+  ImGui::Text("Visible instances: %u (Cull %.3f ms)", m_visibleInstanceCount, m_lastCullMilliseconds);
+  if (m_isTimestampSupported)
+  {
+    auto patches = double(m_visibleInstanceCount) * double(m_patchCones.size());
+    auto patchesPerSec = m_lastGpuMilliseconds > 0.0 ? patches / (m_lastGpuMilliseconds * 1.0e-3) : 0.0;
+    ImGui::Text("GPU teapots: %.3f ms, %.1f M patches/s", m_lastGpuMilliseconds, patchesPerSec * 1.0e-6);
+  }
+  if (m_tessMode == TessMode_Adaptive)
+  {
+    ImGui::SliderFloat("PixelsPerEdge", &m_targetEdgePixels, 2.0f, 64.0f, "%.1f");
+    ImGui::SliderFloat("CurvatureTolerance", &m_curvatureTolerance, 0.1f, 4.0f, "%.2f px");
+  }
+  // ̌ς͌_ 1 `悷ꍇɕ\.
+  if (m_instanceCount == 1)
+  {
+    // Spb`WȂ̂ŁA1 pb`̌ςpb`{.
+    QuadDomainTessellator::Levels levels{
+      { m_tessFactor, m_tessFactor, m_tessFactor, m_tessFactor },
+      { m_tessFactor, m_tessFactor }
+    };
+    auto counts = QuadDomainTessellator::Count(levels);
+    auto patchCount = uint64_t(m_tessTeapot.indexCount / 16) - m_culledPatchCount;
+    ImGui::Text("Patches: %llu (Backface culled %u)", patchCount, m_culledPatchCount);
+    ImGui::Text("Uniform: Vertices %llu, Triangles %llu", counts.vertices * patchCount, counts.triangles * patchCount);
+  }
+  if (m_tessMode == TessMode_Adaptive && m_instanceCount == 1)
+  {
+    // TCS ƓvZŊepb`̕W߂Čς.
+    TeapotPatch::AdaptiveTessParams params{
+      m_projection[1][1], float(m_swapchain->GetSurfaceExtent().height), m_targetEdgePixels, m_curvatureTolerance
+    };
+    auto viewWorld = m_camera.GetViewMatrix();
+    QuadDomainTessellator::Counts total{ 0, 0 };
+    for (size_t i = 0; i + 16 <= m_teapotIndices.size(); i += 16)
+    {
+      if (m_isPatchCulled[i / 16])
+      {
+        continue;
+      }
+      glm::vec3 viewPos[16];
+      for (int j = 0; j < 16; ++j)
+      {
+        viewPos[j] = glm::vec3(viewWorld * glm::vec4(m_teapotPoints[m_teapotIndices[i + j]], 1.0f));
+      }
+      QuadDomainTessellator::Levels levels;
+      TeapotPatch::CalcAdaptiveTessLevels(viewPos, params, levels.outer, levels.inner);
+      auto counts = QuadDomainTessellator::Count(levels);
+      total.vertices += counts.vertices;
+      total.triangles += counts.triangles;
+    }
+    ImGui::Text("Adaptive: Vertices %llu, Triangles %llu", total.vertices, total.triangles);
+  }
+  if (m_tessMode == TessMode_Cpu)
+  {
+    auto level = (std::max)(int(m_tessFactor + 0.5f), 1);
+    auto it = m_cpuTeapotModels.find(level);
+    if (it != m_cpuTeapotModels.end())
+    {
+      auto visibleRatio = double(m_patchCones.size() - m_culledPatchCount) / double(m_patchCones.size());
+      ImGui::Text("CPU: LOD %d, Vertices %u, Triangles %u (drawn %.0f%%)", level, it->second.vertexCount, it->second.indexCount / 3, visibleRatio * 100.0);
+    }
+    ImGui::Text("CPU: Cached LODs %zu, Last build %.2f ms", m_cpuTeapotModels.size(), m_lastCpuTessMilliseconds);
+  }
   ImGui::End();
 
   ImGui::Render();
@@ -2,7 +2,11 @@
 #include "VulkanAppBase.h"
 #include <glm/glm.hpp>
 #include <array>
+#include <map>
 #include "Camera.h"
+#include "BezierPatchTessellator.h"
+#include "TeapotPatch.h"
+#include "TeapotInstanceSet.h"
 
 class TessellateTeapotApp : public VulkanAppBase
 {
@@ -28,6 +32,19 @@ private:
 
   void PrepareTessTeapot();
 
+  // CPU ŕbV(Ƃɍ쐬ĕێ).
+  const ModelData& GetCpuTeapotModel(int level);
+
+  // ݂̎_Ŋepb`(j) TCS Ɠŋ߂.
+  void UpdatePatchCulling();
+
+  // CX^X̎JOʂ.
+  void UpdateVisibleInstances(uint32_t imageIndex);
+
+  // O񂱂̃C[WŋL^`掞ԂǂݏoAvłΏWv.
+  void ReadTeapotTimestamps(uint32_t imageIndex);
+  void UpdateInstanceSweep();
+
   void RenderHUD(VkCommandBuffer command);
 
 private:
@@ -57,6 +74,11 @@ private:
     glm::vec4 cameraPos;
     float     tessOuterLevel;
     float     tessInnerLevel;
+    float     tessMode; // 0: l, 1: pb`/ӂƂɓKI.
+    float     targetEdgePixels;
+    float     curvatureTolerance;
+    float     screenHeight;
+    float     backfaceCulling;
   };
 
   std::vector<BufferObject> m_tessTeapotUniform;
@@ -65,4 +87,63 @@ private:
   ModelData m_tessTeapot;
 
   float m_tessFactor;
+
+  enum TessMode
+  {
+    TessMode_Uniform,
+    TessMode_Adaptive,
+    TessMode_Cpu, // CPU ŕbV`悷.
+  };
+  int m_tessMode;
+  float m_targetEdgePixels;
+  float m_curvatureTolerance;
+
+  // HUD ŕʂς邽߂̐_.
+  std::vector<glm::vec3> m_teapotPoints;
+  std::vector<uint32_t> m_teapotIndices;
+
+  // ebZ[VVF[_[Ή̊ł CPU ł̂̕ݎgp.
+  bool m_isTessellationSupported;
+  BezierPatchTessellator m_cpuTessellator;
+  std::map<int, ModelData> m_cpuTeapotModels;
+  VkPipeline m_cpuTeapotPipeline;
+  double m_lastCpuTessMilliseconds;
+
+  // pb`Pʂ̗ʃJOp̖@R[.
+  bool m_isBackfaceCulling;
+  std::vector<TeapotPatch::PatchCone> m_patchCones;
+  BufferObject m_patchConeBuffer;
+  std::vector<bool> m_isPatchCulled;
+  uint32_t m_culledPatchCount;
+
+  // CX^X`.
+  static const uint32_t MaxInstances = 16384;
+  TeapotInstanceSet m_instanceSet;
+  BufferObject m_instanceBuffer;
+  std::vector<BufferObject> m_visibleInstanceBuffers; // C[W.
+  std::vector<uint32_t> m_visibleInstances;
+  int m_instanceCount;
+  uint32_t m_visibleInstanceCount;
+  double m_lastCullMilliseconds;
+
+  // eB[|bg̕`掞Ԃ̌v(^CX^v).
+  bool m_isTimestampSupported;
+  VkQueryPool m_timestampPool;
+  std::vector<bool> m_hasTimestamps;
+  double m_timestampPeriod; // imb/JEg.
+  double m_lastGpuMilliseconds;
+
+  // CX^XiKIɑ₵ĕ`掞Ԃ CSV ɏo͂.
+  struct InstanceSweepResult
+  {
+    int instances;
+    uint32_t visibleInstances;
+    double gpuMilliseconds;
+    double frameMilliseconds;
+  };
+  bool m_isSweeping;
+  int m_sweepStep;
+  int m_sweepFrame;
+  InstanceSweepResult m_sweepAccum;
+  std::vector<InstanceSweepResult> m_sweepResults;
 };
\ No newline at end of file
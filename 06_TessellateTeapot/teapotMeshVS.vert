@@ -0,0 +1,52 @@
+#version 450
+
+// BezierPatchTessellator ŕbV`悷.
+layout(location=0) in vec3 inPos;
+layout(location=1) in vec3 inNormal;
+
+layout(location=0) out vec4 outColor;
+
+layout(set=0, binding=0)
+uniform TesseSceneParameters
+{
+  mat4 world;
+  mat4 view;
+  mat4 proj;
+  vec4 lightPos;
+  vec4 cameraPos;
+  float tessOuterLevel;
+  float tessInnerLevel;
+};
+
+// CX^XƂ̕ϊƕW̔{. TeapotInstanceSet::Instance Ɠ.
+struct TeapotInstance
+{
+  mat4 world;
+  mat4 invWorld;
+  vec4 params; // x: W̔{.
+};
+layout(set=0, binding=2)
+readonly buffer TeapotInstances
+{
+  TeapotInstance instances[];
+};
+
+// JOŎcCX^X̔ԍ.
+layout(set=0, binding=3)
+readonly buffer VisibleInstances
+{
+  uint visibleInstances[];
+};
+
+out gl_PerVertex
+{
+  vec4 gl_Position;
+};
+
+void main()
+{
+  mat4 instanceWorld = instances[visibleInstances[gl_InstanceIndex]].world;
+  gl_Position = proj * view * world * instanceWorld * vec4(inPos, 1);
+  // tessTeapotTES.tese Ɠ@(f)FƂďo͂.
+  outColor = vec4(inNormal * 0.5 + 0.5, 1);
+}
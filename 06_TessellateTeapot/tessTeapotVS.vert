@@ -1,6 +1,7 @@
 #version 450
 
 layout(location=0) in vec4 inPos;
+layout(location=0) out uint outInstance;
 
 layout(set=0, binding=0)
 uniform TesseSceneParameters
@@ -14,6 +15,13 @@ uniform TesseSceneParameters
   float tessInnerLevel;
 };
 
+// JOŎcCX^X̔ԍ.
+layout(set=0, binding=3)
+readonly buffer VisibleInstances
+{
+  uint visibleInstances[];
+};
+
 out gl_PerVertex
 {
   vec4 gl_Position;
@@ -22,4 +30,5 @@ out gl_PerVertex
 void main()
 {
   gl_Position = inPos;
+  outInstance = visibleInstances[gl_InstanceIndex];
 }
@@ -0,0 +1,392 @@
+#include "GroundTessellationEstimator.h"
+#include "TerrainQuadtree.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "stb_image.h"
+
+namespace
+{
+  float SignNotZero(float v)
+  {
+    return v >= 0.0f ? 1.0f : -1.0f;
+  }
+
+  glm::vec2 EncodeOctNormal(glm::vec3 n)
+  {
+    n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    auto e = glm::vec2(n.x, n.z);
+    if (n.y < 0.0f)
+    {
+      e = glm::vec2((1.0f - std::abs(e.y)) * SignNotZero(e.x), (1.0f - std::abs(e.x)) * SignNotZero(e.y));
+    }
+    return e;
+  }
+
+  glm::vec3 DecodeOctNormal(const glm::vec2& e)
+  {
+    auto n = glm::vec3(e.x, 1.0f - std::abs(e.x) - std::abs(e.y), e.y);
+    if (n.y < 0.0f)
+    {
+      auto x = (1.0f - std::abs(n.z)) * SignNotZero(n.x);
+      auto z = (1.0f - std::abs(n.x)) * SignNotZero(n.z);
+      n.x = x;
+      n.z = z;
+    }
+    return glm::normalize(n);
+  }
+
+  // `tB^, CLAMP_TO_EDGE ̃Tv[Ɠ.
+  template<class T>
+  T SampleBilinear(const std::vector<T>& texels, int width, int height, const glm::vec2& uv)
+  {
+    float x = uv.x * width - 0.5f;
+    float y = uv.y * height - 0.5f;
+    float fx = std::floor(x), fy = std::floor(y);
+    int x0 = int(fx), y0 = int(fy);
+    float tx = x - fx, ty = y - fy;
+    auto fetch = [&](int px, int py) {
+      px = (std::min)((std::max)(px, 0), width - 1);
+      py = (std::min)((std::max)(py, 0), height - 1);
+      return texels[py * width + px];
+    };
+    auto top = fetch(x0, y0) * (1.0f - tx) + fetch(x0 + 1, y0) * tx;
+    auto bottom = fetch(x0, y0 + 1) * (1.0f - tx) + fetch(x0 + 1, y0 + 1) * tx;
+    return top * (1.0f - ty) + bottom * ty;
+  }
+
+  glm::vec3 GetCameraPosition(const glm::mat4& view)
+  {
+    // r[s̉]̓]uŕsړ߂.
+    auto t = glm::vec3(view[3]);
+    return -glm::vec3(
+      glm::dot(glm::vec3(view[0]), t),
+      glm::dot(glm::vec3(view[1]), t),
+      glm::dot(glm::vec3(view[2]), t));
+  }
+
+  // tessTCS.tesc ̕ӂƃpb`_̑Ή.
+  const int EdgeIndices[4][2] = {
+    { 2, 0 }, { 0, 1 }, { 1, 3 }, { 2, 3 }
+  };
+}
+
+GroundTessellationEstimator::GroundTessellationEstimator()
+  : m_width(0), m_height(0), m_heightScale(0.0f)
+{
+}
+
+bool GroundTessellationEstimator::Setup(const char* heightFile, float terrainSize, float heightScale, int divide)
+{
+  int width, height;
+  stbi_uc* image = stbi_load(heightFile, &width, &height, nullptr, 4);
+  if (image == nullptr)
+  {
+    return false;
+  }
+  m_width = width;
+  m_height = height;
+  m_heightScale = heightScale;
+  m_heights.resize(width * height);
+  for (int i = 0; i < width * height; ++i)
+  {
+    m_heights[i] = image[i * 4] / 255.0f;
+  }
+  stbi_image_free(image);
+
+  m_heightBounds.Setup(width, height);
+  m_heightBounds.Build(m_heights);
+  m_normalCones.Build(m_heights, width, height, terrainSize, heightScale, divide);
+
+  // normalGenCS.comp ƓS.
+  auto fetch = [&](int x, int y) {
+    x = (std::min)((std::max)(x, 0), width - 1);
+    y = (std::min)((std::max)(y, 0), height - 1);
+    return m_heights[y * width + x];
+  };
+  float texelSizeX = terrainSize / width;
+  float texelSizeY = terrainSize / height;
+  m_octNormals.resize(width * height);
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      auto normal = glm::normalize(glm::vec3(
+        -(fetch(x + 1, y) - fetch(x - 1, y)) * heightScale / (2.0f * texelSizeX),
+        1.0f,
+        -(fetch(x, y + 1) - fetch(x, y - 1)) * heightScale / (2.0f * texelSizeY)));
+      m_octNormals[y * width + x] = EncodeOctNormal(normal);
+    }
+  }
+
+  m_patchVertices.clear();
+  for (int z = 0; z < divide; ++z)
+  {
+    for (int x = 0; x < divide; ++x)
+    {
+      int corners[4][2] = { { x, z }, { x + 1, z }, { x, z + 1 }, { x + 1, z + 1 } };
+      for (const auto& c : corners)
+      {
+        PatchVertex v;
+        v.position = glm::vec3(
+          terrainSize * c[0] / divide - terrainSize * 0.5f,
+          0.0f,
+          terrainSize * c[1] / divide - terrainSize * 0.5f);
+        v.uv = glm::vec2(float(c[0]) / divide, float(c[1]) / divide);
+        m_patchVertices.push_back(v);
+      }
+    }
+  }
+  return true;
+}
+
+float GroundTessellationEstimator::SampleHeight(const glm::vec2& uv) const
+{
+  return SampleBilinear(m_heights, m_width, m_height, uv);
+}
+
+glm::vec3 GroundTessellationEstimator::SampleNormal(const glm::vec2& uv) const
+{
+  return DecodeOctNormal(SampleBilinear(m_octNormals, m_width, m_height, uv));
+}
+
+void GroundTessellationEstimator::CalcPatchBounds(const PatchVertex* v, glm::vec3& bmin, glm::vec3& bmax) const
+{
+  bmin = glm::vec3(1.0e30f);
+  bmax = glm::vec3(-1.0e30f);
+  auto uvMin = glm::vec2(1.0e30f), uvMax = glm::vec2(-1.0e30f);
+  for (int i = 0; i < 4; ++i)
+  {
+    bmin = glm::min(bmin, v[i].position);
+    bmax = glm::max(bmax, v[i].position);
+    uvMin = glm::min(uvMin, v[i].uv);
+    uvMax = glm::max(uvMax, v[i].uv);
+  }
+  auto heightBounds = m_heightBounds.Query(uvMin, uvMax) * m_heightScale;
+  bmax.y += heightBounds.y;
+  bmin.y += heightBounds.x;
+}
+
+bool GroundTessellationEstimator::IsOutsideFrustum(const PatchVertex* v, const glm::vec4 planes[6]) const
+{
+  glm::vec3 bmin, bmax;
+  CalcPatchBounds(v, bmin, bmax);
+  for (int i = 0; i < 6; ++i)
+  {
+    const auto& plane = planes[i];
+    auto p = glm::vec3(
+      plane.x >= 0.0f ? bmax.x : bmin.x,
+      plane.y >= 0.0f ? bmax.y : bmin.y,
+      plane.z >= 0.0f ? bmax.z : bmin.z);
+    if (glm::dot(glm::vec3(plane), p) + plane.w < 0.0f)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool GroundTessellationEstimator::IsBackfacing(uint32_t patchIndex, const PatchVertex* v, const glm::vec3& cameraPos) const
+{
+  // tessTCS.tesc ƓA@R[ƎR[̊pxŔ肷.
+  glm::vec3 bmin, bmax;
+  CalcPatchBounds(v, bmin, bmax);
+  auto center = (bmin + bmax) * 0.5f;
+  float radius = glm::length(bmax - bmin) * 0.5f;
+  auto toPatch = center - cameraPos;
+  float dist = glm::length(toPatch);
+  if (dist <= radius)
+  {
+    return false;
+  }
+  const auto& cone = m_normalCones.GetCone(int(patchIndex));
+  float viewAngle = std::asin(radius / dist);
+  float angle = std::acos(glm::clamp(glm::dot(glm::vec3(cone), toPatch / dist), -1.0f, 1.0f));
+  const float HalfPI = 1.5707963f;
+  return angle + cone.w + viewAngle < HalfPI;
+}
+
+void GroundTessellationEstimator::CalcDistanceLevels(const PatchVertex* v, const glm::vec3& cameraPos, QuadDomainTessellator::Levels& levels) const
+{
+  // CalcTessFactor, CalcNormalBias Ɠ.
+  const float tessNear = 2.0f, tessFar = 150.0f;
+  const float MaxTessFactor = 32.0f;
+  const float normalThreshold = 0.85f;
+  for (int i = 0; i < 4; ++i)
+  {
+    const auto& v0 = v[EdgeIndices[i][0]];
+    const auto& v1 = v[EdgeIndices[i][1]];
+    auto p = (v0.position + v1.position) * 0.5f;
+    auto n = SampleNormal((v0.uv + v1.uv) * 0.5f);
+
+    float dist = glm::length(p - cameraPos);
+    float factor = MaxTessFactor - (MaxTessFactor - 1.0f) * (dist - tessNear) / (tessFar - tessNear);
+    factor = glm::clamp(factor, 1.0f, MaxTessFactor);
+
+    auto fromCamera = glm::normalize(p - cameraPos);
+    float cos2 = glm::dot(n, fromCamera);
+    cos2 *= cos2;
+    float bias = (std::max)(1.0f - cos2 - normalThreshold, 0.0f) / (1.0f - normalThreshold);
+    levels.outer[i] = factor + bias * 32.0f;
+  }
+  levels.inner[0] = 0.5f * (levels.outer[0] + levels.outer[2]);
+  levels.inner[1] = 0.5f * (levels.outer[1] + levels.outer[3]);
+}
+
+void GroundTessellationEstimator::CalcScreenSpaceLevels(const PatchVertex* v, const CameraFrame& camera, float targetEdgePixels, QuadDomainTessellator::Levels& levels) const
+{
+  // CalcScreenSpaceTessFactor Ɠ.
+  const float MaxTessFactor = 64.0f;
+  for (int i = 0; i < 4; ++i)
+  {
+    const auto& v0 = v[EdgeIndices[i][0]];
+    const auto& v1 = v[EdgeIndices[i][1]];
+    auto p0 = v0.position, p1 = v1.position;
+    p0.y += SampleHeight(v0.uv) * m_heightScale;
+    p1.y += SampleHeight(v1.uv) * m_heightScale;
+
+    auto center = camera.view * glm::vec4((p0 + p1) * 0.5f, 1.0f);
+    float diameter = glm::length(p0 - p1);
+    float depth = (std::max)(-center.z, 0.1f);
+    float pixels = diameter * camera.proj[1][1] / depth * camera.height * 0.5f;
+    levels.outer[i] = glm::clamp(pixels / targetEdgePixels, 1.0f, MaxTessFactor);
+  }
+  levels.inner[0] = 0.5f * (levels.outer[0] + levels.outer[2]);
+  levels.inner[1] = 0.5f * (levels.outer[1] + levels.outer[3]);
+}
+
+GroundTessellationEstimator::FrameStats GroundTessellationEstimator::Evaluate(const CameraFrame& camera, const Settings& settings, std::vector<PatchStats>* patches) const
+{
+  FrameStats frame{};
+  glm::vec4 planes[6];
+  TerrainQuadtree::CalcFrustumPlanes(camera.proj * camera.view, planes);
+  auto cameraPos = GetCameraPosition(camera.view);
+
+  auto patchCount = uint32_t(m_patchVertices.size() / 4);
+  frame.patches = patchCount;
+  if (patches)
+  {
+    patches->resize(patchCount);
+  }
+  for (uint32_t i = 0; i < patchCount; ++i)
+  {
+    const auto* v = &m_patchVertices[i * 4];
+    PatchStats patch{};
+    if (settings.frustumCulling && IsOutsideFrustum(v, planes))
+    {
+      patch.frustumCulled = true;
+      frame.frustumCulled++;
+    }
+    else if (settings.backfaceCulling && IsBackfacing(i, v, cameraPos))
+    {
+      patch.backfaceCulled = true;
+      frame.backfaceCulled++;
+    }
+    else
+    {
+      if (settings.factorMode == 0)
+      {
+        CalcDistanceLevels(v, cameraPos, patch.levels);
+      }
+      else
+      {
+        CalcScreenSpaceLevels(v, camera, settings.targetEdgePixels, patch.levels);
+      }
+      patch.counts = QuadDomainTessellator::Count(patch.levels);
+      frame.vertices += patch.counts.vertices;
+      frame.triangles += patch.counts.triangles;
+    }
+    if (patches)
+    {
+      (*patches)[i] = patch;
+    }
+  }
+  return frame;
+}
+
+void GroundTessellationEstimator::WriteCameraFrame(std::ostream& os, const CameraFrame& camera)
+{
+  for (int c = 0; c < 4; ++c)
+  {
+    for (int r = 0; r < 4; ++r)
+    {
+      os << camera.view[c][r] << ' ';
+    }
+  }
+  for (int c = 0; c < 4; ++c)
+  {
+    for (int r = 0; r < 4; ++r)
+    {
+      os << camera.proj[c][r] << ' ';
+    }
+  }
+  os << camera.width << ' ' << camera.height << '\n';
+}
+
+bool GroundTessellationEstimator::LoadCameraPath(const char* fileName, std::vector<CameraFrame>& frames)
+{
+  std::ifstream infile(fileName);
+  if (!infile)
+  {
+    return false;
+  }
+  frames.clear();
+  std::string line;
+  while (std::getline(infile, line))
+  {
+    std::istringstream ss(line);
+    CameraFrame camera;
+    for (int c = 0; c < 4; ++c)
+    {
+      for (int r = 0; r < 4; ++r)
+      {
+        ss >> camera.view[c][r];
+      }
+    }
+    for (int c = 0; c < 4; ++c)
+    {
+      for (int r = 0; r < 4; ++r)
+      {
+        ss >> camera.proj[c][r];
+      }
+    }
+    ss >> camera.width >> camera.height;
+    if (ss)
+    {
+      frames.push_back(camera);
+    }
+  }
+  return true;
+}
+
+bool GroundTessellationEstimator::EvaluateCameraPath(const char* pathFile, const char* csvFile, const Settings& settings) const
+{
+  std::vector<CameraFrame> frames;
+  if (!LoadCameraPath(pathFile, frames))
+  {
+    return false;
+  }
+  std::ofstream outfile(csvFile);
+  if (!outfile)
+  {
+    return false;
+  }
+  outfile << "frame,patches,frustumCulled,backfaceCulled,vertices,triangles\n";
+  uint64_t totalTriangles = 0, maxTriangles = 0;
+  for (size_t i = 0; i < frames.size(); ++i)
+  {
+    auto stats = Evaluate(frames[i], settings);
+    outfile << i << ',' << stats.patches << ',' << stats.frustumCulled << ',' << stats.backfaceCulled << ','
+      << stats.vertices << ',' << stats.triangles << '\n';
+    totalTriangles += stats.triangles;
+    maxTriangles = (std::max)(maxTriangles, stats.triangles);
+  }
+  if (!frames.empty())
+  {
+    outfile << "# average triangles," << totalTriangles / frames.size() << ",max triangles," << maxTriangles << '\n';
+  }
+  return true;
+}
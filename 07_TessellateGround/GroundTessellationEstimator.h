@@ -0,0 +1,85 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <iosfwd>
+#include "QuadDomainTessellator.h"
+#include "TerrainHeightBounds.h"
+#include "TerrainNormalCones.h"
+
+// tessTCS.tesc ̃JOƕW̌vZ CPU ōČA钸_/Op`ς.
+// GPU gȂ߁AL^JpXɑ΂ăItCŎsł.
+class GroundTessellationEstimator
+{
+public:
+  struct Settings
+  {
+    bool frustumCulling;
+    bool backfaceCulling;
+    int factorMode; // 0: , 1: ʏ̕ӂ̒.
+    float targetEdgePixels;
+  };
+  struct PatchStats
+  {
+    bool frustumCulled;
+    bool backfaceCulled;
+    QuadDomainTessellator::Levels levels;
+    QuadDomainTessellator::Counts counts;
+  };
+  struct FrameStats
+  {
+    uint32_t patches;
+    uint32_t frustumCulled;
+    uint32_t backfaceCulled;
+    uint64_t vertices;
+    uint64_t triangles;
+  };
+
+  // JpX 1 t[.
+  struct CameraFrame
+  {
+    glm::mat4 view;
+    glm::mat4 proj;
+    float width;
+    float height;
+  };
+
+  GroundTessellationEstimator();
+
+  // TessellateGroundApp::PreparePrimitiveResource Ɠpb`ŏ.
+  bool Setup(const char* heightFile, float terrainSize, float heightScale, int divide);
+
+  FrameStats Evaluate(const CameraFrame& camera, const Settings& settings, std::vector<PatchStats>* patches = nullptr) const;
+
+  // JpX̃t@C 1 s 1 t[(r[s 16 vf, ˉes 16 vf, ʕ, ʍ).
+  static void WriteCameraFrame(std::ostream& os, const CameraFrame& camera);
+  static bool LoadCameraPath(const char* fileName, std::vector<CameraFrame>& frames);
+
+  // JpX̊et[]At[̓v CSV ɏo.
+  bool EvaluateCameraPath(const char* pathFile, const char* csvFile, const Settings& settings) const;
+
+private:
+  struct PatchVertex
+  {
+    glm::vec3 position;
+    glm::vec2 uv;
+  };
+
+  float SampleHeight(const glm::vec2& uv) const;
+  glm::vec3 SampleNormal(const glm::vec2& uv) const;
+
+  void CalcPatchBounds(const PatchVertex* v, glm::vec3& bmin, glm::vec3& bmax) const;
+  bool IsOutsideFrustum(const PatchVertex* v, const glm::vec4 planes[6]) const;
+  bool IsBackfacing(uint32_t patchIndex, const PatchVertex* v, const glm::vec3& cameraPos) const;
+  void CalcDistanceLevels(const PatchVertex* v, const glm::vec3& cameraPos, QuadDomainTessellator::Levels& levels) const;
+  void CalcScreenSpaceLevels(const PatchVertex* v, const CameraFrame& camera, float targetEdgePixels, QuadDomainTessellator::Levels& levels) const;
+
+  int m_width;
+  int m_height;
+  float m_heightScale;
+  std::vector<float> m_heights;
+  std::vector<glm::vec2> m_octNormals; // normalGenCS Ɠʑ̃GR[h.
+  TerrainHeightBounds m_heightBounds;
+  TerrainNormalCones m_normalCones;
+  std::vector<PatchVertex> m_patchVertices; // pb` 4 _.
+};
@@ -0,0 +1,131 @@
+#include "TerrainHeightBounds.h"
+#include <algorithm>
+#include <cmath>
+
+TerrainHeightBounds::TerrainHeightBounds()
+  : m_sourceWidth(0), m_sourceHeight(0), m_isValid(false)
+{
+}
+
+int TerrainHeightBounds::CalcLevelCount(int sourceWidth, int sourceHeight)
+{
+  int count = 0;
+  int width = sourceWidth, height = sourceHeight;
+  do
+  {
+    width = (std::max)((width + 1) / 2, 1);
+    height = (std::max)((height + 1) / 2, 1);
+    ++count;
+  } while (width > 1 || height > 1);
+  return count;
+}
+
+void TerrainHeightBounds::Setup(int sourceWidth, int sourceHeight)
+{
+  m_sourceWidth = sourceWidth;
+  m_sourceHeight = sourceHeight;
+  m_isValid = false;
+
+  auto count = CalcLevelCount(sourceWidth, sourceHeight);
+  m_levels.resize(count);
+  int width = sourceWidth, height = sourceHeight;
+  for (auto& level : m_levels)
+  {
+    width = (std::max)((width + 1) / 2, 1);
+    height = (std::max)((height + 1) / 2, 1);
+    level.width = width;
+    level.height = height;
+    level.texels.assign(width * height, glm::vec2(0.0f, 1.0f));
+  }
+}
+
+void TerrainHeightBounds::SetLevelData(int level, const glm::vec2* texels)
+{
+  auto& dst = m_levels[level];
+  std::copy(texels, texels + dst.width * dst.height, dst.texels.begin());
+  // Sxݒ肵_(ŏʃx)ŗLƂ.
+  if (level == GetLevelCount() - 1)
+  {
+    m_isValid = true;
+  }
+}
+
+void TerrainHeightBounds::Build(const std::vector<float>& heights)
+{
+  // heightBoundsInitCS / heightBoundsReduceCS Ɠ 2x2 vf܂Ƃ߂.
+  int srcWidth = m_sourceWidth, srcHeight = m_sourceHeight;
+  std::vector<glm::vec2> src(heights.size());
+  for (size_t i = 0; i < heights.size(); ++i)
+  {
+    src[i] = glm::vec2(heights[i]);
+  }
+  for (int level = 0; level < GetLevelCount(); ++level)
+  {
+    auto& dst = m_levels[level];
+    for (int y = 0; y < dst.height; ++y)
+    {
+      for (int x = 0; x < dst.width; ++x)
+      {
+        glm::vec2 bounds(1.0f, 0.0f);
+        for (int i = 0; i < 4; ++i)
+        {
+          int sx = (std::min)(x * 2 + (i & 1), srcWidth - 1);
+          int sy = (std::min)(y * 2 + (i >> 1), srcHeight - 1);
+          const auto& v = src[sy * srcWidth + sx];
+          bounds.x = (std::min)(bounds.x, v.x);
+          bounds.y = (std::max)(bounds.y, v.y);
+        }
+        dst.texels[y * dst.width + x] = bounds;
+      }
+    }
+    src = dst.texels;
+    srcWidth = dst.width;
+    srcHeight = dst.height;
+  }
+  m_isValid = true;
+}
+
+glm::vec2 TerrainHeightBounds::Query(const glm::vec2& uvMin, const glm::vec2& uvMax) const
+{
+  if (!m_isValid)
+  {
+    return glm::vec2(0.0f, 1.0f);
+  }
+  // oCjAԂŎQƂf܂Ŋ܂߂͈.
+  int x0 = int(std::floor(uvMin.x * m_sourceWidth - 0.5f));
+  int y0 = int(std::floor(uvMin.y * m_sourceHeight - 0.5f));
+  int x1 = int(std::floor(uvMax.x * m_sourceWidth - 0.5f)) + 1;
+  int y1 = int(std::floor(uvMax.y * m_sourceHeight - 0.5f)) + 1;
+  x0 = glm::clamp(x0, 0, m_sourceWidth - 1);
+  y0 = glm::clamp(y0, 0, m_sourceHeight - 1);
+  x1 = glm::clamp(x1, 0, m_sourceWidth - 1);
+  y1 = glm::clamp(y1, 0, m_sourceHeight - 1);
+
+  // ͈͂ 2x2 vfɎ܂郌xI.
+  int level = 0;
+  int levelCount = GetLevelCount();
+  for (; level < levelCount - 1; ++level)
+  {
+    int shift = level + 1;
+    if ((x1 >> shift) - (x0 >> shift) <= 1 && (y1 >> shift) - (y0 >> shift) <= 1)
+    {
+      break;
+    }
+  }
+  const auto& lv = m_levels[level];
+  int shift = level + 1;
+  int tx0 = (std::min)(x0 >> shift, lv.width - 1), tx1 = (std::min)(x1 >> shift, lv.width - 1);
+  int ty0 = (std::min)(y0 >> shift, lv.height - 1), ty1 = (std::min)(y1 >> shift, lv.height - 1);
+
+  glm::vec2 result(1.0f, 0.0f);
+  for (int y = ty0; y <= ty1; ++y)
+  {
+    for (int x = tx0; x <= tx1; ++x)
+    {
+      const auto& t = lv.texels[y * lv.width + x];
+      result.x = (std::min)(result.x, t.x);
+      result.y = (std::max)(result.y, t.y);
+    }
+  }
+  return result;
+}
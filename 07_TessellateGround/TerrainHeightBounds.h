@@ -0,0 +1,45 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+// nCg}bv̍ŏ/őls~bh(CPU ̕).
+// x 0 ̓nCg}bv 2x2 fAȍ~ 1 ̃x 2x2 vf܂Ƃ߂.
+class TerrainHeightBounds
+{
+public:
+  TerrainHeightBounds();
+
+  // nCg}bv̉𑜓xex̃TCY߂.
+  void Setup(int sourceWidth, int sourceHeight);
+  void SetLevelData(int level, const glm::vec2* texels);
+
+  // GPU g킸 CPU Ńs~bh쐬(heights  0..1, Setup ς݂̃TCY).
+  void Build(const std::vector<float>& heights);
+
+  // UV ͈͓̍(0..1)̍ŏl(x)ƍől(y)Ԃ.
+  // s~bh쐬̏ꍇ (0,1) Ԃ.
+  glm::vec2 Query(const glm::vec2& uvMin, const glm::vec2& uvMax) const;
+
+  bool IsValid() const { return m_isValid; }
+  int GetLevelCount() const { return int(m_levels.size()); }
+  int GetLevelWidth(int level) const { return m_levels[level].width; }
+  int GetLevelHeight(int level) const { return m_levels[level].height; }
+  int GetSourceWidth() const { return m_sourceWidth; }
+  int GetSourceHeight() const { return m_sourceHeight; }
+
+  // s~bh̃x(1x1 ܂).
+  static int CalcLevelCount(int sourceWidth, int sourceHeight);
+
+private:
+  struct Level
+  {
+    int width;
+    int height;
+    std::vector<glm::vec2> texels;
+  };
+  int m_sourceWidth;
+  int m_sourceHeight;
+  std::vector<Level> m_levels;
+  bool m_isValid;
+};
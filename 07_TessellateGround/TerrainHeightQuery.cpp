@@ -0,0 +1,383 @@
+#include "TerrainHeightQuery.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "stb_image.h"
+
+namespace
+{
+  float SignNotZero(float v)
+  {
+    return v >= 0.0f ? 1.0f : -1.0f;
+  }
+
+  glm::vec2 EncodeOctNormal(glm::vec3 n)
+  {
+    n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    auto e = glm::vec2(n.x, n.z);
+    if (n.y < 0.0f)
+    {
+      e = glm::vec2((1.0f - std::abs(e.y)) * SignNotZero(e.x), (1.0f - std::abs(e.x)) * SignNotZero(e.y));
+    }
+    return e;
+  }
+
+  // SIMD łƓZŕ(ʂrbgPʂňv邽).
+  glm::vec3 DecodeOctNormal(float ex, float ey)
+  {
+    float x = ex, z = ey;
+    float y = 1.0f - std::abs(ex) - std::abs(ey);
+    if (y < 0.0f)
+    {
+      x = (1.0f - std::abs(ey)) * SignNotZero(ex);
+      z = (1.0f - std::abs(ex)) * SignNotZero(ey);
+    }
+    float len = std::sqrt(x * x + y * y + z * z);
+    return glm::vec3(x / len, y / len, z / len);
+  }
+
+  // `tB^, CLAMP_TO_EDGE ̃Tv[ƓԂɎg 4 eNZƏd.
+  struct BilinearFootprint
+  {
+    int x0, x1, y0, y1;
+    float tx, ty;
+  };
+
+  BilinearFootprint CalcFootprint(float u, float v, int width, int height)
+  {
+    float x = u * width - 0.5f;
+    float y = v * height - 0.5f;
+    float fx = std::floor(x), fy = std::floor(y);
+    BilinearFootprint fp;
+    fp.tx = x - fx;
+    fp.ty = y - fy;
+    int ix = int(fx), iy = int(fy);
+    fp.x0 = (std::min)((std::max)(ix, 0), width - 1);
+    fp.x1 = (std::min)((std::max)(ix + 1, 0), width - 1);
+    fp.y0 = (std::min)((std::max)(iy, 0), height - 1);
+    fp.y1 = (std::min)((std::max)(iy + 1, 0), height - 1);
+    return fp;
+  }
+
+  bool QueryAvx2Support()
+  {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+      return false;
+    }
+    __cpuid(info, 1);
+    // OSXSAVE  AVX LŁAOS  YMM WX^ۑ邱.
+    const int osxsaveAvx = (1 << 27) | (1 << 28);
+    if ((info[2] & osxsaveAvx) != osxsaveAvx || (_xgetbv(0) & 6) != 6)
+    {
+      return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+  }
+
+  std::vector<glm::vec2> CreateRandomPositions(size_t count, float terrainSize)
+  {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-terrainSize * 0.5f, terrainSize * 0.5f);
+    std::vector<glm::vec2> positions(count);
+    for (auto& p : positions)
+    {
+      p = glm::vec2(dist(rng), dist(rng));
+    }
+    return positions;
+  }
+
+  template<class Func>
+  double MeasureQueriesPerSecond(size_t count, int iterations, Func func)
+  {
+    using namespace std::chrono;
+    func(); // EH[Abv.
+    auto start = high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+      func();
+    }
+    auto elapsed = duration<double>(high_resolution_clock::now() - start).count();
+    return elapsed > 0.0 ? double(count) * iterations / elapsed : 0.0;
+  }
+}
+
+TerrainHeightQuery::TerrainHeightQuery()
+  : m_width(0), m_height(0), m_tilesX(0), m_terrainSize(0.0f), m_heightScale(0.0f), m_useSimd(false)
+{
+}
+
+bool TerrainHeightQuery::IsAvx2Supported()
+{
+  static const bool supported = QueryAvx2Support();
+  return supported;
+}
+
+size_t TerrainHeightQuery::GetTiledIndex(int x, int y) const
+{
+  size_t tile = size_t(y >> TileShift) * m_tilesX + (x >> TileShift);
+  return (tile << (TileShift * 2)) | ((y & (TileSize - 1)) << TileShift) | (x & (TileSize - 1));
+}
+
+bool TerrainHeightQuery::Setup(const char* heightFile, float terrainSize, float heightScale)
+{
+  int width, height;
+  stbi_uc* image = stbi_load(heightFile, &width, &height, nullptr, 4);
+  if (image == nullptr)
+  {
+    return false;
+  }
+  m_width = width;
+  m_height = height;
+  m_tilesX = (width + TileSize - 1) / TileSize;
+  m_terrainSize = terrainSize;
+  m_heightScale = heightScale;
+
+  int tilesY = (height + TileSize - 1) / TileSize;
+  size_t tiledCount = size_t(m_tilesX) * tilesY * TileSize * TileSize;
+  m_heights.assign(tiledCount, 0.0f);
+  m_octNormalX.assign(tiledCount, 0.0f);
+  m_octNormalY.assign(tiledCount, 1.0f);
+
+  // R8G8B8A8_UNORM ŎQƂlƓ.
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      m_heights[GetTiledIndex(x, y)] = image[(y * width + x) * 4] / 255.0f;
+    }
+  }
+  stbi_image_free(image);
+
+  // normalGenCS.comp ƓS.
+  auto fetch = [&](int x, int y) {
+    x = (std::min)((std::max)(x, 0), width - 1);
+    y = (std::min)((std::max)(y, 0), height - 1);
+    return m_heights[GetTiledIndex(x, y)];
+  };
+  float texelSizeX = terrainSize / width;
+  float texelSizeY = terrainSize / height;
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      auto normal = glm::normalize(glm::vec3(
+        -(fetch(x + 1, y) - fetch(x - 1, y)) * heightScale / (2.0f * texelSizeX),
+        1.0f,
+        -(fetch(x, y + 1) - fetch(x, y - 1)) * heightScale / (2.0f * texelSizeY)));
+      auto e = EncodeOctNormal(normal);
+      m_octNormalX[GetTiledIndex(x, y)] = e.x;
+      m_octNormalY[GetTiledIndex(x, y)] = e.y;
+    }
+  }
+  m_useSimd = IsAvx2Supported();
+  return true;
+}
+
+float TerrainHeightQuery::QueryHeight(const glm::vec2& positionXZ) const
+{
+  float half = m_terrainSize * 0.5f;
+  auto fp = CalcFootprint((positionXZ.x + half) / m_terrainSize, (positionXZ.y + half) / m_terrainSize, m_width, m_height);
+  float h00 = m_heights[GetTiledIndex(fp.x0, fp.y0)];
+  float h10 = m_heights[GetTiledIndex(fp.x1, fp.y0)];
+  float h01 = m_heights[GetTiledIndex(fp.x0, fp.y1)];
+  float h11 = m_heights[GetTiledIndex(fp.x1, fp.y1)];
+  float top = h00 * (1.0f - fp.tx) + h10 * fp.tx;
+  float bottom = h01 * (1.0f - fp.tx) + h11 * fp.tx;
+  return (top * (1.0f - fp.ty) + bottom * fp.ty) * m_heightScale;
+}
+
+glm::vec3 TerrainHeightQuery::QueryNormal(const glm::vec2& positionXZ) const
+{
+  float half = m_terrainSize * 0.5f;
+  auto fp = CalcFootprint((positionXZ.x + half) / m_terrainSize, (positionXZ.y + half) / m_terrainSize, m_width, m_height);
+  size_t i00 = GetTiledIndex(fp.x0, fp.y0), i10 = GetTiledIndex(fp.x1, fp.y0);
+  size_t i01 = GetTiledIndex(fp.x0, fp.y1), i11 = GetTiledIndex(fp.x1, fp.y1);
+  auto lerp2d = [&](const std::vector<float>& t) {
+    float top = t[i00] * (1.0f - fp.tx) + t[i10] * fp.tx;
+    float bottom = t[i01] * (1.0f - fp.tx) + t[i11] * fp.tx;
+    return top * (1.0f - fp.ty) + bottom * fp.ty;
+  };
+  return DecodeOctNormal(lerp2d(m_octNormalX), lerp2d(m_octNormalY));
+}
+
+void TerrainHeightQuery::QueryHeights(const glm::vec2* positionsXZ, float* heights, size_t count) const
+{
+  size_t i = 0;
+  if (m_useSimd)
+  {
+    i = count & ~size_t(7);
+    QueryHeightsSimd(positionsXZ, heights, i);
+  }
+  for (; i < count; ++i)
+  {
+    heights[i] = QueryHeight(positionsXZ[i]);
+  }
+}
+
+void TerrainHeightQuery::QueryNormals(const glm::vec2* positionsXZ, glm::vec3* normals, size_t count) const
+{
+  size_t i = 0;
+  if (m_useSimd)
+  {
+    i = count & ~size_t(7);
+    QueryNormalsSimd(positionsXZ, normals, i);
+  }
+  for (; i < count; ++i)
+  {
+    normals[i] = QueryNormal(positionsXZ[i]);
+  }
+}
+
+// ȉ AVX2 . 8 ̈ʒu܂Ƃ߂ď(count  8 ̔{).
+namespace
+{
+  struct SimdFootprint
+  {
+    __m256i i00, i10, i01, i11; // ^Cɕׂz̃CfbNX.
+    __m256 tx, ty;
+  };
+
+  // AoS  vec2 x8  X, Z ɕ.
+  void LoadPositions(const glm::vec2* p, __m256& x, __m256& z)
+  {
+    auto a = _mm256_loadu_ps(&p[0].x);
+    auto b = _mm256_loadu_ps(&p[4].x);
+    x = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+    z = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+  }
+
+  __m256i CalcTiledIndex(__m256i x, __m256i y, __m256i tilesX)
+  {
+    const int shift = 3;
+    auto mask = _mm256_set1_epi32((1 << shift) - 1);
+    auto tile = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(y, shift), tilesX), _mm256_srli_epi32(x, shift));
+    auto local = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(y, mask), shift), _mm256_and_si256(x, mask));
+    return _mm256_or_si256(_mm256_slli_epi32(tile, shift * 2), local);
+  }
+
+  SimdFootprint CalcSimdFootprint(const glm::vec2* p, float terrainSize, int width, int height, int tilesX)
+  {
+    __m256 px, pz;
+    LoadPositions(p, px, pz);
+    auto size = _mm256_set1_ps(terrainSize);
+    auto half = _mm256_set1_ps(terrainSize * 0.5f);
+    auto u = _mm256_div_ps(_mm256_add_ps(px, half), size);
+    auto v = _mm256_div_ps(_mm256_add_ps(pz, half), size);
+    auto x = _mm256_sub_ps(_mm256_mul_ps(u, _mm256_set1_ps(float(width))), _mm256_set1_ps(0.5f));
+    auto y = _mm256_sub_ps(_mm256_mul_ps(v, _mm256_set1_ps(float(height))), _mm256_set1_ps(0.5f));
+    auto fx = _mm256_floor_ps(x);
+    auto fy = _mm256_floor_ps(y);
+
+    SimdFootprint fp;
+    fp.tx = _mm256_sub_ps(x, fx);
+    fp.ty = _mm256_sub_ps(y, fy);
+
+    auto zero = _mm256_setzero_si256();
+    auto one = _mm256_set1_epi32(1);
+    auto maxX = _mm256_set1_epi32(width - 1);
+    auto maxY = _mm256_set1_epi32(height - 1);
+    auto ix = _mm256_cvttps_epi32(fx);
+    auto iy = _mm256_cvttps_epi32(fy);
+    auto x0 = _mm256_min_epi32(_mm256_max_epi32(ix, zero), maxX);
+    auto x1 = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(ix, one), zero), maxX);
+    auto y0 = _mm256_min_epi32(_mm256_max_epi32(iy, zero), maxY);
+    auto y1 = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(iy, one), zero), maxY);
+
+    auto tiles = _mm256_set1_epi32(tilesX);
+    fp.i00 = CalcTiledIndex(x0, y0, tiles);
+    fp.i10 = CalcTiledIndex(x1, y0, tiles);
+    fp.i01 = CalcTiledIndex(x0, y1, tiles);
+    fp.i11 = CalcTiledIndex(x1, y1, tiles);
+    return fp;
+  }
+
+  // XJ[łƓZ(FMA ͎gȂ).
+  __m256 SampleBilinear(const float* texels, const SimdFootprint& fp)
+  {
+    auto one = _mm256_set1_ps(1.0f);
+    auto h00 = _mm256_i32gather_ps(texels, fp.i00, 4);
+    auto h10 = _mm256_i32gather_ps(texels, fp.i10, 4);
+    auto h01 = _mm256_i32gather_ps(texels, fp.i01, 4);
+    auto h11 = _mm256_i32gather_ps(texels, fp.i11, 4);
+    auto invTx = _mm256_sub_ps(one, fp.tx);
+    auto top = _mm256_add_ps(_mm256_mul_ps(h00, invTx), _mm256_mul_ps(h10, fp.tx));
+    auto bottom = _mm256_add_ps(_mm256_mul_ps(h01, invTx), _mm256_mul_ps(h11, fp.tx));
+    return _mm256_add_ps(_mm256_mul_ps(top, _mm256_sub_ps(one, fp.ty)), _mm256_mul_ps(bottom, fp.ty));
+  }
+}
+
+void TerrainHeightQuery::QueryHeightsSimd(const glm::vec2* positionsXZ, float* heights, size_t count) const
+{
+  auto scale = _mm256_set1_ps(m_heightScale);
+  for (size_t i = 0; i < count; i += 8)
+  {
+    auto fp = CalcSimdFootprint(positionsXZ + i, m_terrainSize, m_width, m_height, m_tilesX);
+    _mm256_storeu_ps(heights + i, _mm256_mul_ps(SampleBilinear(m_heights.data(), fp), scale));
+  }
+}
+
+void TerrainHeightQuery::QueryNormalsSimd(const glm::vec2* positionsXZ, glm::vec3* normals, size_t count) const
+{
+  auto one = _mm256_set1_ps(1.0f);
+  auto zero = _mm256_setzero_ps();
+  auto signMask = _mm256_set1_ps(-0.0f);
+  for (size_t i = 0; i < count; i += 8)
+  {
+    auto fp = CalcSimdFootprint(positionsXZ + i, m_terrainSize, m_width, m_height, m_tilesX);
+    auto ex = SampleBilinear(m_octNormalX.data(), fp);
+    auto ey = SampleBilinear(m_octNormalY.data(), fp);
+
+    auto absX = _mm256_andnot_ps(signMask, ex);
+    auto absY = _mm256_andnot_ps(signMask, ey);
+    auto ny = _mm256_sub_ps(_mm256_sub_ps(one, absX), absY);
+
+    // ͐܂Ԃ. SignNotZero Ɠl 0 ͐Ƃ݂Ȃ.
+    auto signX = _mm256_blendv_ps(one, _mm256_set1_ps(-1.0f), _mm256_cmp_ps(ex, zero, _CMP_LT_OQ));
+    auto signY = _mm256_blendv_ps(one, _mm256_set1_ps(-1.0f), _mm256_cmp_ps(ey, zero, _CMP_LT_OQ));
+    auto fold = _mm256_cmp_ps(ny, zero, _CMP_LT_OQ);
+    auto nx = _mm256_blendv_ps(ex, _mm256_mul_ps(_mm256_sub_ps(one, absY), signX), fold);
+    auto nz = _mm256_blendv_ps(ey, _mm256_mul_ps(_mm256_sub_ps(one, absX), signY), fold);
+
+    auto len = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, nx), _mm256_mul_ps(ny, ny)), _mm256_mul_ps(nz, nz)));
+    alignas(32) float outX[8], outY[8], outZ[8];
+    _mm256_store_ps(outX, _mm256_div_ps(nx, len));
+    _mm256_store_ps(outY, _mm256_div_ps(ny, len));
+    _mm256_store_ps(outZ, _mm256_div_ps(nz, len));
+    for (int j = 0; j < 8; ++j)
+    {
+      normals[i + j] = glm::vec3(outX[j], outY[j], outZ[j]);
+    }
+  }
+}
+
+double TerrainHeightQuery::MeasureHeightQueriesPerSecond(size_t count, int iterations) const
+{
+  auto positions = CreateRandomPositions(count, m_terrainSize);
+  std::vector<float> heights(count);
+  return MeasureQueriesPerSecond(count, iterations, [&]() {
+    QueryHeights(positions.data(), heights.data(), count);
+  });
+}
+
+double TerrainHeightQuery::MeasureNormalQueriesPerSecond(size_t count, int iterations) const
+{
+  auto positions = CreateRandomPositions(count, m_terrainSize);
+  std::vector<glm::vec3> normals(count);
+  return MeasureQueriesPerSecond(count, iterations, [&]() {
+    QueryNormals(positions.data(), normals.data(), count);
+  });
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstddef>
+
+// CPU n`̍/@₢킹.
+// tessTES.tese ̕ψ(nCg}bv`ԂčXP[{)ƓvZsA
+// ̈ʒu܂Ƃ߂ďꍇ AVX2 gp.
+class TerrainHeightQuery
+{
+public:
+  TerrainHeightQuery();
+
+  // n`͌_Sň terrainSize ̐`(TessellateGroundApp ̒nʂƓzu).
+  bool Setup(const char* heightFile, float terrainSize, float heightScale);
+
+  // positionsXZ ̓[hԂ XZ W.
+  float QueryHeight(const glm::vec2& positionXZ) const;
+  glm::vec3 QueryNormal(const glm::vec2& positionXZ) const;
+  void QueryHeights(const glm::vec2* positionsXZ, float* heights, size_t count) const;
+  void QueryNormals(const glm::vec2* positionsXZ, glm::vec3* normals, size_t count) const;
+
+  // AVX2 gp邩(Ή CPU ł͏ɖ).
+  void SetUseSimd(bool useSimd) { m_useSimd = useSimd && IsAvx2Supported(); }
+  bool IsUsingSimd() const { return m_useSimd; }
+  static bool IsAvx2Supported();
+
+  // _Ȉʒuɑ΂鍂₢킹̏\(NG/b)v.
+  double MeasureHeightQueriesPerSecond(size_t count, int iterations) const;
+  double MeasureNormalQueriesPerSecond(size_t count, int iterations) const;
+
+private:
+  static const int TileShift = 3; // 8x8 eNZ̃^CŊi[.
+  static const int TileSize = 1 << TileShift;
+
+  size_t GetTiledIndex(int x, int y) const;
+  void QueryHeightsSimd(const glm::vec2* positionsXZ, float* heights, size_t count) const;
+  void QueryNormalsSimd(const glm::vec2* positionsXZ, glm::vec3* normals, size_t count) const;
+
+  int m_width;
+  int m_height;
+  int m_tilesX;
+  float m_terrainSize;
+  float m_heightScale;
+  bool m_useSimd;
+
+  // Să^Cɕׂ.
+  std::vector<float> m_heights; // 0..1
+  std::vector<float> m_octNormalX; // normalGenCS Ɠʑ̃GR[h.
+  std::vector<float> m_octNormalY;
+};
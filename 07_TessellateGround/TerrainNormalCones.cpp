@@ -0,0 +1,67 @@
+#include "TerrainNormalCones.h"
+#include <algorithm>
+#include <cmath>
+
+TerrainNormalCones::TerrainNormalCones()
+{
+}
+
+void TerrainNormalCones::Build(const std::vector<float>& heights, int width, int height, float terrainSize, float heightScale, int divide)
+{
+  auto fetch = [&](int x, int y) {
+    x = (std::min)((std::max)(x, 0), width - 1);
+    y = (std::min)((std::max)(y, 0), height - 1);
+    return heights[y * width + x];
+  };
+  float scaleX = heightScale * width / terrainSize;
+  float scaleZ = heightScale * height / terrainSize;
+
+  m_cones.resize(divide * divide);
+  for (int pz = 0; pz < divide; ++pz)
+  {
+    for (int px = 0; px < divide; ++px)
+    {
+      // pb` UV ͈͂oCjAԂŎQƂf͈̔.
+      int x0 = int(std::floor(float(px) / divide * width - 0.5f)) - FootprintMargin;
+      int x1 = int(std::floor(float(px + 1) / divide * width - 0.5f)) + 1 + FootprintMargin;
+      int z0 = int(std::floor(float(pz) / divide * height - 0.5f)) - FootprintMargin;
+      int z1 = int(std::floor(float(pz + 1) / divide * height - 0.5f)) + 1 + FootprintMargin;
+
+      // Ԃꂽʂ̌z͗אډf͈̍̔͂Ɏ܂.
+      glm::vec2 gradMin(1.0e30f), gradMax(-1.0e30f);
+      for (int z = z0; z <= z1; ++z)
+      {
+        for (int x = x0; x <= x1; ++x)
+        {
+          float h = fetch(x, z);
+          if (x < x1)
+          {
+            float gx = (fetch(x + 1, z) - h) * scaleX;
+            gradMin.x = (std::min)(gradMin.x, gx);
+            gradMax.x = (std::max)(gradMax.x, gx);
+          }
+          if (z < z1)
+          {
+            float gz = (fetch(x, z + 1) - h) * scaleZ;
+            gradMin.y = (std::min)(gradMin.y, gz);
+            gradMax.y = (std::max)(gradMax.y, gz);
+          }
+        }
+      }
+
+      // z͈̔͂̒SƂAl̖@܂ł̍ő̊px𔼒pƂ.
+      auto center = (gradMin + gradMax) * 0.5f;
+      auto axis = glm::normalize(glm::vec3(-center.x, 1.0f, -center.y));
+      float halfAngle = 0.0f;
+      for (int i = 0; i < 4; ++i)
+      {
+        float gx = (i & 1) ? gradMax.x : gradMin.x;
+        float gz = (i & 2) ? gradMax.y : gradMin.y;
+        auto n = glm::normalize(glm::vec3(-gx, 1.0f, -gz));
+        float c = glm::clamp(glm::dot(axis, n), -1.0f, 1.0f);
+        halfAngle = (std::max)(halfAngle, std::acos(c));
+      }
+      m_cones[pz * divide + px] = glm::vec4(axis, halfAngle);
+    }
+  }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+// pb`̖@R[(SĂ̖ʂ̖@܂މ~)OvZ.
+// oCjAԂꂽ̌z̓pb`̍̍ŏ/őlň͂߂邽߁A
+// ̎l̖@܂ރR[́Apb`𕪊Op`̖@SĊ܂.
+class TerrainNormalCones
+{
+public:
+  // T(^C 8x8 f 1 fɏk)̓pb`̊Ỏfς邽߁A͈̔͂܂Ŋ܂߂.
+  static const int FootprintMargin = 16;
+
+  TerrainNormalCones();
+
+  // heights  0..1, pb` divide x divide  (TessellateGroundApp::PreparePrimitiveResource Ɠ).
+  void Build(const std::vector<float>& heights, int width, int height, float terrainSize, float heightScale, int divide);
+
+  // xyz:(Kς), w:p(WA).
+  const glm::vec4& GetCone(int patchIndex) const { return m_cones[patchIndex]; }
+  const std::vector<glm::vec4>& GetCones() const { return m_cones; }
+  bool IsValid() const { return !m_cones.empty(); }
+
+private:
+  std::vector<glm::vec4> m_cones;
+};
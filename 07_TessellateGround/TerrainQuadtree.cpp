@@ -0,0 +1,137 @@
+#include "TerrainQuadtree.h"
+#include "TerrainHeightBounds.h"
+#include "FrustumPlanes.h"
+#include <algorithm>
+
+TerrainQuadtree::TerrainQuadtree()
+  : m_terrainSize(0.0f), m_heightScale(0.0f), m_lodLevels(0), m_heightBounds(nullptr)
+{
+}
+
+void TerrainQuadtree::Setup(float terrainSize, float heightScale, int lodLevels, float lod0Range)
+{
+  m_terrainSize = terrainSize;
+  m_heightScale = heightScale;
+  m_lodLevels = (std::min)(lodLevels, int(MaxLodLevels));
+
+  // ex̒S 1 iƂɔ{ɂ.
+  m_lodRanges.resize(m_lodLevels);
+  float range = lod0Range;
+  for (int i = 0; i < m_lodLevels; ++i)
+  {
+    m_lodRanges[i] = range;
+    range *= 2.0f;
+  }
+  // ŏʃm[h͒n`ŜK܂ނ悤ɂ.
+  auto& topRange = m_lodRanges[m_lodLevels - 1];
+  topRange = (std::max)(topRange, terrainSize * 2.0f + heightScale);
+}
+
+glm::vec2 TerrainQuadtree::GetMorphRange(int lod) const
+{
+  const float morphStartRatio = 0.7f;
+  float prev = lod > 0 ? m_lodRanges[lod - 1] : 0.0f;
+  float end = m_lodRanges[lod];
+  float start = prev + (end - prev) * morphStartRatio;
+  return glm::vec2(start, end);
+}
+
+void TerrainQuadtree::Select(const glm::vec3& cameraPos, const glm::vec4 frustumPlanes[6], std::vector<NodeInstance>& selected) const
+{
+  selected.clear();
+  if (m_lodLevels == 0)
+  {
+    return;
+  }
+  auto origin = glm::vec2(-m_terrainSize * 0.5f);
+  SelectNode(origin, m_terrainSize, m_lodLevels - 1, cameraPos, frustumPlanes, selected);
+}
+
+bool TerrainQuadtree::SelectNode(const glm::vec2& origin, float size, int lod, const glm::vec3& cameraPos, const glm::vec4 frustumPlanes[6], std::vector<NodeInstance>& selected) const
+{
+  glm::vec3 bmin, bmax;
+  GetNodeBounds(origin, size, bmin, bmax);
+
+  // S̊Ołΐem[hɔC.
+  if (!IntersectSphere(bmin, bmax, cameraPos, m_lodRanges[lod]))
+  {
+    return false;
+  }
+  // Ȃm[h͑Iς݈ƂĉǉȂ.
+  if (IsOutsideFrustum(bmin, bmax, frustumPlanes))
+  {
+    return true;
+  }
+  if (lod == 0 || !IntersectSphere(bmin, bmax, cameraPos, m_lodRanges[lod - 1]))
+  {
+    selected.push_back({ glm::vec4(origin, size, float(lod)) });
+    return true;
+  }
+
+  float half = size * 0.5f;
+  glm::vec2 childOrigins[] = {
+    origin,
+    origin + glm::vec2(half, 0.0f),
+    origin + glm::vec2(0.0f, half),
+    origin + glm::vec2(half, half),
+  };
+  for (const auto& childOrigin : childOrigins)
+  {
+    if (!SelectNode(childOrigin, half, lod - 1, cameraPos, frustumPlanes, selected))
+    {
+      // q̒SÖ̗͂̃x̖xŕ`.
+      // ̃TCYœiqg߁A1 ĩ[tԂŊSɃ[t.
+      glm::vec3 childMin, childMax;
+      GetNodeBounds(childOrigin, half, childMin, childMax);
+      if (!IsOutsideFrustum(childMin, childMax, frustumPlanes))
+      {
+        selected.push_back({ glm::vec4(childOrigin, half, float(lod - 1)) });
+      }
+    }
+  }
+  return true;
+}
+
+void TerrainQuadtree::GetNodeBounds(const glm::vec2& origin, float size, glm::vec3& bmin, glm::vec3& bmax) const
+{
+  auto heights = glm::vec2(0.0f, 1.0f);
+  if (m_heightBounds)
+  {
+    auto uvMin = origin / m_terrainSize + 0.5f;
+    auto uvMax = (origin + size) / m_terrainSize + 0.5f;
+    heights = m_heightBounds->Query(uvMin, uvMax);
+  }
+  bmin = glm::vec3(origin.x, heights.x * m_heightScale, origin.y);
+  bmax = glm::vec3(origin.x + size, heights.y * m_heightScale, origin.y + size);
+}
+
+bool TerrainQuadtree::IntersectSphere(const glm::vec3& bmin, const glm::vec3& bmax, const glm::vec3& center, float radius)
+{
+  auto nearest = glm::clamp(center, bmin, bmax);
+  auto d = nearest - center;
+  return glm::dot(d, d) <= radius * radius;
+}
+
+bool TerrainQuadtree::IsOutsideFrustum(const glm::vec3& bmin, const glm::vec3& bmax, const glm::vec4 frustumPlanes[6])
+{
+  for (int i = 0; i < 6; ++i)
+  {
+    const auto& plane = frustumPlanes[i];
+    auto p = glm::vec3(
+      plane.x >= 0.0f ? bmax.x : bmin.x,
+      plane.y >= 0.0f ? bmax.y : bmin.y,
+      plane.z >= 0.0f ? bmax.z : bmin.z
+    );
+    if (glm::dot(glm::vec3(plane), p) + plane.w < 0.0f)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void TerrainQuadtree::CalcFrustumPlanes(const glm::mat4& viewProj, glm::vec4 planes[6])
+{
+  // n`̎ˉes͐[x 0..1 ͈̔.
+  FrustumPlanes::Calc(viewProj, planes, true);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+class TerrainHeightBounds;
+
+// CDLOD ̎l؂ŕ`悷n`m[hI.
+class TerrainQuadtree
+{
+public:
+  static const int MaxLodLevels = 8;
+
+  struct NodeInstance
+  {
+    glm::vec4 Node; // xy: m[h_(XZ), z: ӂ̒, w: [tɎg LOD x.
+  };
+
+  TerrainQuadtree();
+
+  // terrainSize ̐`(_S) lodLevels i̎l؂ŕ.
+  void Setup(float terrainSize, float heightScale, int lodLevels, float lod0Range);
+
+  // m[h͈̍̔͂ŏ/őls~bh狁߂(ݒȂ 0..XP[).
+  void SetHeightBounds(const TerrainHeightBounds* heightBounds) { m_heightBounds = heightBounds; }
+
+  // JʒuƎ䂩`悷m[hI.
+  void Select(const glm::vec3& cameraPos, const glm::vec4 frustumPlanes[6], std::vector<NodeInstance>& selected) const;
+
+  int GetLodLevels() const { return m_lodLevels; }
+  float GetTerrainSize() const { return m_terrainSize; }
+  float GetHeightScale() const { return m_heightScale; }
+
+  // r[EvWFNVs񂩂王 6 ʂ߂.
+  static void CalcFrustumPlanes(const glm::mat4& viewProj, glm::vec4 planes[6]);
+
+  // LOD ̃[t(Jn, I).
+  glm::vec2 GetMorphRange(int lod) const;
+
+private:
+  bool SelectNode(const glm::vec2& origin, float size, int lod, const glm::vec3& cameraPos, const glm::vec4 frustumPlanes[6], std::vector<NodeInstance>& selected) const;
+
+  void GetNodeBounds(const glm::vec2& origin, float size, glm::vec3& bmin, glm::vec3& bmax) const;
+
+  static bool IntersectSphere(const glm::vec3& bmin, const glm::vec3& bmax, const glm::vec3& center, float radius);
+  static bool IsOutsideFrustum(const glm::vec3& bmin, const glm::vec3& bmax, const glm::vec4 frustumPlanes[6]);
+
+  float m_terrainSize;
+  float m_heightScale;
+  int m_lodLevels;
+  std::vector<float> m_lodRanges;
+  const TerrainHeightBounds* m_heightBounds;
+};
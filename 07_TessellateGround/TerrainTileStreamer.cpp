@@ -0,0 +1,380 @@
+#include "TerrainTileStreamer.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <Windows.h>
+
+#include "stb_image.h"
+
+namespace
+{
+  const uint32_t TileMagic = 0x4C495454; // 'TTIL'
+  const uint32_t TileVersion = 3; // 2: @𔪖ʑ̃GR[hŕێ, 3: Tςǉ.
+  const char* InfoFileName = "terrain.info";
+
+  float SignNotZero(float v)
+  {
+    return v >= 0.0f ? 1.0f : -1.0f;
+  }
+
+  // normalGenCS.comp Ɠʑ̃GR[h(Y ).
+  glm::vec2 EncodeOctNormal(glm::vec3 n)
+  {
+    n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    auto e = glm::vec2(n.x, n.z);
+    if (n.y < 0.0f)
+    {
+      e = glm::vec2((1.0f - std::abs(e.y)) * SignNotZero(e.x), (1.0f - std::abs(e.x)) * SignNotZero(e.y));
+    }
+    return e;
+  }
+
+  glm::vec3 DecodeOctNormal(const glm::vec2& e)
+  {
+    auto n = glm::vec3(e.x, 1.0f - std::abs(e.x) - std::abs(e.y), e.y);
+    if (n.y < 0.0f)
+    {
+      auto x = (1.0f - std::abs(n.z)) * SignNotZero(n.x);
+      auto z = (1.0f - std::abs(n.x)) * SignNotZero(n.z);
+      n.x = x;
+      n.z = z;
+    }
+    return glm::normalize(n);
+  }
+}
+
+TerrainTileStreamer::TerrainTileStreamer()
+  : m_header(), m_streamRadius(2), m_isQuit(false)
+{
+}
+
+TerrainTileStreamer::~TerrainTileStreamer()
+{
+  Close();
+}
+
+std::string TerrainTileStreamer::GetTileFileName(const std::string& dir, int tileX, int tileY)
+{
+  std::stringstream ss;
+  ss << dir << "/tile_" << tileX << "_" << tileY << ".bin";
+  return ss.str();
+}
+
+std::string TerrainTileStreamer::GetTileFileName(int tileIndex) const
+{
+  int tilesX = int(m_header.tilesX);
+  return GetTileFileName(m_directory, tileIndex % tilesX, tileIndex / tilesX);
+}
+
+bool TerrainTileStreamer::BuildTiles(const char* heightFile, const std::vector<uint32_t>& packedNormals, const char* outDir, int tileSize)
+{
+  int width, height;
+  stbi_uc* heightImage = stbi_load(heightFile, &width, &height, nullptr, 4);
+  if (heightImage == nullptr || packedNormals.size() != size_t(width * height))
+  {
+    stbi_image_free(heightImage);
+    return false;
+  }
+  auto normalImage = reinterpret_cast<const uint8_t*>(packedNormals.data());
+  CreateDirectoryA(outDir, nullptr);
+
+  TileFileHeader header{};
+  header.magic = TileMagic;
+  header.version = TileVersion;
+  header.tilesX = uint32_t((width + tileSize - 1) / tileSize);
+  header.tilesY = uint32_t((height + tileSize - 1) / tileSize);
+  header.tileSize = uint32_t(tileSize);
+
+  // E܂߂Đ؂oA[͍ŊỎfŖ߂.
+  const int imageSize = tileSize + TileBorder * 2;
+  std::vector<uint8_t> heightTile(imageSize * imageSize * 4), normalTile(imageSize * imageSize * 4);
+  for (int ty = 0; ty < int(header.tilesY); ++ty)
+  {
+    for (int tx = 0; tx < int(header.tilesX); ++tx)
+    {
+      for (int y = 0; y < imageSize; ++y)
+      {
+        int sy = (std::min)((std::max)(ty * tileSize + y - TileBorder, 0), height - 1);
+        for (int x = 0; x < imageSize; ++x)
+        {
+          int sx = (std::min)((std::max)(tx * tileSize + x - TileBorder, 0), width - 1);
+          auto src = (sy * width + sx) * 4;
+          auto dst = (y * imageSize + x) * 4;
+          std::copy(heightImage + src, heightImage + src + 4, heightTile.begin() + dst);
+          std::copy(normalImage + src, normalImage + src + 4, normalTile.begin() + dst);
+        }
+      }
+      std::ofstream outfile(GetTileFileName(outDir, tx, ty), std::ios::binary);
+      outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      outfile.write(reinterpret_cast<const char*>(heightTile.data()), heightTile.size());
+      outfile.write(reinterpret_cast<const char*>(normalTile.data()), normalTile.size());
+    }
+  }
+
+  // Tς̓^C 1  OverviewTexelsPerTile^2 f֕ςďk.
+  const int overviewWidth = int(header.tilesX) * OverviewTexelsPerTile;
+  const int overviewHeight = int(header.tilesY) * OverviewTexelsPerTile;
+  const int step = (std::max)(tileSize / OverviewTexelsPerTile, 1);
+  std::vector<uint8_t> overviewHeights(overviewWidth * overviewHeight * 4);
+  std::vector<uint32_t> overviewNormals(overviewWidth * overviewHeight);
+  for (int oy = 0; oy < overviewHeight; ++oy)
+  {
+    for (int ox = 0; ox < overviewWidth; ++ox)
+    {
+      float heightSum = 0.0f;
+      glm::vec3 normalSum(0.0f);
+      for (int y = 0; y < step; ++y)
+      {
+        int sy = (std::min)(oy * step + y, height - 1);
+        for (int x = 0; x < step; ++x)
+        {
+          int sx = (std::min)(ox * step + x, width - 1);
+          heightSum += heightImage[(sy * width + sx) * 4];
+          normalSum += DecodeOctNormal(glm::unpackHalf2x16(packedNormals[sy * width + sx]));
+        }
+      }
+      auto index = oy * overviewWidth + ox;
+      auto h = uint8_t(std::round(heightSum / (step * step)));
+      overviewHeights[index * 4 + 0] = h;
+      overviewHeights[index * 4 + 1] = h;
+      overviewHeights[index * 4 + 2] = h;
+      overviewHeights[index * 4 + 3] = 255;
+      overviewNormals[index] = glm::packHalf2x16(EncodeOctNormal(glm::normalize(normalSum)));
+    }
+  }
+
+  std::ofstream infoFile(std::string(outDir) + "/" + InfoFileName, std::ios::binary);
+  infoFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  infoFile.write(reinterpret_cast<const char*>(overviewHeights.data()), overviewHeights.size());
+  infoFile.write(reinterpret_cast<const char*>(overviewNormals.data()), overviewNormals.size() * sizeof(uint32_t));
+
+  stbi_image_free(heightImage);
+  return true;
+}
+
+bool TerrainTileStreamer::Open(const char* dir, int slotCount, int threadCount)
+{
+  Close();
+
+  m_directory = dir;
+  std::ifstream infile(m_directory + "/" + InfoFileName, std::ios::binary);
+  if (!infile || !infile.read(reinterpret_cast<char*>(&m_header), sizeof(m_header)) ||
+    m_header.magic != TileMagic || m_header.version != TileVersion)
+  {
+    m_header = TileFileHeader();
+    return false;
+  }
+  auto overviewBytes = size_t(GetOverviewWidth() * GetOverviewHeight() * 4);
+  m_overviewHeight.resize(overviewBytes);
+  m_overviewNormal.resize(overviewBytes);
+  infile.read(reinterpret_cast<char*>(m_overviewHeight.data()), overviewBytes);
+  infile.read(reinterpret_cast<char*>(m_overviewNormal.data()), overviewBytes);
+  if (!infile)
+  {
+    m_header = TileFileHeader();
+    return false;
+  }
+
+  auto tileCount = m_header.tilesX * m_header.tilesY;
+  m_slots.assign(slotCount, Slot{ -1, 0 });
+  m_indirection.assign(tileCount, -1);
+  m_tileLastWanted.assign(tileCount, 0);
+  m_tileStates.assign(tileCount, TileState_Unloaded);
+
+  m_isQuit = false;
+  for (int i = 0; i < threadCount; ++i)
+  {
+    m_workers.emplace_back(&TerrainTileStreamer::WorkerMain, this);
+  }
+  return true;
+}
+
+void TerrainTileStreamer::Close()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_isQuit = true;
+    m_requests.clear();
+  }
+  m_cv.notify_all();
+  for (auto& t : m_workers)
+  {
+    t.join();
+  }
+  m_workers.clear();
+  m_loaded.clear();
+}
+
+bool TerrainTileStreamer::LoadTile(int tileIndex, TileUpload& tile) const
+{
+  std::ifstream infile(GetTileFileName(tileIndex), std::ios::binary);
+  TileFileHeader header;
+  if (!infile || !infile.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != TileMagic)
+  {
+    return false;
+  }
+  auto imageSize = GetTileImageSize();
+  auto bytes = size_t(imageSize * imageSize * 4);
+  tile.tileIndex = tileIndex;
+  tile.slot = -1;
+  tile.height.resize(bytes);
+  tile.normal.resize(bytes);
+  infile.read(reinterpret_cast<char*>(tile.height.data()), bytes);
+  infile.read(reinterpret_cast<char*>(tile.normal.data()), bytes);
+  return bool(infile);
+}
+
+void TerrainTileStreamer::WorkerMain()
+{
+  for (;;)
+  {
+    int tileIndex = -1;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [&] { return m_isQuit || !m_requests.empty(); });
+      if (m_isQuit)
+      {
+        return;
+      }
+      tileIndex = m_requests.front();
+      m_requests.pop_front();
+    }
+
+    // t@Cǂݍ݂̓bN̊Oōs.
+    TileUpload tile;
+    bool isLoaded = LoadTile(tileIndex, tile);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (isLoaded && m_tileStates[tileIndex] == TileState_Pending)
+    {
+      m_tileStates[tileIndex] = TileState_Loaded;
+      m_loaded.push_back(std::move(tile));
+    }
+    else if (m_tileStates[tileIndex] == TileState_Pending)
+    {
+      m_tileStates[tileIndex] = TileState_Unloaded;
+    }
+  }
+}
+
+int TerrainTileStreamer::AcquireSlot(uint64_t frame)
+{
+  // 󂫃XbgȂ΁Ãt[ŎgĂȂłÂXbgǂo.
+  int found = -1;
+  for (int i = 0; i < int(m_slots.size()); ++i)
+  {
+    const auto& slot = m_slots[i];
+    if (slot.tileIndex < 0)
+    {
+      return i;
+    }
+    if (slot.lastUsedFrame < frame && (found < 0 || slot.lastUsedFrame < m_slots[found].lastUsedFrame))
+    {
+      found = i;
+    }
+  }
+  if (found >= 0)
+  {
+    auto evicted = m_slots[found].tileIndex;
+    m_indirection[evicted] = -1;
+    m_tileStates[evicted] = TileState_Unloaded;
+    m_slots[found].tileIndex = -1;
+  }
+  return found;
+}
+
+void TerrainTileStreamer::Update(const glm::vec3& cameraPos, float terrainSize, uint64_t frame, int maxUploads, std::vector<TileUpload>& uploads)
+{
+  uploads.clear();
+  if (m_header.tilesX == 0)
+  {
+    return;
+  }
+  int tilesX = int(m_header.tilesX), tilesY = int(m_header.tilesY);
+
+  // n`͌_SɔzuĂ.
+  float u = cameraPos.x / terrainSize + 0.5f;
+  float v = cameraPos.z / terrainSize + 0.5f;
+  int centerX = int(std::floor(u * tilesX));
+  int centerY = int(std::floor(v * tilesY));
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (int y = centerY - m_streamRadius; y <= centerY + m_streamRadius; ++y)
+  {
+    for (int x = centerX - m_streamRadius; x <= centerX + m_streamRadius; ++x)
+    {
+      if (x < 0 || y < 0 || x >= tilesX || y >= tilesY)
+      {
+        continue;
+      }
+      int index = y * tilesX + x;
+      m_tileLastWanted[index] = frame;
+      if (m_tileStates[index] == TileState_Unloaded)
+      {
+        m_tileStates[index] = TileState_Pending;
+        m_requests.push_back(index);
+      }
+      else if (m_tileStates[index] == TileState_Resident)
+      {
+        m_slots[m_indirection[index]].lastUsedFrame = frame;
+      }
+    }
+  }
+
+  // ͈͊Oɏo^C̗v͎.
+  for (auto itr = m_requests.begin(); itr != m_requests.end(); )
+  {
+    if (m_tileLastWanted[*itr] != frame)
+    {
+      m_tileStates[*itr] = TileState_Unloaded;
+      itr = m_requests.erase(itr);
+    }
+    else
+    {
+      ++itr;
+    }
+  }
+  m_cv.notify_all();
+
+  // ǂݍݍς݂̃^CXbg֊蓖Ă.
+  while (!m_loaded.empty() && int(uploads.size()) < maxUploads)
+  {
+    auto tile = std::move(m_loaded.front());
+    m_loaded.pop_front();
+    if (m_tileLastWanted[tile.tileIndex] != frame)
+    {
+      m_tileStates[tile.tileIndex] = TileState_Unloaded;
+      continue;
+    }
+    int slot = AcquireSlot(frame);
+    if (slot < 0)
+    {
+      // SXbggpȂ̂Ŏ̃t[ōĎs.
+      m_loaded.push_front(std::move(tile));
+      break;
+    }
+    m_slots[slot].tileIndex = tile.tileIndex;
+    m_slots[slot].lastUsedFrame = frame;
+    m_indirection[tile.tileIndex] = slot;
+    m_tileStates[tile.tileIndex] = TileState_Resident;
+    tile.slot = slot;
+    uploads.push_back(std::move(tile));
+  }
+}
+
+int TerrainTileStreamer::GetResidentCount() const
+{
+  int count = 0;
+  for (const auto& slot : m_slots)
+  {
+    count += slot.tileIndex >= 0 ? 1 : 0;
+  }
+  return count;
+}
+
+int TerrainTileStreamer::GetPendingCount() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return int(m_requests.size() + m_loaded.size());
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+// n`̃nCg}bv/@}bv^CPʂŃXg[~O.
+// ^C̓ǂݍ݂̓obNOEhXbhōsAGPU ͌Œ萔̃Xbg(eNX`z) LRU Ŏg.
+class TerrainTileStreamer
+{
+public:
+  static const int TileBorder = 1; // tB^Opɗאڃ^C̉f܂߂镝.
+  static const int OverviewTexelsPerTile = 8; // T(풓^C̑ɎQƂk摜)̃^C 1 ̉f.
+
+  struct TileFileHeader
+  {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t tilesX;
+    uint32_t tilesY;
+    uint32_t tileSize; // E܂܂Ȃ 1 ӂ̉f.
+  };
+
+  struct TileUpload
+  {
+    int slot;
+    int tileIndex;
+    std::vector<uint8_t> height; // RGBA8, (tileSize + 2*TileBorder)^2
+    std::vector<uint8_t> normal; // ʑ̃GR[h(RG16F, normalGenCS ̏o͂Ɠ), (tileSize + 2*TileBorder)^2
+  };
+
+  TerrainTileStreamer();
+  ~TerrainTileStreamer();
+
+  // nCg}bvƁA琶@(packHalf2x16 Ŕʑ̃GR[hς)^Ct@CQ쐬.
+  static bool BuildTiles(const char* heightFile, const std::vector<uint32_t>& packedNormals, const char* outDir, int tileSize);
+
+  bool Open(const char* dir, int slotCount, int threadCount);
+  void Close();
+
+  // Jӂ̃^CvAǂݍ݂^CXbg֊蓖Ă.
+  void Update(const glm::vec3& cameraPos, float terrainSize, uint64_t frame, int maxUploads, std::vector<TileUpload>& uploads);
+
+  // ^C̃Xbgԍ(풓 -1).
+  const std::vector<int32_t>& GetIndirection() const { return m_indirection; }
+
+  int GetTilesX() const { return int(m_header.tilesX); }
+  int GetTilesY() const { return int(m_header.tilesY); }
+  int GetTileSize() const { return int(m_header.tileSize); }
+  int GetTileImageSize() const { return int(m_header.tileSize) + TileBorder * 2; }
+  int GetSlotCount() const { return int(m_slots.size()); }
+
+  // ŜkT. `̓^CƓ( RGBA8, @͔ʑ̃GR[h).
+  int GetOverviewWidth() const { return int(m_header.tilesX) * OverviewTexelsPerTile; }
+  int GetOverviewHeight() const { return int(m_header.tilesY) * OverviewTexelsPerTile; }
+  const std::vector<uint8_t>& GetOverviewHeightData() const { return m_overviewHeight; }
+  const std::vector<uint8_t>& GetOverviewNormalData() const { return m_overviewNormal; }
+  int GetResidentCount() const;
+  int GetPendingCount() const;
+
+  void SetStreamRadius(int radius) { m_streamRadius = radius; }
+  int GetStreamRadius() const { return m_streamRadius; }
+
+private:
+  enum TileState
+  {
+    TileState_Unloaded,
+    TileState_Pending,
+    TileState_Loaded,
+    TileState_Resident,
+  };
+  struct Slot
+  {
+    int tileIndex;
+    uint64_t lastUsedFrame;
+  };
+
+  void WorkerMain();
+  bool LoadTile(int tileIndex, TileUpload& tile) const;
+  std::string GetTileFileName(int tileIndex) const;
+  static std::string GetTileFileName(const std::string& dir, int tileX, int tileY);
+  int AcquireSlot(uint64_t frame);
+
+  std::string m_directory;
+  TileFileHeader m_header;
+  int m_streamRadius;
+
+  std::vector<Slot> m_slots;
+  std::vector<int32_t> m_indirection;
+  std::vector<uint64_t> m_tileLastWanted;
+  std::vector<uint8_t> m_overviewHeight;
+  std::vector<uint8_t> m_overviewNormal;
+
+  // ȉ m_mutex ŕی삷.
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::vector<TileState> m_tileStates;
+  std::deque<int> m_requests;
+  std::deque<TileUpload> m_loaded;
+  bool m_isQuit;
+
+  std::vector<std::thread> m_workers;
+};
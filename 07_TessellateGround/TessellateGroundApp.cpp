@@ -3,10 +3,12 @@
 
 
 #include <array>
+#include <algorithm>
 
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "stb_image.h"
+#include "QuadDomainTessellator.h"
 
 #include "imgui.h"
 #include "examples/imgui_impl_vulkan.h"
@@ -21,6 +23,36 @@ TessellateGroundApp::TessellateGroundApp()
     glm::vec3(0.0f, 0.0f, 0.0f)
   );
   m_isWireframe = true;
+  m_isFrustumCulling = true;
+  m_isBackfaceCulling = true;
+  m_lastCullStats = { };
+  m_isVertexPipelineStoresSupported = false;
+  m_tessFactorMode = TessFactorMode_Distance;
+  m_targetEdgePixels = 8.0f;
+  m_lastEstimate = { };
+  m_isTessEstimatorReady = false;
+  m_isRecordingCameraPath = false;
+  m_terrainMode = TerrainMode_Tessellation;
+  m_cdlodInstanceCount = 0;
+  m_isTileStreaming = true;
+  m_isTileDataReady = false;
+  m_frameCount = 0;
+  m_lastTileUploads = 0;
+  m_isTessCacheEnabled = false;
+  m_isTessCacheValid = false;
+  m_isTessCacheOverflowed = false;
+  m_tessCacheState = TessCacheState_Live;
+  m_tessCacheDistance = 1.0f;
+  m_tessCacheKey = { };
+  m_tessCachePrevView = glm::mat4(1.0f);
+  m_tessCacheCaptureFence = VK_NULL_HANDLE;
+  m_tessCaptureFramebuffer = VK_NULL_HANDLE;
+  m_tessCapturePipeline = VK_NULL_HANDLE;
+  m_tessCachePipeline = VK_NULL_HANDLE;
+  m_tessCacheWired = VK_NULL_HANDLE;
+  m_tessCacheVertexCount = 0;
+  m_tessCacheCapacity = 0;
+  m_tessCacheOverflowTriangles = 0;
 }
 
 void TessellateGroundApp::Prepare()
@@ -46,29 +78,112 @@ void TessellateGroundApp::Prepare()
     c.commandBuffer = CreateCommandBuffer(false); // R}hobt@JnԂɂȂ.
   }
 
+  // JȌWvƃebZ[Vʂ̏o͂̋@\Kv.
+  VkPhysicalDeviceFeatures features{};
+  vkGetPhysicalDeviceFeatures(m_physicalDevice, &features);
+  m_isVertexPipelineStoresSupported = features.vertexPipelineStoresAndAtomics == VK_TRUE;
+
   PrepareSceneResource();
+  PrepareHeightBounds();
+  BuildHeightBounds();
+  PrepareNormalCones();
+  PrepareNormalMap();
+  BuildNormalMap();
+  PrepareTileStreaming();
+  ReleaseSourceMaps();
 
   PreparePrimitiveResource();
+  PrepareTessCache();
+  PrepareCdlodResource();
+
+  m_isTessEstimatorReady = m_tessEstimator.Setup("heightmap.png", 200.0f, 25.0f, 10);
 }
 
 void TessellateGroundApp::Cleanup()
 {
   vkDestroyPipeline(m_device, m_tessGroundPipeline, nullptr);
   vkDestroyPipeline(m_device, m_tessGroundWired, nullptr);
+  vkDestroyPipeline(m_device, m_tessCapturePipeline, nullptr);
+  vkDestroyPipeline(m_device, m_tessCachePipeline, nullptr);
+  vkDestroyPipeline(m_device, m_tessCacheWired, nullptr);
+  DestroyFramebuffers(1, &m_tessCaptureFramebuffer);
+  DestroyBuffer(m_tessCache);
+  DestroyBuffer(m_tessCacheReadback);
+  vkDestroyPipeline(m_device, m_cdlodPipeline, nullptr);
+  vkDestroyPipeline(m_device, m_cdlodWired, nullptr);
   vkDestroySampler(m_device, m_texSampler, nullptr);
 
   DestroyImage(m_normalMap);
   DestroyImage(m_heightMap);
+  DestroyImage(m_overviewHeightMap);
+  DestroyImage(m_overviewNormalMap);
+
+  vkDestroyPipeline(m_device, m_normalGenPipeline, nullptr);
+  DeallocateDescriptorSet(m_dsNormalGen);
+  DestroyBuffer(m_normalGenUniform);
+  DestroyBuffer(m_packedNormals);
+
+  vkDestroyPipeline(m_device, m_heightBoundsInitPipeline, nullptr);
+  vkDestroyPipeline(m_device, m_heightBoundsReducePipeline, nullptr);
+  for (auto& ds : m_dsHeightBounds)
+  {
+    DeallocateDescriptorSet(ds);
+  }
+  m_dsHeightBounds.clear();
+  for (auto& view : m_heightBoundsLevelViews)
+  {
+    vkDestroyImageView(m_device, view, nullptr);
+  }
+  m_heightBoundsLevelViews.clear();
+  DestroyImage(m_heightBoundsImage);
+  DestroyBuffer(m_normalCones);
+
+  m_tileStreamer.Close();
+  DestroyImage(m_tileHeightArray);
+  DestroyImage(m_tileNormalArray);
+  for (auto& buffer : m_tileStaging)
+  {
+    DestroyBuffer(buffer);
+  }
+  m_tileStaging.clear();
+  for (auto& buffer : m_tileIndirection)
+  {
+    DestroyBuffer(buffer);
+  }
+  m_tileIndirection.clear();
 
   for (auto& ubo : m_tessUniform)
   {
     DestroyBuffer(ubo);
   }
   m_tessUniform.clear();
+  for (auto& buffer : m_cullStatistics)
+  {
+    DestroyBuffer(buffer);
+  }
+  m_cullStatistics.clear();
 
   DestroyBuffer(m_quad.resVertexBuffer);
   DestroyBuffer(m_quad.resIndexBuffer);
 
+  DestroyBuffer(m_cdlodGrid.resVertexBuffer);
+  DestroyBuffer(m_cdlodGrid.resIndexBuffer);
+  for (auto& buffer : m_cdlodInstances)
+  {
+    DestroyBuffer(buffer);
+  }
+  m_cdlodInstances.clear();
+  for (auto& ubo : m_cdlodUniform)
+  {
+    DestroyBuffer(ubo);
+  }
+  m_cdlodUniform.clear();
+  for (auto& ds : m_dsCdlod)
+  {
+    DeallocateDescriptorSet(ds);
+  }
+  m_dsCdlod.clear();
+
   DestroyImage(m_depthBuffer);
   auto count = uint32_t(m_framebuffers.size());
   DestroyFramebuffers(count, m_framebuffers.data());
@@ -143,6 +258,25 @@ void TessellateGroundApp::CreateSampleLayouts()
   ThrowIfFailed(result, "vkCreateDescriptorSetLayout Failed.");
   RegisterLayout("u1t2", dsLayout);
 
+  // 0: uniformBuffer, 1,2,4,5,7: texture(+sampler), 3,6,8,9: storageBuffer gpVF[_[pCAEg.
+  dsLayoutBindings = {
+    { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_ALL, },
+    { 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_ALL },
+    { 2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_ALL },
+    { 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL },
+    { 4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_ALL },
+    { 5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_ALL },
+    { 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL },
+    { 7, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_ALL },
+    { 8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL },
+    { 9, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_ALL },
+  };
+  dsLayoutCI.bindingCount = uint32_t(dsLayoutBindings.size());
+  dsLayoutCI.pBindings = dsLayoutBindings.data();
+  result = vkCreateDescriptorSetLayout(m_device, &dsLayoutCI, nullptr, &dsLayout);
+  ThrowIfFailed(result, "vkCreateDescriptorSetLayout Failed.");
+  RegisterLayout("u1t5s4", dsLayout);
+
   // 0: uniformBuffer, 1: uniformBuffer gpVF[_[pCAEg.
   dsLayoutBindings = {
     { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_ALL, },
@@ -163,6 +297,30 @@ void TessellateGroundApp::CreateSampleLayouts()
   ThrowIfFailed(result, "vkCreateDescriptorSetLayout Failed.");
   RegisterLayout("u1", dsLayout);
 
+  // ŏ/őls~bh쐬p. 0: nCg}bv, 1: QƂ郌x, 2: ރx.
+  dsLayoutBindings = {
+    { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT },
+    { 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT },
+    { 2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT },
+  };
+  dsLayoutCI.bindingCount = uint32_t(dsLayoutBindings.size());
+  dsLayoutCI.pBindings = dsLayoutBindings.data();
+  result = vkCreateDescriptorSetLayout(m_device, &dsLayoutCI, nullptr, &dsLayout);
+  ThrowIfFailed(result, "vkCreateDescriptorSetLayout Failed.");
+  RegisterLayout("compute_height_bounds", dsLayout);
+
+  // @}bvp. 0: nCg}bv, 1: o͐, 2: p[^.
+  dsLayoutBindings = {
+    { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT },
+    { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT },
+    { 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT },
+  };
+  dsLayoutCI.bindingCount = uint32_t(dsLayoutBindings.size());
+  dsLayoutCI.pBindings = dsLayoutBindings.data();
+  result = vkCreateDescriptorSetLayout(m_device, &dsLayoutCI, nullptr, &dsLayout);
+  ThrowIfFailed(result, "vkCreateDescriptorSetLayout Failed.");
+  RegisterLayout("compute_normal_gen", dsLayout);
+
   // pCvCCAEg̏
   VkPipelineLayoutCreateInfo layoutCI{
     VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
@@ -186,6 +344,13 @@ void TessellateGroundApp::CreateSampleLayouts()
   ThrowIfFailed(result, "vkCreatePipelineLayout Failed.");
   RegisterLayout("u1t2", layout);
 
+  dsLayout = GetDescriptorSetLayout("u1t5s4");
+  layoutCI.setLayoutCount = 1;
+  layoutCI.pSetLayouts = &dsLayout;
+  result = vkCreatePipelineLayout(m_device, &layoutCI, nullptr, &layout);
+  ThrowIfFailed(result, "vkCreatePipelineLayout Failed.");
+  RegisterLayout("u1t5s4", layout);
+
   dsLayout = GetDescriptorSetLayout("u2");
   layoutCI.setLayoutCount = 1;
   layoutCI.pSetLayouts = &dsLayout;
@@ -199,6 +364,20 @@ void TessellateGroundApp::CreateSampleLayouts()
   result = vkCreatePipelineLayout(m_device, &layoutCI, nullptr, &layout);
   ThrowIfFailed(result, "vkCreatePipelineLayout Failed.");
   RegisterLayout("u1", layout);
+
+  dsLayout = GetDescriptorSetLayout("compute_height_bounds");
+  layoutCI.setLayoutCount = 1;
+  layoutCI.pSetLayouts = &dsLayout;
+  result = vkCreatePipelineLayout(m_device, &layoutCI, nullptr, &layout);
+  ThrowIfFailed(result, "vkCreatePipelineLayout Failed.");
+  RegisterLayout("compute_height_bounds", layout);
+
+  dsLayout = GetDescriptorSetLayout("compute_normal_gen");
+  layoutCI.setLayoutCount = 1;
+  layoutCI.pSetLayouts = &dsLayout;
+  result = vkCreatePipelineLayout(m_device, &layoutCI, nullptr, &layout);
+  ThrowIfFailed(result, "vkCreatePipelineLayout Failed.");
+  RegisterLayout("compute_normal_gen", layout);
 }
 
 void TessellateGroundApp::Render()
@@ -245,6 +424,7 @@ void TessellateGroundApp::Render()
       glm::radians(45.0f), float(extent.width) / float(extent.height), 0.1f, 1000.0f
     );
   }
+  UpdateTessCacheState(m_camera.GetViewMatrix());
 
   {
     TessellationShaderParameters tessParams;
@@ -253,16 +433,150 @@ void TessellateGroundApp::Render()
     tessParams.proj = m_projection;
     tessParams.lightPos = glm::vec4(0.0f);
     tessParams.cameraPos = glm::vec4(m_camera.GetPosition(), 0.0f);
+    // TCS ̓[hԂɈڂ_Ɣׂ邽߁Aʂ[hԂŋ߂.
+    TerrainQuadtree::CalcFrustumPlanes(tessParams.proj * tessParams.view, tessParams.frustumPlanes);
+    tessParams.cullParams = glm::vec4(
+      m_isFrustumCulling ? 1.0f : 0.0f,
+      m_isBackfaceCulling ? 1.0f : 0.0f,
+      25.0f, 0.0f);
+    if (m_tessCacheState == TessCacheState_Capture)
+    {
+      // oʂ̓JĂg߁AJOɑSpb`c.
+      tessParams.cullParams.x = 0.0f;
+      tessParams.cullParams.y = 0.0f;
+    }
+    tessParams.tileParams = GetTileParams();
+    auto extent = m_swapchain->GetSurfaceExtent();
+    tessParams.tessParams = glm::vec4(
+      float(m_tessFactorMode), m_targetEdgePixels,
+      float(extent.width), float(extent.height));
+    tessParams.heightMapParams = glm::vec4(float(m_heightMapWidth), float(m_heightMapHeight), 0.0f, 0.0f);
     WriteToHostVisibleMemory(m_tessUniform[imageIndex].memory, sizeof(tessParams), &tessParams);
+
+    GroundTessellationEstimator::CameraFrame cameraFrame{
+      tessParams.view, tessParams.proj, float(extent.width), float(extent.height)
+    };
+    if (m_isRecordingCameraPath)
+    {
+      GroundTessellationEstimator::WriteCameraFrame(m_cameraPathFile, cameraFrame);
+    }
+    if (m_isTessEstimatorReady && m_terrainMode == TerrainMode_Tessellation)
+    {
+      GroundTessellationEstimator::Settings settings{
+        m_isFrustumCulling, m_isBackfaceCulling, m_tessFactorMode, m_targetEdgePixels
+      };
+      m_lastEstimate = m_tessEstimator.Evaluate(cameraFrame, settings);
+    }
   }
 
   auto fence = m_commandBuffers[imageIndex].fence;
   vkWaitForFences(m_device, 1, &fence, VK_TRUE, UINT64_MAX);
 
+  {
+    // O񂱂̃obt@gt[̏WvʂāANAĂ.
+    auto memory = m_cullStatistics[imageIndex].memory;
+    void* p;
+    vkMapMemory(m_device, memory, 0, VK_WHOLE_SIZE, 0, &p);
+    memcpy(&m_lastCullStats, p, sizeof(CullStatistics));
+    memset(p, 0, sizeof(CullStatistics));
+    vkUnmapMemory(m_device, memory);
+  }
+
+  if (m_tessCacheState == TessCacheState_Capture)
+  {
+    // ̃t[ȑǑʂ`撆̉\邽߁ASĊ҂.
+    for (auto& c : m_commandBuffers)
+    {
+      vkWaitForFences(m_device, 1, &c.fence, VK_TRUE, UINT64_MAX);
+    }
+    m_tessCacheCaptureFence = fence;
+    m_tessCacheVertexCount = 0;
+    m_tessCacheOverflowTriangles = 0;
+  }
+  else if (m_tessCacheCaptureFence != VK_NULL_HANDLE && vkGetFenceStatus(m_device, m_tessCacheCaptureFence) == VK_SUCCESS)
+  {
+    // oĂΒ_.
+    TessCacheHeader header;
+    void* p;
+    vkMapMemory(m_device, m_tessCacheReadback.memory, 0, VK_WHOLE_SIZE, 0, &p);
+    memcpy(&header, p, sizeof(header));
+    vkUnmapMemory(m_device, m_tessCacheReadback.memory);
+    m_tessCacheCaptureFence = VK_NULL_HANDLE;
+    m_tessCacheVertexCount = header.drawArgs.vertexCount;
+    m_tessCacheOverflowTriangles = header.overflowTriangles;
+    if (header.overflowTriangles > 0)
+    {
+      // ʂ͍ėpAt[̃ebZ[Vɖ߂.
+      m_isTessCacheValid = false;
+      m_isTessCacheOverflowed = true;
+    }
+  }
+
+  if (m_terrainMode == TerrainMode_CDLOD)
+  {
+    // l؂`m[hIăCX^Xf[^XV.
+    auto view = m_camera.GetViewMatrix();
+    auto cameraPos = m_camera.GetPosition();
+    glm::vec4 frustumPlanes[6];
+    TerrainQuadtree::CalcFrustumPlanes(m_projection * view, frustumPlanes);
+
+    std::vector<TerrainQuadtree::NodeInstance> nodes;
+    m_quadtree.Select(cameraPos, frustumPlanes, nodes);
+    m_cdlodInstanceCount = uint32_t(nodes.size());
+    if (m_cdlodInstanceCount > CdlodMaxInstances)
+    {
+      m_cdlodInstanceCount = CdlodMaxInstances;
+    }
+    if (m_cdlodInstanceCount > 0)
+    {
+      auto size = uint32_t(sizeof(TerrainQuadtree::NodeInstance) * m_cdlodInstanceCount);
+      WriteToHostVisibleMemory(m_cdlodInstances[imageIndex].memory, size, nodes.data());
+    }
+
+    CdlodShaderParameters cdlodParams{};
+    cdlodParams.world = glm::mat4(1.0f);
+    cdlodParams.view = view;
+    cdlodParams.proj = m_projection;
+    cdlodParams.lightPos = glm::vec4(0.0f);
+    cdlodParams.cameraPos = glm::vec4(cameraPos, 0.0f);
+    for (int i = 0; i < m_quadtree.GetLodLevels(); ++i)
+    {
+      auto range = m_quadtree.GetMorphRange(i);
+      cdlodParams.lodMorph[i] = glm::vec4(range.x, range.y, 0.0f, 0.0f);
+    }
+    cdlodParams.terrainParams = glm::vec4(
+      m_quadtree.GetTerrainSize(), m_quadtree.GetHeightScale(), float(CdlodGridResolution), 0.0f);
+    cdlodParams.tileParams = GetTileParams();
+    WriteToHostVisibleMemory(m_cdlodUniform[imageIndex].memory, sizeof(cdlodParams), &cdlodParams);
+  }
+
+  std::vector<TerrainTileStreamer::TileUpload> tileUploads;
+  if (m_isTileStreaming && m_isTileDataReady)
+  {
+    // Jӂ̃^CvAǂݍݍς݂̂̂]ΏۂƂĎ󂯎.
+    m_tileStreamer.Update(m_camera.GetPosition(), 200.0f, ++m_frameCount, TileMaxUploadsPerFrame, tileUploads);
+    const auto& indirection = m_tileStreamer.GetIndirection();
+    auto size = uint32_t(sizeof(int32_t) * indirection.size());
+    WriteToHostVisibleMemory(m_tileIndirection[imageIndex].memory, size, indirection.data());
+  }
+  m_lastTileUploads = int(tileUploads.size());
+  if (!tileUploads.empty() && m_tessCacheState != TessCacheState_Capture)
+  {
+    // QƂnCg}bvς邽ߍ蒼.
+    m_isTessCacheValid = false;
+  }
+
   auto command = m_commandBuffers[imageIndex].commandBuffer;
 
   vkBeginCommandBuffer(command, &commandBI);
 
+  // ^C̓]̓_[pX̊Oōs.
+  RecordTileUploads(command, imageIndex, tileUploads);
+  if (m_tessCacheState == TessCacheState_Capture)
+  {
+    RecordTessCacheCapture(command, imageIndex);
+  }
+
   vkCmdBeginRenderPass(command, &rpBI, VK_SUBPASS_CONTENTS_INLINE);
   auto extent = m_swapchain->GetSurfaceExtent();
   VkViewport viewport = book_util::GetViewportFlipped(float(extent.width), float(extent.height));
@@ -275,19 +589,44 @@ void TessellateGroundApp::Render()
   vkCmdSetScissor(command, 0, 1, &scissor);
   vkCmdSetViewport(command, 0, 1, &viewport);
  
-  auto pipelineLayout = GetPipelineLayout("u1t2");
-  if (m_isWireframe)
+  if (m_terrainMode == TerrainMode_Tessellation && m_tessCacheState != TessCacheState_Live)
   {
-    vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, m_tessGroundWired);
+    // oς݂̃ebZ[Vʂ`悷. _̓obt@擪̈g.
+    auto pipelineLayout = GetPipelineLayout("u1t5s4");
+    vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, m_isWireframe ? m_tessCacheWired : m_tessCachePipeline);
+    vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &m_dsTessSample[imageIndex], 0, nullptr);
+    VkDeviceSize cacheOffset = sizeof(TessCacheHeader);
+    vkCmdBindVertexBuffers(command, 0, 1, &m_tessCache.buffer, &cacheOffset);
+    vkCmdDrawIndirect(command, m_tessCache.buffer, 0, 1, 0);
   }
-  else
+  else if (m_terrainMode == TerrainMode_Tessellation)
+  {
+    auto pipelineLayout = GetPipelineLayout("u1t5s4");
+    if (m_isWireframe)
+    {
+      vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, m_tessGroundWired);
+    }
+    else
+    {
+      vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, m_tessGroundPipeline);
+    }
+    vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &m_dsTessSample[imageIndex], 0, nullptr);
+    vkCmdBindIndexBuffer(command, m_quad.resIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdBindVertexBuffers(command, 0, 1, &m_quad.resVertexBuffer.buffer, offsets);
+    vkCmdDrawIndexed(command, m_quad.indexCount, 1, 0, 0, 0);
+  }
+  if (m_terrainMode == TerrainMode_CDLOD && m_cdlodInstanceCount > 0)
   {
-    vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, m_tessGroundPipeline);
+    // IꂽSm[h 1 ̃CX^X`ŕ`.
+    auto pipelineLayout = GetPipelineLayout("u1t5s4");
+    vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, m_isWireframe ? m_cdlodWired : m_cdlodPipeline);
+    vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &m_dsCdlod[imageIndex], 0, nullptr);
+    VkBuffer vertexBuffers[] = { m_cdlodGrid.resVertexBuffer.buffer, m_cdlodInstances[imageIndex].buffer };
+    VkDeviceSize vbOffsets[] = { 0, 0 };
+    vkCmdBindIndexBuffer(command, m_cdlodGrid.resIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdBindVertexBuffers(command, 0, 2, vertexBuffers, vbOffsets);
+    vkCmdDrawIndexed(command, m_cdlodGrid.indexCount, m_cdlodInstanceCount, 0, 0, 0);
   }
-  vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &m_dsTessSample[imageIndex], 0, nullptr);
-  vkCmdBindIndexBuffer(command, m_quad.resIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
-  vkCmdBindVertexBuffers(command, 0, 1, &m_quad.resVertexBuffer.buffer, offsets);
-  vkCmdDrawIndexed(command, m_quad.indexCount, 1, 0, 0, 0);
 
   RenderHUD(command);
 
@@ -370,7 +709,10 @@ void TessellateGroundApp::PrepareSceneResource()
   vkCreateSampler(m_device, &samplerCI, nullptr, &m_texSampler);
 
   m_heightMap = Load2DTextureFromFile("heightmap.png");
-  m_normalMap = Load2DTextureFromFile("normalmap.png");
+  int width = 0, height = 0;
+  stbi_info("heightmap.png", &width, &height, nullptr);
+  m_heightMapWidth = uint32_t(width);
+  m_heightMapHeight = uint32_t(height);
 }
 
 TessellateGroundApp::ImageObject TessellateGroundApp::Load2DTextureFromFile(const char* fileName)
@@ -378,12 +720,19 @@ TessellateGroundApp::ImageObject TessellateGroundApp::Load2DTextureFromFile(cons
   int width, height;
   stbi_uc* rawimage = nullptr;
   rawimage = stbi_load(fileName, &width, &height, nullptr, 4);
+  auto texture = CreateTextureFromMemory(uint32_t(width), uint32_t(height), VK_FORMAT_R8G8B8A8_UNORM, rawimage);
+  stbi_image_free(rawimage);
+  return texture;
+}
 
+// 1 f 4 oCǧ`̂ݑΉ.
+TessellateGroundApp::ImageObject TessellateGroundApp::CreateTextureFromMemory(uint32_t width, uint32_t height, VkFormat format, const void* data)
+{
   VkImageCreateInfo imageCI{
     VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO, nullptr,
     0,
     VK_IMAGE_TYPE_2D,
-    VK_FORMAT_R8G8B8A8_UNORM, { uint32_t(width), uint32_t(height), 1u },
+    format, { width, height, 1u },
     1, 1,
     VK_SAMPLE_COUNT_1_BIT,
     VK_IMAGE_TILING_OPTIMAL,
@@ -423,7 +772,7 @@ TessellateGroundApp::ImageObject TessellateGroundApp::Load2DTextureFromFile(cons
   auto bufferSize = uint32_t(width * height * sizeof(uint32_t));
   BufferObject buffersSrc;
   buffersSrc = CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-  WriteToHostVisibleMemory(buffersSrc.memory, bufferSize, rawimage);
+  WriteToHostVisibleMemory(buffersSrc.memory, bufferSize, data);
 
   // ].
   auto command = CreateCommandBuffer();
@@ -449,7 +798,7 @@ TessellateGroundApp::ImageObject TessellateGroundApp::Load2DTextureFromFile(cons
     1, &imb);
 
   VkBufferImageCopy  region{};
-  region.imageExtent = { uint32_t(width), uint32_t(height), 1 };
+  region.imageExtent = { width, height, 1 };
   region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
   region.imageSubresource.baseArrayLayer = 0;
 
@@ -473,8 +822,6 @@ TessellateGroundApp::ImageObject TessellateGroundApp::Load2DTextureFromFile(cons
     1, &imb);
 
   FinishCommandBuffer(command);
-
-  stbi_image_free(rawimage);
   DestroyBuffer(buffersSrc);
 
   ImageObject texture;
@@ -662,8 +1009,17 @@ void TessellateGroundApp::PreparePrimitiveResource()
   auto imageCount = int(m_swapchain->GetImageCount());
   m_tessUniform = CreateUniformBuffers(sizeof(TessellationShaderParameters), imageCount);
 
+  // JOv̏ݐ.
+  m_cullStatistics.resize(imageCount);
+  for (auto& buffer : m_cullStatistics)
+  {
+    CullStatistics zero{};
+    buffer = CreateBuffer(sizeof(CullStatistics), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    WriteToHostVisibleMemory(buffer.memory, sizeof(zero), &zero);
+  }
+
   VkResult result;
-  VkDescriptorSetLayout dsLayout = GetDescriptorSetLayout("u1t2");
+  VkDescriptorSetLayout dsLayout = GetDescriptorSetLayout("u1t5s4");
   VkDescriptorSetAllocateInfo dsAI{
     VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
     nullptr, m_descriptorPool,
@@ -683,25 +1039,55 @@ void TessellateGroundApp::PreparePrimitiveResource()
     };
     VkDescriptorImageInfo imageInfo{
       m_texSampler,
-      m_heightMap.view,
+      GetTerrainHeightView(),
       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
     };
     VkDescriptorImageInfo imageInfo2{
       m_texSampler,
-      m_normalMap.view,
+      GetTerrainNormalView(),
+      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+    VkDescriptorBufferInfo statInfo{
+      m_cullStatistics[i].buffer, 0, VK_WHOLE_SIZE
+    };
+    VkDescriptorImageInfo tileHeightInfo{
+      m_texSampler,
+      m_tileHeightArray.view,
+      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+    VkDescriptorImageInfo tileNormalInfo{
+      m_texSampler,
+      m_tileNormalArray.view,
+      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+    VkDescriptorBufferInfo indirectionInfo{
+      m_tileIndirection[i].buffer, 0, VK_WHOLE_SIZE
+    };
+    VkDescriptorImageInfo heightBoundsInfo{
+      m_texSampler,
+      m_heightBoundsImage.view,
       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
     };
+    VkDescriptorBufferInfo normalConeInfo{
+      m_normalCones.buffer, 0, VK_WHOLE_SIZE
+    };
 
     std::vector<VkWriteDescriptorSet> writeDS = {
       book_util::CreateWriteDescriptorSet(m_dsTessSample[i], 0, &bufferInfo),
       book_util::CreateWriteDescriptorSet(m_dsTessSample[i], 1, &imageInfo),
-      book_util::CreateWriteDescriptorSet(m_dsTessSample[i], 2, &imageInfo2)
+      book_util::CreateWriteDescriptorSet(m_dsTessSample[i], 2, &imageInfo2),
+      book_util::CreateWriteDescriptorSet(m_dsTessSample[i], 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &statInfo),
+      book_util::CreateWriteDescriptorSet(m_dsTessSample[i], 4, &tileHeightInfo),
+      book_util::CreateWriteDescriptorSet(m_dsTessSample[i], 5, &tileNormalInfo),
+      book_util::CreateWriteDescriptorSet(m_dsTessSample[i], 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &indirectionInfo),
+      book_util::CreateWriteDescriptorSet(m_dsTessSample[i], 7, &heightBoundsInfo),
+      book_util::CreateWriteDescriptorSet(m_dsTessSample[i], 9, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &normalConeInfo),
     };
     vkUpdateDescriptorSets(m_device, uint32_t(writeDS.size()), writeDS.data(), 0, nullptr);
   }
 
   // pCvCCAEg̏
-  VkPipelineLayout layout = GetPipelineLayout("u1t2");
+  VkPipelineLayout layout = GetPipelineLayout("u1t5s4");
 
   // pCvC\z.
   auto stride = uint32_t(sizeof(Vertex));
@@ -789,9 +1175,11 @@ void TessellateGroundApp::PreparePrimitiveResource()
   pipelineCI.pDepthStencilState = &dsState;
   pipelineCI.pColorBlendState = &colorBlendStateCI;
 
+  // Wvpobt@֏߂Ȃł́AWvȂ̂g.
+  auto tcsFile = m_isVertexPipelineStoresSupported ? "tessTCS.spv" : "tessTCSNoStats.spv";
   shaderStages = {
     book_util::LoadShader(m_device, "tessVS.spv", VK_SHADER_STAGE_VERTEX_BIT),
-    book_util::LoadShader(m_device, "tessTCS.spv", VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT),
+    book_util::LoadShader(m_device, tcsFile, VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT),
     book_util::LoadShader(m_device, "tessTES.spv", VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT),
     book_util::LoadShader(m_device, "tessFS.spv", VK_SHADER_STAGE_FRAGMENT_BIT)
   };
@@ -819,17 +1207,1135 @@ void TessellateGroundApp::PreparePrimitiveResource()
   book_util::DestroyShaderModules(m_device, shaderStages);
 }
 
-void TessellateGroundApp::RenderHUD(VkCommandBuffer command)
+void TessellateGroundApp::PrepareCdlodResource()
 {
-  ImGui_ImplVulkan_NewFrame();
-  ImGui_ImplGlfw_NewFrame();
-  ImGui::NewFrame();
+  using namespace glm;
+  const float edge = 200.0f;
+  const float heightScale = 25.0f;
+  m_quadtree.Setup(edge, heightScale, 5, 20.0f);
+  m_quadtree.SetHeightBounds(&m_heightBounds);
+
+  // Sm[hŋLiqbV.
+  const uint32_t res = CdlodGridResolution;
+  std::vector<CdlodVertex> vertices;
+  for (uint32_t z = 0; z <= res; ++z)
+  {
+    for (uint32_t x = 0; x <= res; ++x)
+    {
+      vertices.push_back({ vec2(float(x), float(z)) });
+    }
+  }
+  std::vector<uint32_t> indices;
+  for (uint32_t z = 0; z < res; ++z)
+  {
+    for (uint32_t x = 0; x < res; ++x)
+    {
+      const uint32_t rows = res + 1;
+      uint32_t v0 = x + rows * z, v1 = v0 + 1;
+      uint32_t v2 = v0 + rows, v3 = v1 + rows;
+      indices.push_back(v0); indices.push_back(v2); indices.push_back(v1);
+      indices.push_back(v1); indices.push_back(v2); indices.push_back(v3);
+    }
+  }
+  m_cdlodGrid = CreateSimpleModel(vertices, indices);
 
+  // t[̃CX^Xobt@ƒ萔obt@.
+  auto imageCount = int(m_swapchain->GetImageCount());
+  auto instanceBufferSize = uint32_t(sizeof(TerrainQuadtree::NodeInstance) * CdlodMaxInstances);
+  m_cdlodInstances.resize(imageCount);
+  for (auto& buffer : m_cdlodInstances)
   {
-    ImGui::Begin("Control");
-    auto cameraPos = m_camera.GetPosition();
-    ImGui::Text("CameraPos: (%.2f, %.2f, %.2f)", cameraPos.x, cameraPos.y, cameraPos.z);
-    ImGui::Checkbox("WireFrame", &m_isWireframe);
+    buffer = CreateBuffer(instanceBufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  }
+  m_cdlodUniform = CreateUniformBuffers(sizeof(CdlodShaderParameters), imageCount);
+
+  // ebZ[VƓ^C/TςQƂ邽߁ACAEgg(3,7,8,9 Ԃ͎gpȂ).
+  auto dsLayout = GetDescriptorSetLayout("u1t5s4");
+  m_dsCdlod.resize(imageCount);
+  for (int i = 0; i < imageCount; ++i)
+  {
+    m_dsCdlod[i] = AllocateDescriptorSet(dsLayout);
+
+    VkDescriptorBufferInfo bufferInfo{
+      m_cdlodUniform[i].buffer, 0, VK_WHOLE_SIZE
+    };
+    VkDescriptorImageInfo heightInfo{
+      m_texSampler, GetTerrainHeightView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+    VkDescriptorImageInfo normalInfo{
+      m_texSampler, GetTerrainNormalView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+    VkDescriptorImageInfo tileHeightInfo{
+      m_texSampler, m_tileHeightArray.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+    VkDescriptorImageInfo tileNormalInfo{
+      m_texSampler, m_tileNormalArray.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+    VkDescriptorBufferInfo indirectionInfo{
+      m_tileIndirection[i].buffer, 0, VK_WHOLE_SIZE
+    };
+    std::vector<VkWriteDescriptorSet> writeDS = {
+      book_util::CreateWriteDescriptorSet(m_dsCdlod[i], 0, &bufferInfo),
+      book_util::CreateWriteDescriptorSet(m_dsCdlod[i], 1, &heightInfo),
+      book_util::CreateWriteDescriptorSet(m_dsCdlod[i], 2, &normalInfo),
+      book_util::CreateWriteDescriptorSet(m_dsCdlod[i], 4, &tileHeightInfo),
+      book_util::CreateWriteDescriptorSet(m_dsCdlod[i], 5, &tileNormalInfo),
+      book_util::CreateWriteDescriptorSet(m_dsCdlod[i], 6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &indirectionInfo),
+    };
+    vkUpdateDescriptorSets(m_device, uint32_t(writeDS.size()), writeDS.data(), 0, nullptr);
+  }
+
+  // pCvC\z.
+  // binding 0: iq_, binding 1: m[h̃CX^Xf[^.
+  array<VkVertexInputBindingDescription, 2> vibDescs{
+    {
+      { 0, uint32_t(sizeof(CdlodVertex)), VK_VERTEX_INPUT_RATE_VERTEX },
+      { 1, uint32_t(sizeof(TerrainQuadtree::NodeInstance)), VK_VERTEX_INPUT_RATE_INSTANCE },
+    }
+  };
+  array<VkVertexInputAttributeDescription, 2> inputAttribs{
+    {
+      { 0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(CdlodVertex, Grid) },
+      { 1, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(TerrainQuadtree::NodeInstance, Node) },
+    }
+  };
+  VkPipelineVertexInputStateCreateInfo pipelineVisCI{
+    VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+    nullptr, 0,
+    uint32_t(vibDescs.size()), vibDescs.data(),
+    uint32_t(inputAttribs.size()), inputAttribs.data()
+  };
+
+  auto blendAttachmentState = book_util::GetOpaqueColorBlendAttachmentState();
+  VkPipelineColorBlendStateCreateInfo colorBlendStateCI{
+    VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+    nullptr, 0,
+    VK_FALSE, VK_LOGIC_OP_CLEAR, // logicOpEnable
+    1, &blendAttachmentState,
+    { 0.0f, 0.0f, 0.0f,0.0f }
+  };
+  VkPipelineInputAssemblyStateCreateInfo inputAssemblyCI{
+    VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+    nullptr, 0, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+    VK_FALSE,
+  };
+  VkPipelineMultisampleStateCreateInfo multisampleCI{
+    VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+    nullptr, 0,
+    VK_SAMPLE_COUNT_1_BIT,
+    VK_FALSE, // sampleShadingEnable
+    0.0f, nullptr,
+    VK_FALSE, VK_FALSE,
+  };
+
+  auto extentBackbuffer = m_swapchain->GetSurfaceExtent();
+  auto viewportBackbuffer = book_util::GetViewportFlipped(float(extentBackbuffer.width), float(extentBackbuffer.height));
+  auto scissorBackbuffer = VkRect2D{
+    { 0, 0}, extentBackbuffer
+  };
+  VkPipelineViewportStateCreateInfo viewportStateCI{
+    VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+    nullptr, 0,
+    1, &viewportBackbuffer,
+    1, &scissorBackbuffer,
+  };
+
+  auto rasterizerState = book_util::GetDefaultRasterizerState(VK_CULL_MODE_BACK_BIT);
+  auto dsState = book_util::GetDefaultDepthStencilState();
+
+  // DynamicState
+  vector<VkDynamicState> dynamicStates{
+    VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_VIEWPORT
+  };
+  VkPipelineDynamicStateCreateInfo pipelineDynamicStateCI{
+    VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO, nullptr, 0,
+    uint32_t(dynamicStates.size()), dynamicStates.data(),
+  };
+
+  std::vector<VkPipelineShaderStageCreateInfo> shaderStages{
+    book_util::LoadShader(m_device, "cdlodVS.spv", VK_SHADER_STAGE_VERTEX_BIT),
+    book_util::LoadShader(m_device, "tessFS.spv", VK_SHADER_STAGE_FRAGMENT_BIT)
+  };
+
+  VkGraphicsPipelineCreateInfo pipelineCI{
+    VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO, nullptr, 0,
+  };
+  pipelineCI.stageCount = uint32_t(shaderStages.size());
+  pipelineCI.pStages = shaderStages.data();
+  pipelineCI.pVertexInputState = &pipelineVisCI;
+  pipelineCI.pInputAssemblyState = &inputAssemblyCI;
+  pipelineCI.pViewportState = &viewportStateCI;
+  pipelineCI.pRasterizationState = &rasterizerState;
+  pipelineCI.pMultisampleState = &multisampleCI;
+  pipelineCI.pDepthStencilState = &dsState;
+  pipelineCI.pColorBlendState = &colorBlendStateCI;
+  pipelineCI.pDynamicState = &pipelineDynamicStateCI;
+  pipelineCI.layout = GetPipelineLayout("u1t5s4");
+  pipelineCI.renderPass = GetRenderPass("default");
+
+  VkResult result;
+  result = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &m_cdlodPipeline);
+  ThrowIfFailed(result, "vkCreateGraphicsPipelines failed.");
+
+  // C[t[`p쐬.
+  rasterizerState.polygonMode = VK_POLYGON_MODE_LINE;
+  result = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &m_cdlodWired);
+  ThrowIfFailed(result, "vkCreateGraphicsPipelines failed.");
+
+  book_util::DestroyShaderModules(m_device, shaderStages);
+}
+
+void TessellateGroundApp::PrepareTileStreaming()
+{
+  // ^Cf[^Ȃ΃nCg}bvƐ@쐬.
+  const char* tileDir = "terrain_tiles";
+  const int tileSize = 64;
+  const int threadCount = 2;
+  m_isTileDataReady = m_tileStreamer.Open(tileDir, TileSlotCount, threadCount);
+  if (!m_isTileDataReady)
+  {
+    auto packedNormals = ReadbackNormalMap();
+    if (TerrainTileStreamer::BuildTiles("heightmap.png", packedNormals, tileDir, tileSize))
+    {
+      m_isTileDataReady = m_tileStreamer.Open(tileDir, TileSlotCount, threadCount);
+    }
+  }
+
+  if (m_isTileDataReady)
+  {
+    // 풓ĂȂ^C̑ɎQƂT.
+    auto overviewWidth = uint32_t(m_tileStreamer.GetOverviewWidth());
+    auto overviewHeight = uint32_t(m_tileStreamer.GetOverviewHeight());
+    m_overviewHeightMap = CreateTextureFromMemory(overviewWidth, overviewHeight, VK_FORMAT_R8G8B8A8_UNORM, m_tileStreamer.GetOverviewHeightData().data());
+    m_overviewNormalMap = CreateTextureFromMemory(overviewWidth, overviewHeight, VK_FORMAT_R16G16_SFLOAT, m_tileStreamer.GetOverviewNormalData().data());
+  }
+
+  // ^Ci[Xbg(eNX`z).
+  auto imageSize = uint32_t(m_isTileDataReady ? m_tileStreamer.GetTileImageSize() : 1);
+  m_tileHeightArray = CreateTileArrayTexture(imageSize, TileSlotCount, VK_FORMAT_R8G8B8A8_UNORM);
+  m_tileNormalArray = CreateTileArrayTexture(imageSize, TileSlotCount, VK_FORMAT_R16G16_SFLOAT);
+
+  // t[̓]pobt@ƊԐڎQƃe[u.
+  auto imageCount = m_swapchain->GetImageCount();
+  auto tileBytes = imageSize * imageSize * 4;
+  auto stagingSize = tileBytes * 2 * TileMaxUploadsPerFrame;
+  auto tileCount = (std::max)(m_tileStreamer.GetTilesX() * m_tileStreamer.GetTilesY(), 1);
+  auto indirectionSize = uint32_t(sizeof(int32_t) * tileCount);
+  std::vector<int32_t> emptyTable(tileCount, -1);
+  m_tileStaging.resize(imageCount);
+  m_tileIndirection.resize(imageCount);
+  for (uint32_t i = 0; i < imageCount; ++i)
+  {
+    m_tileStaging[i] = CreateBuffer(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    m_tileIndirection[i] = CreateBuffer(indirectionSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    WriteToHostVisibleMemory(m_tileIndirection[i].memory, indirectionSize, emptyTable.data());
+  }
+}
+
+glm::vec4 TessellateGroundApp::GetTileParams() const
+{
+  if (!m_isTileStreaming || !m_isTileDataReady)
+  {
+    return glm::vec4(0.0f);
+  }
+  return glm::vec4(
+    float(m_tileStreamer.GetTilesX()), float(m_tileStreamer.GetTilesY()),
+    float(m_tileStreamer.GetTileSize()), float(TerrainTileStreamer::TileBorder));
+}
+
+void TessellateGroundApp::ReleaseSourceMaps()
+{
+  if (!m_isTileDataReady)
+  {
+    // ^CgȂꍇ͌̃}bv̂܂ܕ`Ɏg.
+    return;
+  }
+  DestroyImage(m_heightMap);
+  DestroyImage(m_normalMap);
+  m_heightMap = ImageObject{};
+  m_normalMap = ImageObject{};
+
+  // ȉ͌̃}bvQƂ쐬p̃\[X.
+  DestroyBuffer(m_packedNormals);
+  DestroyBuffer(m_normalGenUniform);
+  DeallocateDescriptorSet(m_dsNormalGen);
+  m_packedNormals = BufferObject{};
+  m_normalGenUniform = BufferObject{};
+  m_dsNormalGen = VK_NULL_HANDLE;
+  for (auto& ds : m_dsHeightBounds)
+  {
+    DeallocateDescriptorSet(ds);
+  }
+  m_dsHeightBounds.clear();
+  for (auto& view : m_heightBoundsLevelViews)
+  {
+    vkDestroyImageView(m_device, view, nullptr);
+  }
+  m_heightBoundsLevelViews.clear();
+}
+
+TessellateGroundApp::ImageObject TessellateGroundApp::CreateTileArrayTexture(uint32_t size, uint32_t layers, VkFormat format)
+{
+  VkImageCreateInfo imageCI{
+    VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO, nullptr,
+    0,
+    VK_IMAGE_TYPE_2D,
+    format, { size, size, 1u },
+    1, layers,
+    VK_SAMPLE_COUNT_1_BIT,
+    VK_IMAGE_TILING_OPTIMAL,
+    VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+    VK_SHARING_MODE_EXCLUSIVE,
+    0, nullptr,
+    VK_IMAGE_LAYOUT_UNDEFINED
+  };
+  VkResult result;
+  ImageObject texture;
+  result = vkCreateImage(m_device, &imageCI, nullptr, &texture.image);
+  ThrowIfFailed(result, "vkCreateImage failed.");
+  texture.memory = AllocateMemory(texture.image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  vkBindImageMemory(m_device, texture.image, texture.memory, 0);
+
+  VkImageViewCreateInfo viewCI{
+    VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+    nullptr, 0,
+    texture.image,
+    VK_IMAGE_VIEW_TYPE_2D_ARRAY, imageCI.format,
+    book_util::DefaultComponentMapping(),
+    { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, layers}
+  };
+  result = vkCreateImageView(m_device, &viewCI, nullptr, &texture.view);
+  ThrowIfFailed(result, "vkCreateImageView failed.");
+
+  // gp̃XbgQƉ\ȃCAEgɂĂ.
+  auto command = CreateCommandBuffer();
+  VkImageMemoryBarrier imb{
+    VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER, nullptr,
+    0, VK_ACCESS_SHADER_READ_BIT,
+    VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+    texture.image,
+    { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, layers }
+  };
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
+    0, 0, nullptr,
+    0, nullptr,
+    1, &imb);
+  FinishCommandBuffer(command);
+  DestroyCommandBuffer(command);
+  return texture;
+}
+
+void TessellateGroundApp::RecordTileUploads(VkCommandBuffer command, uint32_t imageIndex, const std::vector<TerrainTileStreamer::TileUpload>& uploads)
+{
+  if (uploads.empty())
+  {
+    return;
+  }
+  auto imageSize = uint32_t(m_tileStreamer.GetTileImageSize());
+  auto tileBytes = imageSize * imageSize * 4;
+
+  // Xe[WOobt@֋l߂āAXbg̃Rs[̈.
+  std::vector<VkBufferImageCopy> heightRegions, normalRegions;
+  std::vector<VkImageMemoryBarrier> barriers;
+  auto memory = m_tileStaging[imageIndex].memory;
+  uint8_t* p = nullptr;
+  vkMapMemory(m_device, memory, 0, VK_WHOLE_SIZE, 0, (void**)&p);
+  for (uint32_t i = 0; i < uint32_t(uploads.size()); ++i)
+  {
+    const auto& tile = uploads[i];
+    VkDeviceSize heightOffset = tileBytes * (i * 2 + 0);
+    VkDeviceSize normalOffset = tileBytes * (i * 2 + 1);
+    memcpy(p + heightOffset, tile.height.data(), tileBytes);
+    memcpy(p + normalOffset, tile.normal.data(), tileBytes);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, uint32_t(tile.slot), 1 };
+    region.imageExtent = { imageSize, imageSize, 1 };
+    region.bufferOffset = heightOffset;
+    heightRegions.push_back(region);
+    region.bufferOffset = normalOffset;
+    normalRegions.push_back(region);
+
+    VkImageMemoryBarrier imb{
+      VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER, nullptr,
+      VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+      m_tileHeightArray.image,
+      { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, uint32_t(tile.slot), 1 }
+    };
+    barriers.push_back(imb);
+    imb.image = m_tileNormalArray.image;
+    barriers.push_back(imb);
+  }
+  vkUnmapMemory(m_device, memory);
+
+  // ǂoXbg𒼑Õt[QƂÎ҂Ă㏑.
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+    0, 0, nullptr,
+    0, nullptr,
+    uint32_t(barriers.size()), barriers.data());
+
+  auto staging = m_tileStaging[imageIndex].buffer;
+  vkCmdCopyBufferToImage(command, staging, m_tileHeightArray.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, uint32_t(heightRegions.size()), heightRegions.data());
+  vkCmdCopyBufferToImage(command, staging, m_tileNormalArray.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, uint32_t(normalRegions.size()), normalRegions.data());
+
+  for (auto& imb : barriers)
+  {
+    imb.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    imb.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    imb.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    imb.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  }
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
+    0, 0, nullptr,
+    0, nullptr,
+    uint32_t(barriers.size()), barriers.data());
+}
+
+void TessellateGroundApp::PrepareHeightBounds()
+{
+  m_heightBounds.Setup(int(m_heightMapWidth), int(m_heightMapHeight));
+  auto levelCount = uint32_t(m_heightBounds.GetLevelCount());
+
+  VkImageCreateInfo imageCI{
+    VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO, nullptr,
+    0,
+    VK_IMAGE_TYPE_2D,
+    VK_FORMAT_R32G32_SFLOAT,
+    { uint32_t(m_heightBounds.GetLevelWidth(0)), uint32_t(m_heightBounds.GetLevelHeight(0)), 1u },
+    levelCount, 1,
+    VK_SAMPLE_COUNT_1_BIT,
+    VK_IMAGE_TILING_OPTIMAL,
+    VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+    VK_SHARING_MODE_EXCLUSIVE,
+    0, nullptr,
+    VK_IMAGE_LAYOUT_UNDEFINED
+  };
+  VkResult result;
+  result = vkCreateImage(m_device, &imageCI, nullptr, &m_heightBoundsImage.image);
+  ThrowIfFailed(result, "vkCreateImage failed.");
+  m_heightBoundsImage.memory = AllocateMemory(m_heightBoundsImage.image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  vkBindImageMemory(m_device, m_heightBoundsImage.image, m_heightBoundsImage.memory, 0);
+
+  // TvOp(Sx)ƃXg[WC[Wp(x)̃r[.
+  VkImageViewCreateInfo viewCI{
+    VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+    nullptr, 0,
+    m_heightBoundsImage.image,
+    VK_IMAGE_VIEW_TYPE_2D, imageCI.format,
+    book_util::DefaultComponentMapping(),
+    { VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount, 0, 1 }
+  };
+  result = vkCreateImageView(m_device, &viewCI, nullptr, &m_heightBoundsImage.view);
+  ThrowIfFailed(result, "vkCreateImageView failed.");
+
+  m_heightBoundsLevelViews.resize(levelCount);
+  for (uint32_t level = 0; level < levelCount; ++level)
+  {
+    viewCI.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1 };
+    result = vkCreateImageView(m_device, &viewCI, nullptr, &m_heightBoundsLevelViews[level]);
+    ThrowIfFailed(result, "vkCreateImageView failed.");
+  }
+
+  // x̃fBXNv^Zbg. x 0 ̓nCg}bv邽 1 Ԃ͎gpȂ.
+  auto dsLayout = GetDescriptorSetLayout("compute_height_bounds");
+  m_dsHeightBounds.resize(levelCount);
+  for (uint32_t level = 0; level < levelCount; ++level)
+  {
+    m_dsHeightBounds[level] = AllocateDescriptorSet(dsLayout);
+
+    VkDescriptorImageInfo heightMapInfo{
+      m_texSampler, m_heightMap.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+    VkDescriptorImageInfo srcLevelInfo{
+      VK_NULL_HANDLE, m_heightBoundsLevelViews[level > 0 ? level - 1 : 0], VK_IMAGE_LAYOUT_GENERAL
+    };
+    VkDescriptorImageInfo destLevelInfo{
+      VK_NULL_HANDLE, m_heightBoundsLevelViews[level], VK_IMAGE_LAYOUT_GENERAL
+    };
+    std::vector<VkWriteDescriptorSet> writeDS = {
+      book_util::CreateWriteDescriptorSet(m_dsHeightBounds[level], 0, &heightMapInfo),
+      book_util::CreateWriteDescriptorSet(m_dsHeightBounds[level], 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &srcLevelInfo),
+      book_util::CreateWriteDescriptorSet(m_dsHeightBounds[level], 2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &destLevelInfo),
+    };
+    vkUpdateDescriptorSets(m_device, uint32_t(writeDS.size()), writeDS.data(), 0, nullptr);
+  }
+
+  auto computeStage = book_util::LoadShader(m_device, "heightBoundsInitCS.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+  VkComputePipelineCreateInfo pipelineCI{
+    VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO, nullptr, 0,
+    computeStage,
+    GetPipelineLayout("compute_height_bounds"),
+    VK_NULL_HANDLE, 0
+  };
+  result = vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &m_heightBoundsInitPipeline);
+  ThrowIfFailed(result, "vkCreateComputePipelines failed.");
+  vkDestroyShaderModule(m_device, computeStage.module, nullptr);
+
+  computeStage = book_util::LoadShader(m_device, "heightBoundsReduceCS.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+  pipelineCI.stage = computeStage;
+  result = vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &m_heightBoundsReducePipeline);
+  ThrowIfFailed(result, "vkCreateComputePipelines failed.");
+  vkDestroyShaderModule(m_device, computeStage.module, nullptr);
+}
+
+void TessellateGroundApp::BuildHeightBounds()
+{
+  auto levelCount = uint32_t(m_heightBounds.GetLevelCount());
+
+  // CPU  LOD Iłg߁ASxǂݖ߂.
+  std::vector<VkDeviceSize> offsets(levelCount);
+  VkDeviceSize readbackSize = 0;
+  for (uint32_t level = 0; level < levelCount; ++level)
+  {
+    offsets[level] = readbackSize;
+    readbackSize += sizeof(glm::vec2) * m_heightBounds.GetLevelWidth(level) * m_heightBounds.GetLevelHeight(level);
+  }
+  auto readback = CreateBuffer(uint32_t(readbackSize), VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+  auto command = CreateCommandBuffer();
+  VkImageMemoryBarrier imb{
+    VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER, nullptr,
+    0, VK_ACCESS_SHADER_WRITE_BIT,
+    VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+    m_heightBoundsImage.image,
+    { VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount, 0, 1 }
+  };
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+    0, 0, nullptr,
+    0, nullptr,
+    1, &imb);
+
+  auto pipelineLayout = GetPipelineLayout("compute_height_bounds");
+  for (uint32_t level = 0; level < levelCount; ++level)
+  {
+    if (level > 0)
+    {
+      // 1 ̃x̏݊҂.
+      VkImageMemoryBarrier levelBarrier = imb;
+      levelBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+      levelBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+      levelBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+      levelBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+      levelBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 1, 0, 1 };
+      vkCmdPipelineBarrier(command,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 0, nullptr,
+        0, nullptr,
+        1, &levelBarrier);
+    }
+    auto pipeline = level == 0 ? m_heightBoundsInitPipeline : m_heightBoundsReducePipeline;
+    vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &m_dsHeightBounds[level], 0, nullptr);
+    uint32_t groupX = (m_heightBounds.GetLevelWidth(level) + 7) / 8;
+    uint32_t groupY = (m_heightBounds.GetLevelHeight(level) + 7) / 8;
+    vkCmdDispatch(command, groupX, groupY, 1);
+  }
+
+  // Sx]ɂēǂݖ߂pobt@փRs[.
+  imb.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  imb.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+  imb.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+  imb.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+    0, 0, nullptr,
+    0, nullptr,
+    1, &imb);
+
+  std::vector<VkBufferImageCopy> regions(levelCount);
+  for (uint32_t level = 0; level < levelCount; ++level)
+  {
+    auto& region = regions[level];
+    region = VkBufferImageCopy{};
+    region.bufferOffset = offsets[level];
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 };
+    region.imageExtent = {
+      uint32_t(m_heightBounds.GetLevelWidth(level)), uint32_t(m_heightBounds.GetLevelHeight(level)), 1
+    };
+  }
+  vkCmdCopyImageToBuffer(command, m_heightBoundsImage.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.buffer, uint32_t(regions.size()), regions.data());
+
+  imb.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+  imb.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  imb.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+  imb.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
+    0, 0, nullptr,
+    0, nullptr,
+    1, &imb);
+
+  VkBufferMemoryBarrier bmb{
+    VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER, nullptr,
+    VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT,
+    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+    readback.buffer, 0, VK_WHOLE_SIZE
+  };
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+    0, 0, nullptr,
+    1, &bmb,
+    0, nullptr);
+  FinishCommandBuffer(command);
+  DestroyCommandBuffer(command);
+
+  void* p = nullptr;
+  vkMapMemory(m_device, readback.memory, 0, VK_WHOLE_SIZE, 0, &p);
+  for (uint32_t level = 0; level < levelCount; ++level)
+  {
+    auto texels = reinterpret_cast<const glm::vec2*>(static_cast<const uint8_t*>(p) + offsets[level]);
+    m_heightBounds.SetLevelData(int(level), texels);
+  }
+  vkUnmapMemory(m_device, readback.memory);
+  DestroyBuffer(readback);
+}
+
+void TessellateGroundApp::PrepareNormalCones()
+{
+  int width, height;
+  stbi_uc* image = stbi_load("heightmap.png", &width, &height, nullptr, 4);
+  if (image == nullptr)
+  {
+    throw book_util::VulkanException("heightmap.png load failed.");
+  }
+  std::vector<float> heights(width * height);
+  for (int i = 0; i < width * height; ++i)
+  {
+    heights[i] = image[i * 4] / 255.0f;
+  }
+  stbi_image_free(image);
+
+  // PreparePrimitiveResource Ɠn`TCY/.
+  TerrainNormalCones cones;
+  cones.Build(heights, width, height, 200.0f, 25.0f, 10);
+
+  auto bufferSize = uint32_t(sizeof(glm::vec4) * cones.GetCones().size());
+  m_normalCones = CreateBuffer(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  WriteToHostVisibleMemory(m_normalCones.memory, bufferSize, cones.GetCones().data());
+}
+
+void TessellateGroundApp::PrepareNormalMap()
+{
+  // ʑ̃GR[h@ 2 ŕێ.
+  VkImageCreateInfo imageCI{
+    VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO, nullptr,
+    0,
+    VK_IMAGE_TYPE_2D,
+    VK_FORMAT_R16G16_SFLOAT, { m_heightMapWidth, m_heightMapHeight, 1u },
+    1, 1,
+    VK_SAMPLE_COUNT_1_BIT,
+    VK_IMAGE_TILING_OPTIMAL,
+    VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+    VK_SHARING_MODE_EXCLUSIVE,
+    0, nullptr,
+    VK_IMAGE_LAYOUT_UNDEFINED
+  };
+  VkResult result;
+  result = vkCreateImage(m_device, &imageCI, nullptr, &m_normalMap.image);
+  ThrowIfFailed(result, "vkCreateImage failed.");
+  m_normalMap.memory = AllocateMemory(m_normalMap.image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  vkBindImageMemory(m_device, m_normalMap.image, m_normalMap.memory, 0);
+
+  VkImageViewCreateInfo viewCI{
+    VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+    nullptr, 0,
+    m_normalMap.image,
+    VK_IMAGE_VIEW_TYPE_2D, imageCI.format,
+    book_util::DefaultComponentMapping(),
+    { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}
+  };
+  result = vkCreateImageView(m_device, &viewCI, nullptr, &m_normalMap.view);
+  ThrowIfFailed(result, "vkCreateImageView failed.");
+
+  // RG16 ̃Xg[WC[WΉ͊gtH[}bĝ߁A
+  // VF[_[̓obt@֏݁ARs[ŃeNX`֓].
+  auto bufferSize = uint32_t(sizeof(uint32_t) * m_heightMapWidth * m_heightMapHeight);
+  m_packedNormals = CreateBuffer(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+  NormalGenParameters params{};
+  params.terrainParams = glm::vec4(200.0f, 25.0f, 0.0f, 0.0f);
+  m_normalGenUniform = CreateBuffer(sizeof(params), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  WriteToHostVisibleMemory(m_normalGenUniform.memory, sizeof(params), &params);
+
+  m_dsNormalGen = AllocateDescriptorSet(GetDescriptorSetLayout("compute_normal_gen"));
+  VkDescriptorImageInfo heightMapInfo{
+    m_texSampler, m_heightMap.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+  };
+  VkDescriptorBufferInfo normalsInfo{
+    m_packedNormals.buffer, 0, VK_WHOLE_SIZE
+  };
+  VkDescriptorBufferInfo paramsInfo{
+    m_normalGenUniform.buffer, 0, VK_WHOLE_SIZE
+  };
+  std::vector<VkWriteDescriptorSet> writeDS = {
+    book_util::CreateWriteDescriptorSet(m_dsNormalGen, 0, &heightMapInfo),
+    book_util::CreateWriteDescriptorSet(m_dsNormalGen, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &normalsInfo),
+    book_util::CreateWriteDescriptorSet(m_dsNormalGen, 2, &paramsInfo),
+  };
+  vkUpdateDescriptorSets(m_device, uint32_t(writeDS.size()), writeDS.data(), 0, nullptr);
+
+  auto computeStage = book_util::LoadShader(m_device, "normalGenCS.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+  VkComputePipelineCreateInfo pipelineCI{
+    VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO, nullptr, 0,
+    computeStage,
+    GetPipelineLayout("compute_normal_gen"),
+    VK_NULL_HANDLE, 0
+  };
+  result = vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &m_normalGenPipeline);
+  ThrowIfFailed(result, "vkCreateComputePipelines failed.");
+  vkDestroyShaderModule(m_device, computeStage.module, nullptr);
+}
+
+void TessellateGroundApp::BuildNormalMap()
+{
+  auto command = CreateCommandBuffer();
+  vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_COMPUTE, m_normalGenPipeline);
+  vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_COMPUTE, GetPipelineLayout("compute_normal_gen"), 0, 1, &m_dsNormalGen, 0, nullptr);
+  vkCmdDispatch(command, (m_heightMapWidth + 7) / 8, (m_heightMapHeight + 7) / 8, 1);
+
+  VkBufferMemoryBarrier bmb{
+    VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER, nullptr,
+    VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+    m_packedNormals.buffer, 0, VK_WHOLE_SIZE
+  };
+  VkImageMemoryBarrier imb{
+    VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER, nullptr,
+    0, VK_ACCESS_TRANSFER_WRITE_BIT,
+    VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+    m_normalMap.image,
+    { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
+  };
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+    0, 0, nullptr,
+    1, &bmb,
+    1, &imb);
+
+  VkBufferImageCopy region{};
+  region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+  region.imageExtent = { m_heightMapWidth, m_heightMapHeight, 1 };
+  vkCmdCopyBufferToImage(command, m_packedNormals.buffer, m_normalMap.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+  imb.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  imb.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  imb.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  imb.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
+    0, 0, nullptr,
+    0, nullptr,
+    1, &imb);
+  FinishCommandBuffer(command);
+  DestroyCommandBuffer(command);
+}
+
+std::vector<uint32_t> TessellateGroundApp::ReadbackNormalMap()
+{
+  auto bufferSize = uint32_t(sizeof(uint32_t) * m_heightMapWidth * m_heightMapHeight);
+  auto readback = CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+  auto command = CreateCommandBuffer();
+  VkBufferCopy region{ 0, 0, bufferSize };
+  vkCmdCopyBuffer(command, m_packedNormals.buffer, readback.buffer, 1, &region);
+  VkBufferMemoryBarrier bmb{
+    VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER, nullptr,
+    VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT,
+    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+    readback.buffer, 0, VK_WHOLE_SIZE
+  };
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+    0, 0, nullptr,
+    1, &bmb,
+    0, nullptr);
+  FinishCommandBuffer(command);
+  DestroyCommandBuffer(command);
+
+  std::vector<uint32_t> packedNormals(m_heightMapWidth * m_heightMapHeight);
+  void* p = nullptr;
+  vkMapMemory(m_device, readback.memory, 0, VK_WHOLE_SIZE, 0, &p);
+  memcpy(packedNormals.data(), p, bufferSize);
+  vkUnmapMemory(m_device, readback.memory);
+  DestroyBuffer(readback);
+  return packedNormals;
+}
+
+void TessellateGroundApp::PrepareTessCache()
+{
+  // Spb`ő̕ɂȂꍇ̒_Ŋmۂ.
+  QuadDomainTessellator::Levels maxLevels{ { 64.0f, 64.0f, 64.0f, 64.0f }, { 64.0f, 64.0f } };
+  auto maxTriangles = QuadDomainTessellator::Count(maxLevels).triangles * (m_quad.indexCount / 4);
+  m_tessCacheCapacity = uint32_t(3 * maxTriangles);
+  auto bufferSize = uint32_t(sizeof(TessCacheHeader) + sizeof(TessCacheVertex) * m_tessCacheCapacity);
+  m_tessCache = CreateBuffer(bufferSize,
+    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  m_tessCacheReadback = CreateBuffer(sizeof(TessCacheHeader), VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+  {
+    // gpĂȂԂł`ł悤_ 0 ̈Ă.
+    TessCacheHeader header{ { 0, 1, 0, 0 }, m_tessCacheCapacity, 0, 0, 0 };
+    auto command = CreateCommandBuffer();
+    vkCmdUpdateBuffer(command, m_tessCache.buffer, 0, sizeof(header), &header);
+    FinishCommandBuffer(command);
+    DestroyCommandBuffer(command);
+  }
+
+  for (auto& ds : m_dsTessSample)
+  {
+    VkDescriptorBufferInfo cacheInfo{
+      m_tessCache.buffer, 0, VK_WHOLE_SIZE
+    };
+    auto write = book_util::CreateWriteDescriptorSet(ds, 8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &cacheInfo);
+    vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+  }
+
+  if (!m_isVertexPipelineStoresSupported)
+  {
+    // WIgVF[_[珑oȂ߁ALbV͎gpȂ.
+    return;
+  }
+
+  // o̓X^CYȂ߁AA^b`gȂ_[pXg.
+  VkSubpassDescription subpassDesc{
+    0, VK_PIPELINE_BIND_POINT_GRAPHICS,
+    0, nullptr, // InputAttachments
+    0, nullptr, // ColorAttachments
+    nullptr, nullptr, // Resolve, DepthStencil
+    0, nullptr, // PreserveAttachments
+  };
+  VkRenderPassCreateInfo renderPassCI{
+    VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+    nullptr, 0,
+    0, nullptr,
+    1, &subpassDesc,
+    0, nullptr,
+  };
+  VkRenderPass renderPass;
+  auto result = vkCreateRenderPass(m_device, &renderPassCI, nullptr, &renderPass);
+  ThrowIfFailed(result, "vkCreateRenderPass failed.");
+  RegisterRenderPass("tess_capture", renderPass);
+  m_tessCaptureFramebuffer = CreateFramebuffer(renderPass, 1, 1, 0, nullptr);
+
+  VkPipelineLayout layout = GetPipelineLayout("u1t5s4");
+  VkPipelineInputAssemblyStateCreateInfo inputAssemblyCI{
+    VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+    nullptr, 0, VK_PRIMITIVE_TOPOLOGY_PATCH_LIST,
+    VK_FALSE,
+  };
+  VkPipelineTessellationStateCreateInfo tessStateCI{
+    VK_STRUCTURE_TYPE_PIPELINE_TESSELLATION_STATE_CREATE_INFO,
+    nullptr,
+    0,
+    4
+  };
+  VkVertexInputBindingDescription vibDesc{
+    0, uint32_t(sizeof(Vertex)), VK_VERTEX_INPUT_RATE_VERTEX
+  };
+  array<VkVertexInputAttributeDescription, 2> inputAttribs{
+    {
+      { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, Position) },
+      { 1, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, UV) },
+    }
+  };
+  VkPipelineVertexInputStateCreateInfo pipelineVisCI{
+    VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+    nullptr, 0,
+    1, &vibDesc,
+    uint32_t(inputAttribs.size()), inputAttribs.data()
+  };
+  auto rasterizerState = book_util::GetDefaultRasterizerState();
+  rasterizerState.rasterizerDiscardEnable = VK_TRUE;
+
+  std::vector<VkPipelineShaderStageCreateInfo> shaderStages = {
+    book_util::LoadShader(m_device, "tessVS.spv", VK_SHADER_STAGE_VERTEX_BIT),
+    book_util::LoadShader(m_device, "tessTCS.spv", VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT),
+    book_util::LoadShader(m_device, "tessTES.spv", VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT),
+    book_util::LoadShader(m_device, "tessCaptureGS.spv", VK_SHADER_STAGE_GEOMETRY_BIT),
+  };
+  VkGraphicsPipelineCreateInfo pipelineCI{
+    VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO, nullptr, 0,
+  };
+  pipelineCI.stageCount = uint32_t(shaderStages.size());
+  pipelineCI.pStages = shaderStages.data();
+  pipelineCI.pVertexInputState = &pipelineVisCI;
+  pipelineCI.pInputAssemblyState = &inputAssemblyCI;
+  pipelineCI.pTessellationState = &tessStateCI;
+  pipelineCI.pRasterizationState = &rasterizerState;
+  pipelineCI.layout = layout;
+  pipelineCI.renderPass = renderPass;
+  result = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &m_tessCapturePipeline);
+  ThrowIfFailed(result, "vkCreateGraphicsPipelines failed.");
+  book_util::DestroyShaderModules(m_device, shaderStages);
+
+  // oʂ`悷pCvC.
+  vibDesc.stride = uint32_t(sizeof(TessCacheVertex));
+  inputAttribs = {
+    {
+      { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(TessCacheVertex, Position) },
+      { 1, 0, VK_FORMAT_R32_UINT, offsetof(TessCacheVertex, Normal) },
+    }
+  };
+  inputAssemblyCI.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+  auto blendAttachmentState = book_util::GetOpaqueColorBlendAttachmentState();
+  VkPipelineColorBlendStateCreateInfo colorBlendStateCI{
+    VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+    nullptr, 0,
+    VK_FALSE, VK_LOGIC_OP_CLEAR, // logicOpEnable
+    1, &blendAttachmentState,
+    { 0.0f, 0.0f, 0.0f,0.0f }
+  };
+  VkPipelineMultisampleStateCreateInfo multisampleCI{
+    VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+    nullptr, 0,
+    VK_SAMPLE_COUNT_1_BIT,
+    VK_FALSE, // sampleShadingEnable
+    0.0f, nullptr,
+    VK_FALSE, VK_FALSE,
+  };
+  auto extentBackbuffer = m_swapchain->GetSurfaceExtent();
+  auto viewportBackbuffer = book_util::GetViewportFlipped(float(extentBackbuffer.width), float(extentBackbuffer.height));
+  auto scissorBackbuffer = VkRect2D{
+    { 0, 0}, extentBackbuffer
+  };
+  VkPipelineViewportStateCreateInfo viewportStateCI{
+    VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+    nullptr, 0,
+    1, &viewportBackbuffer,
+    1, &scissorBackbuffer,
+  };
+  vector<VkDynamicState> dynamicStates{
+    VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_VIEWPORT
+  };
+  VkPipelineDynamicStateCreateInfo pipelineDynamicStateCI{
+    VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO, nullptr, 0,
+    uint32_t(dynamicStates.size()), dynamicStates.data(),
+  };
+  auto dsState = book_util::GetDefaultDepthStencilState();
+  rasterizerState = book_util::GetDefaultRasterizerState();
+  rasterizerState.cullMode = VK_CULL_MODE_BACK_BIT;
+
+  shaderStages = {
+    book_util::LoadShader(m_device, "tessCacheVS.spv", VK_SHADER_STAGE_VERTEX_BIT),
+    book_util::LoadShader(m_device, "tessFS.spv", VK_SHADER_STAGE_FRAGMENT_BIT)
+  };
+  pipelineCI.stageCount = uint32_t(shaderStages.size());
+  pipelineCI.pStages = shaderStages.data();
+  pipelineCI.pTessellationState = nullptr;
+  pipelineCI.pViewportState = &viewportStateCI;
+  pipelineCI.pMultisampleState = &multisampleCI;
+  pipelineCI.pDepthStencilState = &dsState;
+  pipelineCI.pColorBlendState = &colorBlendStateCI;
+  pipelineCI.pDynamicState = &pipelineDynamicStateCI;
+  pipelineCI.renderPass = GetRenderPass("default");
+  result = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &m_tessCachePipeline);
+  ThrowIfFailed(result, "vkCreateGraphicsPipelines failed.");
+
+  // C[t[`p쐬.
+  rasterizerState.polygonMode = VK_POLYGON_MODE_LINE;
+  result = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &m_tessCacheWired);
+  ThrowIfFailed(result, "vkCreateGraphicsPipelines failed.");
+
+  book_util::DestroyShaderModules(m_device, shaderStages);
+}
+
+void TessellateGroundApp::UpdateTessCacheState(const glm::mat4& view)
+{
+  if (!m_isTessCacheEnabled || m_terrainMode != TerrainMode_Tessellation)
+  {
+    m_isTessCacheValid = false;
+    m_isTessCacheOverflowed = false;
+    m_tessCacheState = TessCacheState_Live;
+    m_tessCachePrevView = view;
+    return;
+  }
+
+  TessCacheKey key;
+  key.cameraPos = m_camera.GetPosition();
+  key.cameraDir = -glm::vec3(view[0][2], view[1][2], view[2][2]);
+  key.factorMode = m_tessFactorMode;
+  key.targetEdgePixels = m_targetEdgePixels;
+  key.isTileStreaming = m_isTileStreaming && m_isTileDataReady;
+  key.extent = m_swapchain->GetSurfaceExtent();
+
+  // ʏł͎̕ɂˑ邽߁A̕ω.
+  // eʂ𒴂ꍇAԂς܂ł͏oȂ.
+  const float cosAngleThreshold = 0.985f; // 10x.
+  const auto& prev = m_tessCacheKey;
+  if (glm::distance(key.cameraPos, prev.cameraPos) > m_tessCacheDistance ||
+    glm::dot(key.cameraDir, prev.cameraDir) < cosAngleThreshold ||
+    key.factorMode != prev.factorMode ||
+    key.targetEdgePixels != prev.targetEdgePixels ||
+    key.isTileStreaming != prev.isTileStreaming ||
+    key.extent.width != prev.extent.width || key.extent.height != prev.extent.height)
+  {
+    m_isTessCacheValid = false;
+    m_isTessCacheOverflowed = false;
+  }
+
+  // J̈ړ͖t[蒼ƂɂȂ邽߁A~܂Ă珑o.
+  bool isCameraStill = view == m_tessCachePrevView;
+  bool isTileIdle = !key.isTileStreaming || (m_tileStreamer.GetPendingCount() == 0 && m_lastTileUploads == 0);
+  m_tessCachePrevView = view;
+  if (m_isTessCacheValid)
+  {
+    m_tessCacheState = TessCacheState_Reuse;
+  }
+  else if (isCameraStill && isTileIdle && !m_isTessCacheOverflowed)
+  {
+    m_tessCacheState = TessCacheState_Capture;
+    m_tessCacheKey = key;
+    m_isTessCacheValid = true;
+  }
+  else
+  {
+    m_tessCacheState = TessCacheState_Live;
+  }
+}
+
+void TessellateGroundApp::RecordTessCacheCapture(VkCommandBuffer command, uint32_t imageIndex)
+{
+  // _ƃJE^ 0 ɖ߂Ă珑o.
+  TessCacheHeader header{ { 0, 1, 0, 0 }, m_tessCacheCapacity, 0, 0, 0 };
+  vkCmdUpdateBuffer(command, m_tessCache.buffer, 0, sizeof(header), &header);
+  VkBufferMemoryBarrier barrier{
+    VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER, nullptr,
+    VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+    m_tessCache.buffer, 0, VK_WHOLE_SIZE
+  };
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_GEOMETRY_SHADER_BIT,
+    0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+  VkRenderPassBeginInfo rpBI{
+    VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+    nullptr,
+    GetRenderPass("tess_capture"),
+    m_tessCaptureFramebuffer,
+    VkRect2D{ { 0, 0 }, { 1, 1 } },
+    0, nullptr
+  };
+  VkDeviceSize offsets[] = { 0 };
+  vkCmdBeginRenderPass(command, &rpBI, VK_SUBPASS_CONTENTS_INLINE);
+  vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, m_tessCapturePipeline);
+  vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, GetPipelineLayout("u1t5s4"), 0, 1, &m_dsTessSample[imageIndex], 0, nullptr);
+  vkCmdBindIndexBuffer(command, m_quad.resIndexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+  vkCmdBindVertexBuffers(command, 0, 1, &m_quad.resVertexBuffer.buffer, offsets);
+  vkCmdDrawIndexed(command, m_quad.indexCount, 1, 0, 0, 0);
+  vkCmdEndRenderPass(command);
+
+  // _obt@, `ƂĎQƂł悤ɂ.
+  barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+  vkCmdPipelineBarrier(command,
+    VK_PIPELINE_STAGE_GEOMETRY_SHADER_BIT,
+    VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+    0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+  // HUD \Ɨeʒ߂̌ô߁A擪ǂݖ߂.
+  VkBufferCopy region{ 0, 0, sizeof(TessCacheHeader) };
+  vkCmdCopyBuffer(command, m_tessCache.buffer, m_tessCacheReadback.buffer, 1, &region);
+}
+
+void TessellateGroundApp::RenderHUD(VkCommandBuffer command)
+{
+  ImGui_ImplVulkan_NewFrame();
+  ImGui_ImplGlfw_NewFrame();
+  ImGui::NewFrame();
+
+  {
+    ImGui::Begin("Control");
+    auto cameraPos = m_camera.GetPosition();
+    ImGui::Text("CameraPos: (%.2f, %.2f, %.2f)", cameraPos.x, cameraPos.y, cameraPos.z);
+    ImGui::Combo("Terrain", &m_terrainMode, "Tessellation\0CDLOD\0\0");
+    ImGui::Checkbox("WireFrame", &m_isWireframe);
+    ImGui::Checkbox("FrustumCulling", &m_isFrustumCulling);
+    ImGui::Checkbox("BackfaceCulling", &m_isBackfaceCulling);
+    if (m_isTileDataReady)
+    {
+      ImGui::Checkbox("TileStreaming", &m_isTileStreaming);
+      int radius = m_tileStreamer.GetStreamRadius();
+      if (ImGui::SliderInt("StreamRadius", &radius, 0, 2))
+      {
+        m_tileStreamer.SetStreamRadius(radius);
+      }
+      ImGui::Text("Tiles: Resident %d/%d, Pending %d, Upload %d",
+        m_tileStreamer.GetResidentCount(), m_tileStreamer.GetSlotCount(),
+        m_tileStreamer.GetPendingCount(), m_lastTileUploads);
+    }
+    if (m_terrainMode == TerrainMode_Tessellation)
+    {
+      ImGui::Combo("TessFactor", &m_tessFactorMode, "Distance\0ScreenSpace\0\0");
+      if (m_tessFactorMode == TessFactorMode_ScreenSpace)
+      {
+        ImGui::SliderFloat("PixelsPerEdge", &m_targetEdgePixels, 2.0f, 64.0f);
+      }
+      if (m_isVertexPipelineStoresSupported)
+      {
+        ImGui::Checkbox("TessCache", &m_isTessCacheEnabled);
+      }
+      else
+      {
+        ImGui::Text("TessCache: Not supported (vertexPipelineStoresAndAtomics)");
+      }
+      if (m_isTessCacheEnabled)
+      {
+        const char* stateNames[] = { "Live", "Capture", "Reuse" };
+        ImGui::SliderFloat("CacheDistance", &m_tessCacheDistance, 0.1f, 10.0f);
+        ImGui::Text("TessCache: %s (Vertices %u/%u)", stateNames[m_tessCacheState], m_tessCacheVertexCount, m_tessCacheCapacity);
+        if (m_isTessCacheOverflowed)
+        {
+          ImGui::Text("TessCache: Overflow (%u triangles dropped)", m_tessCacheOverflowTriangles);
+        }
+      }
+      auto patchCount = m_quad.indexCount / 4;
+      if (!m_isVertexPipelineStoresSupported)
+      {
+        ImGui::Text("Patches: %u (Culling statistics not supported)", patchCount);
+      }
+      else if (m_tessCacheState == TessCacheState_Live)
+      {
+        auto culled = m_lastCullStats.frustumCulledPatches + m_lastCullStats.backfaceCulledPatches;
+        ImGui::Text("Patches: %u (Drawn: %u)", patchCount, patchCount - culled);
+        ImGui::Text("Culled: Frustum %u, Backface %u", m_lastCullStats.frustumCulledPatches, m_lastCullStats.backfaceCulledPatches);
+      }
+      else
+      {
+        // o̓JOȂ߁ALbVɂ͑Spb`܂܂.
+        ImGui::Text("Patches: %u (Drawn: %u, no culling while cached)", patchCount, patchCount);
+      }
+      if (m_isTessEstimatorReady)
+      {
+        ImGui::Text("Estimate(CPU): Vertices %llu, Triangles %llu", m_lastEstimate.vertices, m_lastEstimate.triangles);
+      }
+      if (ImGui::Checkbox("RecordCameraPath", &m_isRecordingCameraPath))
+      {
+        if (m_isRecordingCameraPath)
+        {
+          m_cameraPathFile.open("camera_path.txt", std::ios::app);
+        }
+        else
+        {
+          m_cameraPathFile.close();
+        }
+      }
+    }
+    if (m_terrainMode == TerrainMode_CDLOD)
+    {
+      ImGui::Text("CDLOD Nodes: %u (LOD Levels: %d)", m_cdlodInstanceCount, m_quadtree.GetLodLevels());
+    }
     ImGui::End();
   }
   ImGui::Render();
@@ -2,7 +2,13 @@
 #include "VulkanAppBase.h"
 #include <glm/glm.hpp>
 #include <array>
+#include <fstream>
 #include "Camera.h"
+#include "TerrainQuadtree.h"
+#include "TerrainTileStreamer.h"
+#include "TerrainHeightBounds.h"
+#include "TerrainNormalCones.h"
+#include "GroundTessellationEstimator.h"
 
 class TessellateGroundApp : public VulkanAppBase
 {
@@ -42,9 +48,42 @@ private:
   };
 
   ImageObject Load2DTextureFromFile(const char* fileName);
+  ImageObject CreateTextureFromMemory(uint32_t width, uint32_t height, VkFormat format, const void* data);
   ImageObject LoadCubeTextureFromFile(const char* faceFiles[6]);
 
   void PreparePrimitiveResource();
+  void PrepareCdlodResource();
+
+  // ^CXg[~Op̃\[X.
+  void PrepareTileStreaming();
+  ImageObject CreateTileArrayTexture(uint32_t size, uint32_t layers, VkFormat format);
+  void RecordTileUploads(VkCommandBuffer command, uint32_t imageIndex, const std::vector<TerrainTileStreamer::TileUpload>& uploads);
+  glm::vec4 GetTileParams() const;
+  // `掞ɎQƂŜ̍/@. ^Cgꍇ͏kTρAgȂꍇ͌̃}bv.
+  VkImageView GetTerrainHeightView() const { return m_isTileDataReady ? m_overviewHeightMap.view : m_heightMap.view; }
+  VkImageView GetTerrainNormalView() const { return m_isTileDataReady ? m_overviewNormalMap.view : m_normalMap.view; }
+  // ^CƊTς쐬Ả𑜓x̃}bvƍ쐬p̃\[Xj.
+  void ReleaseSourceMaps();
+
+  // nCg}bv̍ŏ/őls~bh쐬.
+  // ̃nCg}bvQƂ邽߁AReleaseSourceMaps OɌĂяo.
+  void PrepareHeightBounds();
+  void BuildHeightBounds();
+
+  // wʃJOpɃpb`̖@R[OvZ.
+  void PrepareNormalCones();
+
+  // nCg}bv@}bv(ʑ̃GR[h, RG16F)쐬.
+  // ^CƊTς̍쐬ɎgAReleaseSourceMaps Ŕj.
+  void PrepareNormalMap();
+  void BuildNormalMap();
+  // @^C쐬pɓǂݖ߂.
+  std::vector<uint32_t> ReadbackNormalMap();
+
+  // Î~JɃebZ[Vʂobt@֕ێčėp.
+  void PrepareTessCache();
+  void UpdateTessCacheState(const glm::mat4& view);
+  void RecordTessCacheCapture(VkCommandBuffer command, uint32_t imageIndex);
 
   void RenderHUD(VkCommandBuffer command);
 private:
@@ -70,15 +109,165 @@ private:
     glm::mat4 proj;
     glm::vec4 lightPos;
     glm::vec4 cameraPos;
+    glm::vec4 frustumPlanes[6];
+    glm::vec4 cullParams; // x:JO, y:wʃJO, z:XP[.
+    glm::vec4 tileParams; // x,y: ^C(0 Ŗ), z: ^C̉f, w: E.
+    glm::vec4 tessParams; // x: W̌vZ@, y: ڕWƂӂ̒(sNZ), zw: ʃTCY.
+    glm::vec4 heightMapParams; // xy: ̃nCg}bv̉f.
+  };
+  struct CullStatistics
+  {
+    uint32_t frustumCulledPatches;
+    uint32_t backfaceCulledPatches;
   };
   ModelData m_quad;
   ImageObject m_heightMap;
-  ImageObject m_normalMap;
+  ImageObject m_normalMap; // nCg}bv琶(ʑ̃GR[h).
+  uint32_t m_heightMapWidth;
+  uint32_t m_heightMapHeight;
 
   std::vector<BufferObject> m_tessUniform;
+  std::vector<BufferObject> m_cullStatistics;
   std::vector<VkDescriptorSet> m_dsTessSample;
   VkPipeline m_tessGroundPipeline;
   VkPipeline m_tessGroundWired;
 
   bool m_isWireframe;
+  bool m_isFrustumCulling;
+  bool m_isBackfaceCulling;
+  CullStatistics m_lastCullStats;
+  bool m_isVertexPipelineStoresSupported; // TCS/GS Xg[Wobt@֏߂邩(vertexPipelineStoresAndAtomics).
+
+  enum TessFactorMode
+  {
+    TessFactorMode_Distance,
+    TessFactorMode_ScreenSpace,
+  };
+  int m_tessFactorMode;
+  float m_targetEdgePixels;
+
+  // ebZ[Vʂ̃LbV.
+  enum TessCacheState
+  {
+    TessCacheState_Live, // t[ebZ[V.
+    TessCacheState_Capture, // ̃t[ŏoĕ`悷.
+    TessCacheState_Reuse, // oς݂̌ʂ`悷.
+  };
+  struct TessCacheVertex
+  {
+    glm::vec3 Position; // [hW.
+    uint32_t Normal; // ʑ̃GR[h(packSnorm2x16).
+  };
+  // m_tessCache ̐擪. tessCaptureGS.geom  TessellationCache Ɠ.
+  struct TessCacheHeader
+  {
+    VkDrawIndirectCommand drawArgs; // vertexCount ͏߂_.
+    uint32_t capacity;
+    uint32_t allocatedVertices;
+    uint32_t overflowTriangles;
+    uint32_t padding;
+  };
+  // ȍ. ꂩω蒼.
+  struct TessCacheKey
+  {
+    glm::vec3 cameraPos;
+    glm::vec3 cameraDir;
+    int factorMode;
+    float targetEdgePixels;
+    bool isTileStreaming;
+    VkExtent2D extent;
+  };
+  BufferObject m_tessCache; // 擪 TessCacheHeader, ȍ~ TessCacheVertex .
+  BufferObject m_tessCacheReadback;
+  VkFramebuffer m_tessCaptureFramebuffer;
+  VkPipeline m_tessCapturePipeline;
+  VkPipeline m_tessCachePipeline;
+  VkPipeline m_tessCacheWired;
+  bool m_isTessCacheEnabled;
+  bool m_isTessCacheValid;
+  bool m_isTessCacheOverflowed; // eʕsŏoȂ. Ԃς܂ōėpȂ.
+  int m_tessCacheState;
+  float m_tessCacheDistance; // J̋ȏړ蒼.
+  TessCacheKey m_tessCacheKey;
+  glm::mat4 m_tessCachePrevView;
+  VkFence m_tessCacheCaptureFence;
+  uint32_t m_tessCacheVertexCount;
+  uint32_t m_tessCacheCapacity;
+  uint32_t m_tessCacheOverflowTriangles;
+
+  // CPU ł̕ʂ̌ςƃJpX̋L^.
+  GroundTessellationEstimator m_tessEstimator;
+  GroundTessellationEstimator::FrameStats m_lastEstimate;
+  bool m_isTessEstimatorReady;
+  bool m_isRecordingCameraPath;
+  std::ofstream m_cameraPathFile;
+
+  enum TerrainMode
+  {
+    TerrainMode_Tessellation,
+    TerrainMode_CDLOD,
+  };
+  int m_terrainMode;
+
+  // CDLOD n``p.
+  static const uint32_t CdlodGridResolution = 32;
+  static const uint32_t CdlodMaxInstances = 4096;
+  struct CdlodVertex
+  {
+    glm::vec2 Grid; // 0..CdlodGridResolution ̊iqW.
+  };
+  struct CdlodShaderParameters
+  {
+    glm::mat4 world;
+    glm::mat4 view;
+    glm::mat4 proj;
+    glm::vec4 lightPos;
+    glm::vec4 cameraPos;
+    glm::vec4 lodMorph[TerrainQuadtree::MaxLodLevels]; // x: [tJn, y: [tI.
+    glm::vec4 terrainParams; // x: n`TCY, y: XP[, z: iq.
+    glm::vec4 tileParams; // TessellationShaderParameters::tileParams Ɠ.
+  };
+  TerrainQuadtree m_quadtree;
+  ModelData m_cdlodGrid;
+  std::vector<BufferObject> m_cdlodInstances;
+  std::vector<BufferObject> m_cdlodUniform;
+  std::vector<VkDescriptorSet> m_dsCdlod;
+  VkPipeline m_cdlodPipeline;
+  VkPipeline m_cdlodWired;
+  uint32_t m_cdlodInstanceCount;
+
+  // ^CXg[~Op.
+  static const uint32_t TileSlotCount = 32;
+  static const int TileMaxUploadsPerFrame = 4;
+  TerrainTileStreamer m_tileStreamer;
+  ImageObject m_tileHeightArray;
+  ImageObject m_tileNormalArray;
+  ImageObject m_overviewHeightMap; // 풓^C̑ɎQƂk摜.
+  ImageObject m_overviewNormalMap;
+  std::vector<BufferObject> m_tileStaging;
+  std::vector<BufferObject> m_tileIndirection;
+  bool m_isTileStreaming;
+  bool m_isTileDataReady;
+  uint64_t m_frameCount;
+  int m_lastTileUploads;
+
+  // nCg}bv̍ŏ/őls~bh.
+  ImageObject m_heightBoundsImage; // view ͑SxQƂTvOp.
+  std::vector<VkImageView> m_heightBoundsLevelViews;
+  std::vector<VkDescriptorSet> m_dsHeightBounds;
+  VkPipeline m_heightBoundsInitPipeline;
+  VkPipeline m_heightBoundsReducePipeline;
+  TerrainHeightBounds m_heightBounds;
+
+  BufferObject m_normalCones; // pb`̖@R[(tessTCS  binding 9).
+
+  // @}bvp.
+  struct NormalGenParameters
+  {
+    glm::vec4 terrainParams; // x: n`TCY, y: XP[.
+  };
+  BufferObject m_normalGenUniform;
+  BufferObject m_packedNormals;
+  VkDescriptorSet m_dsNormalGen;
+  VkPipeline m_normalGenPipeline;
 };
\ No newline at end of file
@@ -0,0 +1,59 @@
+#version 450
+#extension GL_GOOGLE_include_directive : enable
+
+layout(location=0) in vec2 inGrid;
+layout(location=1) in vec4 inNode; // xy: m[h_(XZ), z: ӂ̒, w: LOD x.
+
+layout(location=0) out vec4 outColor;
+layout(location=1) out vec3 outNormal;
+
+layout(set=0, binding=0)
+uniform CdlodShaderParameters
+{
+  mat4 world;
+  mat4 view;
+  mat4 proj;
+  vec4 lightPos;
+  vec4 cameraPos;
+  vec4 lodMorph[8];   // x: [tJn, y: [tI.
+  vec4 terrainParams; // x: n`TCY, y: XP[, z: iq.
+  vec4 tileParams;    // x,y: ^C(0 Ŗ), z: ^C̉f, w: E.
+};
+
+#include "terrainSample.glsl"
+
+out gl_PerVertex
+{
+  vec4 gl_Position;
+};
+
+vec2 ToUV(vec2 xz)
+{
+  return xz / terrainParams.x + 0.5;
+}
+
+void main()
+{
+  float cellSize = inNode.z / terrainParams.z;
+  vec2 xz = inNode.xy + inGrid * cellSize;
+
+  // J̋Ń[tW߂.
+  float height = SampleTerrainHeight(ToUV(xz), tileParams) * terrainParams.y;
+  float dist = distance((world * vec4(xz.x, height, xz.y, 1)).xyz, cameraPos.xyz);
+  vec2 morphRange = lodMorph[int(inNode.w)].xy;
+  float morphK = clamp((dist - morphRange.x) / (morphRange.y - morphRange.x), 0, 1);
+
+  // Ԗڂ̊iq_ 1 ieiq̈ʒu֊񂹁AאڃxƂ̌pڂ𖳂.
+  vec2 fracPart = fract(inGrid * 0.5) * 2.0;
+  xz -= fracPart * cellSize * morphK;
+
+  vec2 uv = ToUV(xz);
+  vec3 normal;
+  SampleTerrain(uv, tileParams, height, normal);
+  height *= terrainParams.y;
+
+  vec4 pos = vec4(xz.x, height, xz.y, 1);
+  gl_Position = proj * view * world * pos;
+  outColor = vec4(normal.xyz*0.5+0.5, 1);
+  outNormal = mat3(world) * normal;
+}
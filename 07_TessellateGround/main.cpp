@@ -8,6 +8,12 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "VulkanBookUtil.h"
+#include "GroundTessellationEstimator.h"
+#include "TerrainHeightQuery.h"
+#include <shellapi.h>
+#include <string>
+#include <fstream>
+#include <algorithm>
 
 const int WindowWidth = 800, WindowHeight = 600;
 const char* AppTitle = "GroundTessellation";
@@ -84,10 +90,90 @@ static void WindowResizeCallback(GLFWwindow* window, int width, int height)
   pApp->OnSizeChanged(width, height);
 }
 
+static std::vector<std::string> GetCommandLineArgs(LPWSTR lpCmdLine)
+{
+  int argc = 0;
+  auto argv = CommandLineToArgvW(lpCmdLine, &argc);
+  std::vector<std::string> args;
+  for (int i = 0; i < argc; ++i)
+  {
+    char buf[MAX_PATH];
+    WideCharToMultiByte(CP_ACP, 0, argv[i], -1, buf, sizeof(buf), nullptr, nullptr);
+    args.push_back(buf);
+  }
+  LocalFree(argv);
+  return args;
+}
+
+// -tessstats <JpX> <oCSV> [screen <sNZ>]
+// L^JpXɑ΂ĕʂ CPU Ōς(EBhE/GPU ͎gpȂ).
+static bool RunTessellationStats(const std::vector<std::string>& args)
+{
+  if (args.size() < 3 || args[0] != "-tessstats")
+  {
+    return false;
+  }
+
+  GroundTessellationEstimator::Settings settings{ true, true, 0, 8.0f };
+  if (args.size() >= 5 && args[3] == "screen")
+  {
+    settings.factorMode = 1;
+    settings.targetEdgePixels = float(atof(args[4].c_str()));
+  }
+  GroundTessellationEstimator estimator;
+  if (!estimator.Setup("heightmap.png", 200.0f, 25.0f, 10) ||
+    !estimator.EvaluateCameraPath(args[1].c_str(), args[2].c_str(), settings))
+  {
+    OutputDebugStringA("tessstats failed.\n");
+  }
+  return true;
+}
+
+// -heightbench <o̓t@C>
+// n`̍/@₢킹̏\(NG/b)XJ[ł AVX2 łŌv.
+static bool RunHeightQueryBenchmark(const std::vector<std::string>& args)
+{
+  if (args.size() < 2 || args[0] != "-heightbench")
+  {
+    return false;
+  }
+
+  TerrainHeightQuery query;
+  if (!query.Setup("heightmap.png", 200.0f, 25.0f))
+  {
+    OutputDebugStringA("heightbench failed.\n");
+    return true;
+  }
+  std::ofstream ofs(args[1]);
+  ofs << "simd,queries,height_qps,normal_qps" << std::endl;
+  const size_t queryCounts[] = { 1024, 16384, 262144 };
+  for (int simd = 0; simd < 2; ++simd)
+  {
+    query.SetUseSimd(simd != 0);
+    if (query.IsUsingSimd() != (simd != 0))
+    {
+      continue;
+    }
+    for (auto count : queryCounts)
+    {
+      // 1 ̌vł悻 1600 NGxɂȂ悤JԂ.
+      int iterations = int((std::max)(size_t(1), (size_t(1) << 24) / count));
+      ofs << simd << "," << count << ","
+        << query.MeasureHeightQueriesPerSecond(count, iterations) << ","
+        << query.MeasureNormalQueriesPerSecond(count, iterations) << std::endl;
+    }
+  }
+  return true;
+}
+
 int __stdcall wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCmdShow)
 {
   UNREFERENCED_PARAMETER(hPrevInstance);
-  UNREFERENCED_PARAMETER(lpCmdLine);
+  auto args = GetCommandLineArgs(lpCmdLine);
+  if (RunTessellationStats(args) || RunHeightQueryBenchmark(args))
+  {
+    return 0;
+  }
   glfwInit();
   glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
   glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
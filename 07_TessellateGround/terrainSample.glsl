@@ -0,0 +1,75 @@
+// n`̍Ɩ@̎Q(TCS/TES/CDLOD ŋ).
+// 풓Ă^C΂AȂΑŜkTςQƂ.
+
+layout(set=0, binding=1)
+uniform sampler2D texSampler; // Tς̍.
+layout(set=0, binding=2)
+uniform sampler2D normalSampler; // Tς̖@(ʑ̃GR[h).
+layout(set=0, binding=4)
+uniform sampler2DArray tileHeightSampler;
+layout(set=0, binding=5)
+uniform sampler2DArray tileNormalSampler; // normalSampler Ɠʑ̃GR[h.
+layout(set=0, binding=6)
+readonly buffer TileIndirection
+{
+  int tileLayers[];
+};
+
+// ʑ̃GR[hꂽ@(Y )𕜌.
+vec3 DecodeOctNormal(vec2 e)
+{
+  vec3 n = vec3(e.x, 1 - abs(e.x) - abs(e.y), e.y);
+  if( n.y < 0 )
+  {
+    n.xz = (1 - abs(n.zx)) * vec2(n.x >= 0 ? 1 : -1, n.z >= 0 ? 1 : -1);
+  }
+  return normalize(n);
+}
+
+// ^C풓Ă΃^Cz̍W(z ̓C[)Ԃ.
+// tileParams  x,y:^C(0 Ŗ), z:^C̉f, w:E.
+bool FindTile(vec2 uv, vec4 tileParams, out vec3 tuv)
+{
+  tuv = vec3(0);
+  if( tileParams.x <= 0 )
+  {
+    return false;
+  }
+  vec2 tiles = tileParams.xy;
+  vec2 tileCoord = clamp(uv * tiles, vec2(0), tiles - 0.0001);
+  ivec2 tile = ivec2(floor(tileCoord));
+  int layer = tileLayers[tile.y * int(tiles.x) + tile.x];
+  if( layer < 0 )
+  {
+    return false;
+  }
+  vec2 local = (tileCoord - vec2(tile)) * tileParams.z + tileParams.w;
+  tuv = vec3(local / (tileParams.z + 2 * tileParams.w), layer);
+  return true;
+}
+
+// (0..1)Ԃ.
+float SampleTerrainHeight(vec2 uv, vec4 tileParams)
+{
+  vec3 tuv;
+  if( FindTile(uv, tileParams, tuv) )
+  {
+    return textureLod(tileHeightSampler, tuv, 0).x;
+  }
+  return textureLod(texSampler, uv, 0).x;
+}
+
+void SampleTerrain(vec2 uv, vec4 tileParams, out float height, out vec3 normal)
+{
+  vec3 tuv;
+  if( FindTile(uv, tileParams, tuv) )
+  {
+    height = textureLod(tileHeightSampler, tuv, 0).x;
+    normal = DecodeOctNormal(textureLod(tileNormalSampler, tuv, 0).xy);
+  }
+  else
+  {
+    height = textureLod(texSampler, uv, 0).x;
+    normal = DecodeOctNormal(textureLod(normalSampler, uv, 0).xy);
+  }
+}
@@ -0,0 +1,42 @@
+#version 450
+
+// tessCaptureGS ŏoebZ[Vʂ`悷.
+layout(location=0) in vec3 inPos; // [hW.
+layout(location=1) in uint inNormal;
+
+layout(location=0) out vec4 outColor;
+layout(location=1) out vec3 outNormal;
+
+layout(set=0, binding=0)
+uniform TessShaderParameters
+{
+  mat4 world;
+  mat4 view;
+  mat4 proj;
+  vec4 lightPos;
+  vec4 cameraPos;
+};
+
+out gl_PerVertex
+{
+  vec4 gl_Position;
+};
+
+// ʑ̃GR[hꂽ@(Y )𕜌.
+vec3 DecodeOctNormal(vec2 e)
+{
+  vec3 n = vec3(e.x, 1 - abs(e.x) - abs(e.y), e.y);
+  if( n.y < 0 )
+  {
+    n.xz = (1 - abs(n.zx)) * vec2(n.x >= 0 ? 1 : -1, n.z >= 0 ? 1 : -1);
+  }
+  return normalize(n);
+}
+
+void main()
+{
+  gl_Position = proj * view * vec4(inPos, 1);
+  vec3 normal = DecodeOctNormal(unpackSnorm2x16(inNormal));
+  outColor = vec4(normal*0.5+0.5, 1);
+  outNormal = normal;
+}
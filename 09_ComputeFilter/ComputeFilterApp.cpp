@@ -1,9 +1,9 @@
 #include "ComputeFilterApp.h"
-#include "TeapotModel.h"
 #include "VulkanBookUtil.h"
 
 
 #include <array>
+#include <algorithm>
 
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -18,6 +18,14 @@ using namespace std;
 ComputeFilterApp::ComputeFilterApp()
 {
   m_selectedFilter = 0;
+  m_uploadMode = UploadMode_CopyBufferToImage;
+  m_isSourceDirty = false;
+  m_sourceWidth = m_sourceHeight = 0;
+}
+
+void ComputeFilterApp::SetComputeUnpackAtStartup(bool enable)
+{
+  m_uploadMode = enable ? UploadMode_ComputeUnpack : UploadMode_CopyBufferToImage;
 }
 
 void ComputeFilterApp::Prepare()
@@ -46,6 +54,7 @@ void ComputeFilterApp::Prepare()
   PrepareSceneResource();
 
   PrepareComputeResource();
+  PrepareUploadResource();
   CreatePrimitiveResource();
 }
 
@@ -82,6 +91,16 @@ void ComputeFilterApp::CreateSampleLayouts()
   ThrowIfFailed(result, "vkCreateDescriptorSetLayout Failed.");
   RegisterLayout("compute_filter", dsLayout);
 
+  // 0: Xg[Wobt@(pbNς RGBA8), 1: ݐC[W.
+  dsLayoutBindings = {
+    { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, },
+    { 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, },
+  };
+  dsLayoutCI.bindingCount = uint32_t(dsLayoutBindings.size());
+  dsLayoutCI.pBindings = dsLayoutBindings.data();
+  result = vkCreateDescriptorSetLayout(m_device, &dsLayoutCI, nullptr, &dsLayout);
+  ThrowIfFailed(result, "vkCreateDescriptorSetLayout Failed.");
+  RegisterLayout("compute_unpack", dsLayout);
 
   // pCvCCAEg̏
   VkPipelineLayoutCreateInfo layoutCI{
@@ -105,6 +124,13 @@ void ComputeFilterApp::CreateSampleLayouts()
   result = vkCreatePipelineLayout(m_device, &layoutCI, nullptr, &layout);
   ThrowIfFailed(result, "vkCreatePipelineLayout Failed.");
   RegisterLayout("compute_filter", layout);
+
+  dsLayout = GetDescriptorSetLayout("compute_unpack");
+  layoutCI.setLayoutCount = 1;
+  layoutCI.pSetLayouts = &dsLayout;
+  result = vkCreatePipelineLayout(m_device, &layoutCI, nullptr, &layout);
+  ThrowIfFailed(result, "vkCreatePipelineLayout Failed.");
+  RegisterLayout("compute_unpack", layout);
 }
 
 void ComputeFilterApp::Cleanup()
@@ -117,10 +143,12 @@ void ComputeFilterApp::Cleanup()
 
   DestroyImage(m_sourceBuffer);
   DestroyImage(m_destBuffer);
+  DestroyBuffer(m_uploadBuffer);
 
   vkDestroySampler(m_device, m_texSampler, nullptr);
 
   vkFreeDescriptorSets(m_device, m_descriptorPool, 1, &m_dsWriteToTexture);
+  vkFreeDescriptorSets(m_device, m_descriptorPool, 1, &m_dsUnpackToTexture);
   for (auto ds : m_dsDrawTextures)
   {
     vkFreeDescriptorSets(m_device, m_descriptorPool, uint32_t(ds.size()), ds.data());
@@ -133,6 +161,7 @@ void ComputeFilterApp::Cleanup()
   vkDestroyPipeline(m_device, m_pipeline, nullptr);
   vkDestroyPipeline(m_device, m_compSepiaPipeline, nullptr);
   vkDestroyPipeline(m_device, m_compSobelPipeline, nullptr);
+  vkDestroyPipeline(m_device, m_compUnpackPipeline, nullptr);
 
   DestroyImage(m_depthBuffer);
   auto count = uint32_t(m_framebuffers.size());
@@ -208,9 +237,41 @@ void ComputeFilterApp::Render()
 
   auto command = m_commandBuffers[imageIndex].commandBuffer;
 
+  // ͉摜ςƂ(Abv[h̐؂ւ܂)ƗpC[W蒼.
+  if (m_isSourceDirty && m_uploadMode == UploadMode_CopyBufferToImage)
+  {
+    // Õt[ƗpC[WQƂIĂXe[WOoRœ].
+    vkDeviceWaitIdle(m_device);
+    UploadTextureFromFile("image.png", m_sourceBuffer.image, VK_IMAGE_LAYOUT_GENERAL);
+    m_isSourceDirty = false;
+  }
+
   vkBeginCommandBuffer(command, &commandBI);
 
   // OtBbNXT|[gL[ł́A_[pX̊OŃRs[gVF[_[͎sKv.
+  if (m_isSourceDirty)
+  {
+    // Xg[Wobt@̉fƗpC[W֓WJ.
+    auto unpackLayout = GetPipelineLayout("compute_unpack");
+    vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_COMPUTE, unpackLayout, 0, 1, &m_dsUnpackToTexture, 0, nullptr);
+    vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_COMPUTE, m_compUnpackPipeline);
+    vkCmdDispatch(command, (m_sourceWidth + 15) / 16, (m_sourceHeight + 15) / 16, 1);
+
+    // WJʂtB^ǂ߂悤ɂ.
+    VkMemoryBarrier memoryBarrier{
+      VK_STRUCTURE_TYPE_MEMORY_BARRIER, nullptr,
+      VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+    };
+    vkCmdPipelineBarrier(command,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      0,
+      1, &memoryBarrier,
+      0, nullptr,
+      0, nullptr);
+    m_isSourceDirty = false;
+  }
+
   auto pipelineLayout = GetPipelineLayout("compute_filter");
   vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &m_dsWriteToTexture, 0, nullptr);
   if (m_selectedFilter == 0)
@@ -502,20 +563,52 @@ void ComputeFilterApp::PrepareSceneResource()
   };
   vkCreateSampler(m_device, &samplerCI, nullptr, &m_texSampler);
 
-  m_sourceBuffer = Load2DTextureFromFile("image.png", VK_IMAGE_LAYOUT_GENERAL);
+  int width = 0, height = 0;
+  if (stbi_info("image.png", &width, &height, nullptr) == 0)
+  {
+    throw book_util::VulkanException("image.png load failed.");
+  }
+  m_sourceWidth = uint32_t(width);
+  m_sourceHeight = uint32_t(height);
+
+  if (m_uploadMode == UploadMode_ComputeUnpack)
+  {
+    // f͍ŏ̃t[ŃXg[Wobt@WJ邽߁AXe[WORs[͍sȂ.
+    // WJƂď߂悤 GENERAL ֈڂĂ.
+    m_sourceBuffer = Create2DTexture(m_sourceWidth, m_sourceHeight);
+    auto command = CreateCommandBuffer();
+    vkCmdPipelineBarrier(command,
+      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      0,
+      0, nullptr,
+      0, nullptr,
+      1, &CreateImageMemoryBarrier(m_sourceBuffer.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL));
+    FinishCommandBuffer(command);
+    m_isSourceDirty = true;
+  }
+  else
+  {
+    m_sourceBuffer = Load2DTextureFromFile("image.png", VK_IMAGE_LAYOUT_GENERAL);
+  }
 }
 
 ComputeFilterApp::ImageObject ComputeFilterApp::Load2DTextureFromFile(const char* fileName, VkImageLayout layout)
 {
-  int width, height;
-  stbi_uc* rawimage = nullptr;
-  rawimage = stbi_load(fileName, &width, &height, nullptr, 4);
+  int width = 0, height = 0;
+  stbi_info(fileName, &width, &height, nullptr);
+  auto texture = Create2DTexture(uint32_t(width), uint32_t(height));
+  UploadTextureFromFile(fileName, texture.image, layout);
+  return texture;
+}
 
+ComputeFilterApp::ImageObject ComputeFilterApp::Create2DTexture(uint32_t width, uint32_t height)
+{
   VkImageCreateInfo imageCI{
     VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO, nullptr,
     0,
     VK_IMAGE_TYPE_2D,
-    VK_FORMAT_R8G8B8A8_UNORM, { uint32_t(width), uint32_t(height), 1u },
+    VK_FORMAT_R8G8B8A8_UNORM, { width, height, 1u },
     1, 1,
     VK_SAMPLE_COUNT_1_BIT,
     VK_IMAGE_TILING_OPTIMAL,
@@ -551,6 +644,23 @@ ComputeFilterApp::ImageObject ComputeFilterApp::Load2DTextureFromFile(const char
   VkImageView view;
   result = vkCreateImageView(m_device, &viewCI, nullptr, &view);
 
+  ImageObject texture;
+  texture.image = image;
+  texture.memory = memory;
+  texture.view = view;
+  return texture;
+}
+
+void ComputeFilterApp::UploadTextureFromFile(const char* fileName, VkImage image, VkImageLayout layout)
+{
+  int width, height;
+  stbi_uc* rawimage = nullptr;
+  rawimage = stbi_load(fileName, &width, &height, nullptr, 4);
+  if (rawimage == nullptr)
+  {
+    throw book_util::VulkanException(std::string(fileName) + " load failed.");
+  }
+
   // Xe[WOp
   auto bufferSize = uint32_t(width * height * sizeof(uint32_t));
   BufferObject buffersSrc;
@@ -608,13 +718,6 @@ ComputeFilterApp::ImageObject ComputeFilterApp::Load2DTextureFromFile(const char
 
   stbi_image_free(rawimage);
   DestroyBuffer(buffersSrc);
-
-  ImageObject texture;
-  texture.image = image;
-  texture.memory = memory;
-  texture.view = view;
-  return texture;
-
 }
 
 void ComputeFilterApp::PrepareComputeResource()
@@ -784,6 +887,123 @@ void ComputeFilterApp::PrepareComputeResource()
   
 }
 
+VkMemoryPropertyFlags ComputeFilterApp::SelectUploadMemoryProperties(uint32_t memoryTypeBits) const
+{
+  // GPU 璼ړǂ߂zXg(ReBAR)D悵AȂ΃zXgLbVtg.
+  VkMemoryPropertyFlags candidates[] = {
+    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+  };
+  for (auto props : candidates)
+  {
+    if (GetMemoryTypeIndex(memoryTypeBits, props) != ~0u)
+    {
+      return props;
+    }
+  }
+  return VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+}
+
+ComputeFilterApp::BufferObject ComputeFilterApp::LoadImageToStorageBuffer(const char* fileName)
+{
+  int width, height;
+  stbi_uc* rawimage = nullptr;
+  rawimage = stbi_load(fileName, &width, &height, nullptr, 4);
+  if (rawimage == nullptr)
+  {
+    throw book_util::VulkanException(std::string(fileName) + " load failed.");
+  }
+
+  // fR[h摜Ɠ傫̃obt@pӂ(ƗpC[W傫).
+  auto bufferSize = size_t(width) * height * sizeof(uint32_t);
+
+  VkBufferCreateInfo bufferCI{
+    VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+    nullptr, 0,
+    bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT,
+    VK_SHARING_MODE_EXCLUSIVE,
+    0, nullptr
+  };
+  // gp\ȃ^Cv𒲂ׂ邽߂ɉ̃obt@.
+  VkBuffer probe;
+  auto result = vkCreateBuffer(m_device, &bufferCI, nullptr, &probe);
+  ThrowIfFailed(result, "vkCreateBuffer Failed.");
+  VkMemoryRequirements reqs;
+  vkGetBufferMemoryRequirements(m_device, probe, &reqs);
+  vkDestroyBuffer(m_device, probe, nullptr);
+
+  m_uploadMemProps = SelectUploadMemoryProperties(reqs.memoryTypeBits);
+  auto buffer = CreateStorageBuffer(bufferSize, 0, m_uploadMemProps);
+
+  // fR[hʂ}bv֒ڏ.
+  uint8_t* p = nullptr;
+  vkMapMemory(m_device, buffer.memory, 0, VK_WHOLE_SIZE, 0, (void**)&p);
+  memcpy(p, rawimage, bufferSize);
+  if ((m_uploadMemProps & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0)
+  {
+    VkMappedMemoryRange range{
+      VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, nullptr,
+      buffer.memory, 0, VK_WHOLE_SIZE
+    };
+    vkFlushMappedMemoryRanges(m_device, 1, &range);
+  }
+  vkUnmapMemory(m_device, buffer.memory);
+
+  stbi_image_free(rawimage);
+  return buffer;
+}
+
+void ComputeFilterApp::PrepareUploadResource()
+{
+  m_uploadBuffer = LoadImageToStorageBuffer("image.png");
+
+  VkResult result;
+  VkDescriptorSetLayout dsLayout = GetDescriptorSetLayout("compute_unpack");
+  VkDescriptorSetAllocateInfo dsAI{
+    VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+    nullptr, m_descriptorPool,
+    1, &dsLayout
+  };
+  result = vkAllocateDescriptorSets(m_device, &dsAI, &m_dsUnpackToTexture);
+  ThrowIfFailed(result, "vkAllocateDescriptorSets failed.");
+
+  VkDescriptorBufferInfo sourcePixels = {
+    m_uploadBuffer.buffer, 0, VK_WHOLE_SIZE
+  };
+  VkDescriptorImageInfo destImage = {
+    m_texSampler, m_sourceBuffer.view, VK_IMAGE_LAYOUT_GENERAL,
+  };
+  std::vector<VkWriteDescriptorSet> writeDS = {
+    book_util::CreateWriteDescriptorSet(m_dsUnpackToTexture, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, &sourcePixels),
+    book_util::CreateWriteDescriptorSet(m_dsUnpackToTexture, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &destImage),
+  };
+  vkUpdateDescriptorSets(m_device, uint32_t(writeDS.size()), writeDS.data(), 0, nullptr);
+
+  // pCvC\z(摜̑傫͓ꉻ萔œn).
+  auto computeStage = book_util::LoadShader(m_device, "unpackCS.spv", VK_SHADER_STAGE_COMPUTE_BIT);
+  const uint32_t sourceSize[] = { m_sourceWidth, m_sourceHeight };
+  const VkSpecializationMapEntry sizeEntries[] = {
+    { 0, 0, sizeof(uint32_t) },
+    { 1, sizeof(uint32_t), sizeof(uint32_t) },
+  };
+  VkSpecializationInfo specializationInfo{
+    _countof(sizeEntries), sizeEntries,
+    sizeof(sourceSize), sourceSize,
+  };
+  computeStage.pSpecializationInfo = &specializationInfo;
+  VkComputePipelineCreateInfo pipelineCI{
+    VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO, nullptr, 0,
+    computeStage,
+    GetPipelineLayout("compute_unpack"),
+    VK_NULL_HANDLE,
+    0,
+  };
+  result = vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &m_compUnpackPipeline);
+  ThrowIfFailed(result, "vkCreateComputePipelines failed.");
+  vkDestroyShaderModule(m_device, computeStage.module, nullptr);
+}
+
 void ComputeFilterApp::RenderHUD(VkCommandBuffer command)
 {
   ImGui_ImplVulkan_NewFrame();
@@ -795,6 +1015,16 @@ void ComputeFilterApp::RenderHUD(VkCommandBuffer command)
   ImGui::Text("Framerate %.3f ms", 1000.0f / framerate);
 
   ImGui::Combo("Filter", &m_selectedFilter, "Sepia Filter\0Sobel Filter\0\0");
+  if (ImGui::Combo("Upload", &m_uploadMode, "CopyBufferToImage\0Compute Unpack\0\0"))
+  {
+    m_isSourceDirty = true;
+  }
+  if (m_uploadMode == UploadMode_ComputeUnpack)
+  {
+    bool isDeviceLocal = (m_uploadMemProps & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0;
+    bool isCached = (m_uploadMemProps & VK_MEMORY_PROPERTY_HOST_CACHED_BIT) != 0;
+    ImGui::Text("Upload Memory: %s", isDeviceLocal ? "DeviceLocal+HostVisible" : (isCached ? "HostCached" : "HostVisible"));
+  }
   ImGui::End();
 
   ImGui::Render();
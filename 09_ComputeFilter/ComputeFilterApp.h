@@ -9,6 +9,9 @@ class ComputeFilterApp : public VulkanAppBase
 public:
   ComputeFilterApp();
 
+  // ÑAbv[hI(Initialize ̑OɌĂ).
+  void SetComputeUnpackAtStartup(bool enable);
+
   virtual void Prepare();
   virtual void Cleanup();
   virtual void Render();
@@ -35,6 +38,14 @@ private:
   };
 
   ImageObject Load2DTextureFromFile(const char* fileName, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  ImageObject Create2DTexture(uint32_t width, uint32_t height);
+  // Xe[WOobt@oRŉ摜t@C̓eC[W֓].
+  void UploadTextureFromFile(const char* fileName, VkImage image, VkImageLayout layout);
+
+  // zXg猩Xg[Wobt@։摜𒼐ړǂݍ(Xe[WORs[Ȃ).
+  BufferObject LoadImageToStorageBuffer(const char* fileName);
+  VkMemoryPropertyFlags SelectUploadMemoryProperties(uint32_t memoryTypeBits) const;
+  void PrepareUploadResource();
 
 
   void RenderHUD(VkCommandBuffer command);
@@ -60,6 +71,7 @@ private:
   VkPipeline   m_pipeline;
   VkPipeline   m_compSepiaPipeline;
   VkPipeline   m_compSobelPipeline;
+  VkPipeline   m_compUnpackPipeline;
 
   VkSampler m_texSampler;
   glm::mat4 m_projection;
@@ -68,7 +80,19 @@ private:
 
   ImageObject m_destBuffer;
   ImageObject m_sourceBuffer;
-  
+
+  enum UploadMode
+  {
+    UploadMode_CopyBufferToImage,
+    UploadMode_ComputeUnpack,
+  };
+  int m_uploadMode;
+  BufferObject m_uploadBuffer;
+  VkMemoryPropertyFlags m_uploadMemProps;
+  VkDescriptorSet m_dsUnpackToTexture;
+  bool m_isSourceDirty; // ƗpC[W͉֓摜WJKv邩.
+  uint32_t m_sourceWidth, m_sourceHeight; // ͉摜̑傫.
+
   BufferObject CreateStorageBuffer(size_t bufferSize, VkBufferUsageFlags usage, VkMemoryPropertyFlags props);
   VkImageMemoryBarrier CreateImageMemoryBarrier(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout);
 };
\ No newline at end of file
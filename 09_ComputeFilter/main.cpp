@@ -87,7 +87,6 @@ static void WindowResizeCallback(GLFWwindow* window, int width, int height)
 int __stdcall wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCmdShow)
 {
   UNREFERENCED_PARAMETER(hPrevInstance);
-  UNREFERENCED_PARAMETER(lpCmdLine);
   glfwInit();
   glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
   glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
@@ -104,6 +103,9 @@ int __stdcall wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCm
   ComputeFilterApp theApp;
   glfwSetWindowUserPointer(window, &theApp);
 
+  // -unpack w肷ƃXe[WOoRRs[gVF[_[œWJԂn߂.
+  theApp.SetComputeUnpackAtStartup(wcsstr(lpCmdLine, L"-unpack") != nullptr);
+
   try
   {
     VkFormat surfaceFormat = VK_FORMAT_B8G8R8A8_UNORM;
@@ -0,0 +1,49 @@
+#include "TeapotMeshConverter.h"
+
+#include <cstdio>
+#include <string>
+
+// 03_HelloGeometryShader, 04_CubemapRendering ǂݍރeB[|bg̃bVt@Co.
+// g: TeapotMeshConverter <common tH_> <o͐tH_>...
+// L^ꂽ\[XnbVvt@C͂̂܂܎c.
+int main(int argc, char* argv[])
+{
+  if (argc < 3)
+  {
+    fprintf(stderr, "usage: TeapotMeshConverter <common directory> <output directory>...\n");
+    return 1;
+  }
+
+  const VertexQuantizer::NormalEncoding encodings[] = {
+    VertexQuantizer::NormalEncoding_Float32,
+    VertexQuantizer::NormalEncoding_Oct16,
+    VertexQuantizer::NormalEncoding_Packed1010102,
+  };
+  int result = 0;
+  for (int i = 2; i < argc; ++i)
+  {
+    for (auto encoding : encodings)
+    {
+      uint64_t sourceHash;
+      if (!TeapotMeshConverter::CalcSourceHash(argv[1], encoding, sourceHash))
+      {
+        fprintf(stderr, "%s: source files not found\n", argv[1]);
+        return 1;
+      }
+      auto fileName = std::string(argv[i]) + "/" + TeapotMeshConverter::GetFileName(encoding);
+      if (TeapotMeshConverter::IsUpToDate(fileName.c_str(), sourceHash))
+      {
+        printf("%s: up to date\n", fileName.c_str());
+        continue;
+      }
+      if (!TeapotMeshConverter::Convert(fileName.c_str(), encoding, sourceHash))
+      {
+        fprintf(stderr, "%s: failed\n", fileName.c_str());
+        result = 1;
+        continue;
+      }
+      printf("%s: converted\n", fileName.c_str());
+    }
+  }
+  return result;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// r[EvWFNVs񂩂王 6 ʂ߂. ʂ͓ŁA@͐Kς.
+namespace FrustumPlanes
+{
+  // ߕʂ͊ł͐[x -1..1 ͈̔͂OƂ(0..1 ̎ˉesɑ΂ĂL߂ɔ肷邾ōς).
+  // ˉes 0..1 ͈̔͂ł邱ƂmȂ isDepthZeroToOne Ōȋߕʂɂ.
+  inline void Calc(const glm::mat4& viewProj, glm::vec4 planes[6], bool isDepthZeroToOne = false)
+  {
+    // s̊esoĕʂ\z.
+    auto row = [&](int i) { return glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]); };
+    planes[0] = row(3) + row(0); // Left
+    planes[1] = row(3) - row(0); // Right
+    planes[2] = row(3) + row(1); // Bottom
+    planes[3] = row(3) - row(1); // Top
+    planes[4] = isDepthZeroToOne ? row(2) : row(3) + row(2); // Near
+    planes[5] = row(3) - row(2); // Far
+    for (int i = 0; i < 6; ++i)
+    {
+      planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
+  }
+}
@@ -0,0 +1,276 @@
+#include "MeshFile.h"
+#include <fstream>
+#include <cstring>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  uint64_t AlignUp(uint64_t v, uint64_t alignment)
+  {
+    return (v + alignment - 1) / alignment * alignment;
+  }
+}
+
+bool MeshFile::Write(const char* fileName, const std::vector<StreamSource>& streams, uint32_t vertexCount,
+  const uint32_t* indices, uint32_t indexCount, const float boundsMin[3], const float boundsMax[3],
+  const std::vector<Meshlet>& meshlets, const SourceInfo& source)
+{
+  if (streams.empty() || streams.size() > MaxStreams)
+  {
+    return false;
+  }
+  Header header{};
+  header.signature = Signature;
+  header.version = Version;
+  header.headerSize = sizeof(Header);
+  header.vertexCount = vertexCount;
+  header.indexCount = indexCount;
+  header.streamCount = uint32_t(streams.size());
+  for (int i = 0; i < 3; ++i)
+  {
+    header.boundsMin[i] = boundsMin[i];
+    header.boundsMax[i] = boundsMax[i];
+  }
+
+  uint64_t offset = AlignUp(sizeof(Header), DataAlignment);
+  for (size_t i = 0; i < streams.size(); ++i)
+  {
+    const auto& src = streams[i];
+    if (src.attributes.size() > MaxAttributes)
+    {
+      return false;
+    }
+    auto& stream = header.streams[i];
+    stream.stride = src.stride;
+    stream.attributeCount = uint32_t(src.attributes.size());
+    for (size_t j = 0; j < src.attributes.size(); ++j)
+    {
+      stream.attributes[j] = src.attributes[j];
+    }
+    stream.dataOffset = offset;
+    stream.dataSize = uint64_t(src.stride) * vertexCount;
+    offset = AlignUp(offset + stream.dataSize, DataAlignment);
+  }
+  header.indexOffset = offset;
+  header.indexSize = sizeof(uint32_t) * uint64_t(indexCount);
+  offset = AlignUp(offset + header.indexSize, DataAlignment);
+  header.meshletCount = uint32_t(meshlets.size());
+  header.meshletOffset = offset;
+  header.meshletSize = sizeof(Meshlet) * uint64_t(meshlets.size());
+  header.fileSize = AlignUp(offset + header.meshletSize, DataAlignment);
+  header.sourceHash = source.hash;
+  header.sourceAcmr = source.acmr;
+  header.sourceAtvr = source.atvr;
+
+  std::ofstream outfile(fileName, std::ios::binary);
+  if (!outfile)
+  {
+    return false;
+  }
+  auto writeAt = [&](uint64_t position, const void* data, uint64_t size) {
+    // E킹̌Ԃ 0 Ŗ߂.
+    static const char zeros[DataAlignment] = {};
+    auto current = uint64_t(outfile.tellp());
+    outfile.write(zeros, std::streamsize(position - current));
+    outfile.write(static_cast<const char*>(data), std::streamsize(size));
+  };
+  writeAt(0, &header, sizeof(header));
+  for (uint32_t i = 0; i < header.streamCount; ++i)
+  {
+    writeAt(header.streams[i].dataOffset, streams[i].data, header.streams[i].dataSize);
+  }
+  writeAt(header.indexOffset, indices, header.indexSize);
+  writeAt(header.meshletOffset, meshlets.data(), header.meshletSize);
+  writeAt(header.fileSize, nullptr, 0);
+  return bool(outfile);
+}
+
+MappedMeshFile::MappedMeshFile()
+  : m_data(nullptr), m_size(0)
+#if defined(_WIN32)
+  , m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr)
+#else
+  , m_file(-1)
+#endif
+{
+}
+
+MappedMeshFile::~MappedMeshFile()
+{
+  Close();
+}
+
+bool MappedMeshFile::Open(const char* fileName)
+{
+  Close();
+#if defined(_WIN32)
+  m_file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (m_file == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart < LONGLONG(sizeof(MeshFile::Header)))
+  {
+    Close();
+    return false;
+  }
+  m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (m_mapping == nullptr)
+  {
+    Close();
+    return false;
+  }
+  m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+  m_size = uint64_t(fileSize.QuadPart);
+#else
+  m_file = open(fileName, O_RDONLY);
+  if (m_file < 0)
+  {
+    return false;
+  }
+  struct stat st;
+  if (fstat(m_file, &st) != 0 || st.st_size < off_t(sizeof(MeshFile::Header)))
+  {
+    Close();
+    return false;
+  }
+  auto p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, m_file, 0);
+  m_data = p != MAP_FAILED ? static_cast<const uint8_t*>(p) : nullptr;
+  m_size = uint64_t(st.st_size);
+#endif
+  if (m_data == nullptr || !Validate())
+  {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void MappedMeshFile::Close()
+{
+#if defined(_WIN32)
+  if (m_data != nullptr)
+  {
+    UnmapViewOfFile(m_data);
+  }
+  if (m_mapping != nullptr)
+  {
+    CloseHandle(m_mapping);
+  }
+  if (m_file != INVALID_HANDLE_VALUE)
+  {
+    CloseHandle(m_file);
+  }
+  m_mapping = nullptr;
+  m_file = INVALID_HANDLE_VALUE;
+#else
+  if (m_data != nullptr)
+  {
+    munmap(const_cast<uint8_t*>(m_data), size_t(m_size));
+  }
+  if (m_file >= 0)
+  {
+    close(m_file);
+  }
+  m_file = -1;
+#endif
+  m_data = nullptr;
+  m_size = 0;
+}
+
+bool MappedMeshFile::Validate() const
+{
+  const auto& header = GetHeader();
+  if (header.signature != MeshFile::Signature || header.version != MeshFile::Version ||
+    header.headerSize != sizeof(MeshFile::Header) || header.fileSize > m_size ||
+    header.streamCount == 0 || header.streamCount > MeshFile::MaxStreams)
+  {
+    return false;
+  }
+  // ItZbgƃTCY 64bit ̂܂ܔׁA͈͊OACgᔽe.
+  auto isInRange = [&](uint64_t offset, uint64_t size) {
+    return offset % MeshFile::DataAlignment == 0 && offset >= header.headerSize && offset <= header.fileSize && size <= header.fileSize - offset;
+  };
+  for (uint32_t i = 0; i < header.streamCount; ++i)
+  {
+    const auto& stream = header.streams[i];
+    if (stream.attributeCount > MeshFile::MaxAttributes ||
+      stream.dataSize != uint64_t(stream.stride) * header.vertexCount ||
+      !isInRange(stream.dataOffset, stream.dataSize))
+    {
+      return false;
+    }
+    for (uint32_t j = 0; j < stream.attributeCount; ++j)
+    {
+      if (stream.attributes[j].offset >= stream.stride)
+      {
+        return false;
+      }
+    }
+  }
+  if (header.indexSize != sizeof(uint32_t) * uint64_t(header.indexCount) || header.indexCount % 3 != 0 ||
+    !isInRange(header.indexOffset, header.indexSize))
+  {
+    return false;
+  }
+  // _͈̔͊OQƂCfbNXȂ.
+  auto indices = GetIndexData();
+  for (uint32_t i = 0; i < header.indexCount; ++i)
+  {
+    if (indices[i] >= header.vertexCount)
+    {
+      return false;
+    }
+  }
+  if (header.meshletSize != sizeof(MeshFile::Meshlet) * uint64_t(header.meshletCount) ||
+    !isInRange(header.meshletOffset, header.meshletSize))
+  {
+    return false;
+  }
+  auto meshlets = GetMeshletData();
+  for (uint32_t i = 0; i < header.meshletCount; ++i)
+  {
+    // ebVbgOp`PʂŃCfbNX͈͓̔Ɏ܂Ă邱.
+    const auto& m = meshlets[i];
+    if (m.firstIndex % 3 != 0 || m.indexCount % 3 != 0 ||
+      m.firstIndex > header.indexCount || m.indexCount > header.indexCount - m.firstIndex)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void MappedMeshFile::GetVertexInputDescriptions(
+  std::vector<VkVertexInputBindingDescription>& bindings,
+  std::vector<VkVertexInputAttributeDescription>& attributes) const
+{
+  bindings.clear();
+  attributes.clear();
+  const auto& header = GetHeader();
+  for (uint32_t i = 0; i < header.streamCount; ++i)
+  {
+    const auto& stream = header.streams[i];
+    bindings.push_back({ i, stream.stride, VK_VERTEX_INPUT_RATE_VERTEX });
+    for (uint32_t j = 0; j < stream.attributeCount; ++j)
+    {
+      const auto& attr = stream.attributes[j];
+      attributes.push_back({ attr.semantic, i, VkFormat(attr.format), attr.offset });
+    }
+  }
+}
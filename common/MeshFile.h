@@ -0,0 +1,141 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <cstdint>
+
+// oCĩbVt@C`.
+// [Header][_Xg[ 0][_Xg[ 1]...[CfbNX][bVbg] ̏ɕсA
+// ef[^̐擪 DataAlignment ̋Eɑ(}bvAhX炻̂܂܃Rs[ł悤).
+namespace MeshFile
+{
+  const uint32_t Signature = 0x4853454D; // "MESH"
+  const uint32_t Version = 3;
+  const uint32_t DataAlignment = 16;
+  const uint32_t MaxStreams = 4;
+  const uint32_t MaxAttributes = 8;
+
+  // _̈Ӗ. VF[_[ location ɂ̒lg.
+  enum Semantic : uint32_t
+  {
+    Semantic_Position = 0,
+    Semantic_Normal = 1,
+    Semantic_TexCoord = 2,
+  };
+
+  struct Attribute
+  {
+    uint32_t semantic;
+    uint32_t format; // VkFormat.
+    uint32_t offset; // _̃ItZbg.
+  };
+
+  struct Stream
+  {
+    uint32_t stride;
+    uint32_t attributeCount;
+    Attribute attributes[MaxAttributes];
+    uint64_t dataOffset; // t@C擪̃ItZbg.
+    uint64_t dataSize;
+  };
+
+  // CfbNXobt@ŘAOp`̉(NX^).
+  // std430 ̔zƂĂ̂܂܃Xg[Wobt@ɒuтɂĂ.
+  struct Meshlet
+  {
+    float center[3];   // ܋̒S(f).
+    float radius;
+    float coneAxis[3]; // ʖ@މ~̎.
+    float coneSin;     // ~̔p sin. 1 ȏȂwʔɎgȂ.
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t reserved[2];
+  };
+
+  struct Header
+  {
+    uint32_t signature;
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t vertexCount;
+    uint32_t indexCount; // CfbNX uint32_t ̎Op`Xg.
+    uint32_t streamCount;
+    float boundsMin[3];
+    float boundsMax[3];
+    Stream streams[MaxStreams];
+    uint64_t indexOffset;
+    uint64_t indexSize;
+    uint32_t meshletCount; // 0 Ȃ烁bVbgȂ.
+    uint32_t reserved;
+    uint64_t meshletOffset;
+    uint64_t meshletSize;
+    uint64_t fileSize;
+    uint64_t sourceHash; // ϊ̃f[^ƕϊ狁߂l. ϊKv邩̔Ɏg.
+    float sourceAcmr; // ϊ̕тł̒_LbV(œKO).
+    float sourceAtvr;
+  };
+
+  // ϊ̏.
+  struct SourceInfo
+  {
+    uint64_t hash;
+    float acmr;
+    float atvr;
+  };
+
+  // op̒_Xg[.
+  struct StreamSource
+  {
+    const void* data;
+    uint32_t stride;
+    std::vector<Attribute> attributes;
+  };
+
+  // s false.
+  bool Write(const char* fileName, const std::vector<StreamSource>& streams, uint32_t vertexCount,
+    const uint32_t* indices, uint32_t indexCount, const float boundsMin[3], const float boundsMax[3],
+    const std::vector<Meshlet>& meshlets, const SourceInfo& source);
+}
+
+// bVt@CǂݎpŃ}bv.
+// g͒ԃobt@oRA}bvAhXXe[WOobt@֒ڃRs[z.
+class MappedMeshFile
+{
+public:
+  MappedMeshFile();
+  ~MappedMeshFile();
+
+  // wb_[ƃf[^͈͂؂łȂ false.
+  bool Open(const char* fileName);
+  void Close();
+  bool IsOpen() const { return m_data != nullptr; }
+
+  const MeshFile::Header& GetHeader() const { return *reinterpret_cast<const MeshFile::Header*>(m_data); }
+  uint32_t GetVertexCount() const { return GetHeader().vertexCount; }
+  uint32_t GetIndexCount() const { return GetHeader().indexCount; }
+  const void* GetVertexData(uint32_t stream) const { return m_data + GetHeader().streams[stream].dataOffset; }
+  uint32_t GetVertexStride(uint32_t stream) const { return GetHeader().streams[stream].stride; }
+  const uint32_t* GetIndexData() const { return reinterpret_cast<const uint32_t*>(m_data + GetHeader().indexOffset); }
+  uint32_t GetMeshletCount() const { return GetHeader().meshletCount; }
+  const MeshFile::Meshlet* GetMeshletData() const { return reinterpret_cast<const MeshFile::Meshlet*>(m_data + GetHeader().meshletOffset); }
+
+  // Xg[ԍoCfBOԍASemantic  location ƂpCvC̒_.
+  void GetVertexInputDescriptions(
+    std::vector<VkVertexInputBindingDescription>& bindings,
+    std::vector<VkVertexInputAttributeDescription>& attributes) const;
+
+private:
+  MappedMeshFile(const MappedMeshFile&) = delete;
+  MappedMeshFile& operator=(const MappedMeshFile&) = delete;
+
+  bool Validate() const;
+
+  const uint8_t* m_data;
+  uint64_t m_size;
+#if defined(_WIN32)
+  void* m_file;
+  void* m_mapping;
+#else
+  int m_file;
+#endif
+};
@@ -0,0 +1,366 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+
+namespace
+{
+  const uint32_t InvalidIndex = ~0u;
+
+  // FIFO _LbV̖͋[. _ꂽ_̒ʂԍŔ肷.
+  class FifoCache
+  {
+  public:
+    FifoCache(size_t vertexCount, uint32_t cacheSize)
+      : m_stamps(vertexCount, 0), m_cacheSize(cacheSize), m_clock(0) { }
+
+    void Reset()
+    {
+      // ʂԍLbVTCYi߂΁AS_ǂoꂽƂɂȂ.
+      m_clock += m_cacheSize;
+    }
+    // LbV~XȂ true.
+    bool Access(uint32_t v)
+    {
+      if (m_stamps[v] != 0 && m_clock - m_stamps[v] < m_cacheSize)
+      {
+        return false;
+      }
+      m_stamps[v] = ++m_clock;
+      return true;
+    }
+    uint32_t AccessTriangle(const uint32_t* tri)
+    {
+      return uint32_t(Access(tri[0])) + uint32_t(Access(tri[1])) + uint32_t(Access(tri[2]));
+    }
+
+  private:
+    std::vector<uint64_t> m_stamps;
+    uint64_t m_cacheSize;
+    uint64_t m_clock;
+  };
+}
+
+MeshOptimizer::VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+  FifoCache cache(vertexCount, cacheSize);
+  std::vector<bool> isReferenced(vertexCount, false);
+  size_t misses = 0, referencedCount = 0;
+  for (size_t i = 0; i < indexCount; ++i)
+  {
+    auto v = indices[i];
+    misses += cache.Access(v) ? 1 : 0;
+    if (!isReferenced[v])
+    {
+      isReferenced[v] = true;
+      referencedCount++;
+    }
+  }
+  VertexCacheStats stats;
+  auto triangleCount = indexCount / 3;
+  stats.acmr = triangleCount > 0 ? double(misses) / double(triangleCount) : 0.0;
+  stats.atvr = referencedCount > 0 ? double(misses) / double(referencedCount) : 0.0;
+  return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+{
+  // Tipsify: _̎̎Op`ɏo͂A̒S̓LbVɎcĂ钸_I.
+  // (P. V. Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007)
+  auto triangleCount = indices.size() / 3;
+  if (triangleCount == 0)
+  {
+    return;
+  }
+
+  // _Op`ւ̗אڃXg.
+  std::vector<uint32_t> liveCounts(vertexCount, 0);
+  for (auto v : indices)
+  {
+    liveCounts[v]++;
+  }
+  std::vector<uint32_t> offsets(vertexCount + 1, 0);
+  for (size_t v = 0; v < vertexCount; ++v)
+  {
+    offsets[v + 1] = offsets[v] + liveCounts[v];
+  }
+  std::vector<uint32_t> adjacency(indices.size());
+  {
+    auto fill = offsets;
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+      adjacency[fill[indices[i]]++] = uint32_t(i / 3);
+    }
+  }
+
+  std::vector<uint32_t> cacheTimes(vertexCount, 0);
+  std::vector<bool> isEmitted(triangleCount, false);
+  std::vector<uint32_t> deadEnds;
+  std::vector<uint32_t> candidates;
+  std::vector<uint32_t> result;
+  result.reserve(indices.size());
+
+  uint32_t timeStamp = cacheSize + 1;
+  size_t cursor = 0;
+
+  // c̎Op`_Aŋߏo͂_  ͏̏ŒT.
+  auto skipDeadEnd = [&]() -> uint32_t {
+    while (!deadEnds.empty())
+    {
+      auto d = deadEnds.back();
+      deadEnds.pop_back();
+      if (liveCounts[d] > 0)
+      {
+        return d;
+      }
+    }
+    for (; cursor < vertexCount; ++cursor)
+    {
+      if (liveCounts[cursor] > 0)
+      {
+        return uint32_t(cursor);
+      }
+    }
+    return InvalidIndex;
+  };
+
+  auto fanning = skipDeadEnd();
+  while (fanning != InvalidIndex)
+  {
+    candidates.clear();
+    for (auto i = offsets[fanning]; i < offsets[fanning + 1]; ++i)
+    {
+      auto t = adjacency[i];
+      if (isEmitted[t])
+      {
+        continue;
+      }
+      for (int j = 0; j < 3; ++j)
+      {
+        auto v = indices[t * 3 + j];
+        result.push_back(v);
+        deadEnds.push_back(v);
+        candidates.push_back(v);
+        liveCounts[v]--;
+        if (timeStamp - cacheTimes[v] > cacheSize)
+        {
+          cacheTimes[v] = timeStamp++;
+        }
+      }
+      isEmitted[t] = true;
+    }
+
+    // o͂ĂLbVɎc钸_̂AłÂ̂I.
+    auto next = InvalidIndex;
+    int bestPriority = -1;
+    for (auto v : candidates)
+    {
+      if (liveCounts[v] == 0)
+      {
+        continue;
+      }
+      int priority = 0;
+      if (timeStamp - cacheTimes[v] + 2 * liveCounts[v] <= cacheSize)
+      {
+        priority = int(timeStamp - cacheTimes[v]);
+      }
+      if (priority > bestPriority)
+      {
+        bestPriority = priority;
+        next = v;
+      }
+    }
+    fanning = next != InvalidIndex ? next : skipDeadEnd();
+  }
+  indices.swap(result);
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold, uint32_t cacheSize)
+{
+  auto triangleCount = indices.size() / 3;
+  if (triangleCount == 0)
+  {
+    return;
+  }
+
+  // LbVSēւ(3 _Ƃ~X)ʒuŋ؂.
+  std::vector<size_t> hardBoundaries;
+  {
+    FifoCache cache(positions.size(), cacheSize);
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+      if (cache.AccessTriangle(&indices[t * 3]) == 3)
+      {
+        hardBoundaries.push_back(t);
+      }
+    }
+    hardBoundaries.push_back(triangleCount);
+  }
+
+  // ɁAԂƂ ACMR ԑŜ threshold {ȉɎ܂ʒuōׂ؂.
+  std::vector<size_t> boundaries;
+  {
+    FifoCache cache(positions.size(), cacheSize);
+    for (size_t c = 0; c + 1 < hardBoundaries.size(); ++c)
+    {
+      auto begin = hardBoundaries[c], end = hardBoundaries[c + 1];
+      cache.Reset();
+      uint32_t misses = 0;
+      for (auto t = begin; t < end; ++t)
+      {
+        misses += cache.AccessTriangle(&indices[t * 3]);
+      }
+      auto clusterThreshold = threshold * double(misses) / double(end - begin);
+
+      cache.Reset();
+      misses = 0;
+      auto start = begin;
+      boundaries.push_back(begin);
+      for (auto t = begin; t < end; ++t)
+      {
+        misses += cache.AccessTriangle(&indices[t * 3]);
+        if (t + 1 < end && double(misses) / double(t + 1 - start) <= clusterThreshold)
+        {
+          boundaries.push_back(t + 1);
+          start = t + 1;
+          misses = 0;
+          cache.Reset();
+        }
+      }
+    }
+    boundaries.push_back(triangleCount);
+  }
+
+  // NX^̖ʐϏdݕt̏dSƖ@.
+  auto clusterCount = boundaries.size() - 1;
+  std::vector<glm::vec3> centroids(clusterCount, glm::vec3(0.0f));
+  std::vector<glm::vec3> normals(clusterCount, glm::vec3(0.0f));
+  glm::vec3 meshCentroid(0.0f);
+  float meshArea = 0.0f;
+  for (size_t c = 0; c < clusterCount; ++c)
+  {
+    float area = 0.0f;
+    for (auto t = boundaries[c]; t < boundaries[c + 1]; ++t)
+    {
+      const auto& p0 = positions[indices[t * 3 + 0]];
+      const auto& p1 = positions[indices[t * 3 + 1]];
+      const auto& p2 = positions[indices[t * 3 + 2]];
+      auto n = glm::cross(p1 - p0, p2 - p0);
+      float a = glm::length(n);
+      centroids[c] += (p0 + p1 + p2) * (a / 3.0f);
+      normals[c] += n;
+      area += a;
+    }
+    meshCentroid += centroids[c];
+    meshArea += area;
+    if (area > 0.0f)
+    {
+      centroids[c] /= area;
+    }
+  }
+  if (meshArea > 0.0f)
+  {
+    meshCentroid /= meshArea;
+  }
+
+  // ɂȂ悤AŜƂĊOɂȂ镄ɑ.
+  std::vector<float> sortKeys(clusterCount, 0.0f);
+  float orientation = 0.0f;
+  for (size_t c = 0; c < clusterCount; ++c)
+  {
+    float len = glm::length(normals[c]);
+    if (len > 0.0f)
+    {
+      sortKeys[c] = glm::dot(centroids[c] - meshCentroid, normals[c] / len);
+      orientation += sortKeys[c] * len;
+    }
+  }
+  if (orientation < 0.0f)
+  {
+    for (auto& key : sortKeys)
+    {
+      key = -key;
+    }
+  }
+
+  std::vector<size_t> order(clusterCount);
+  for (size_t c = 0; c < clusterCount; ++c)
+  {
+    order[c] = c;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+  std::vector<uint32_t> result;
+  result.reserve(indices.size());
+  for (auto c : order)
+  {
+    result.insert(result.end(), indices.begin() + boundaries[c] * 3, indices.begin() + boundaries[c + 1] * 3);
+  }
+
+  // בւƃNX^̋EŃLbV̓e邽߁AŜł threshold {Ɏ܂邩m߂.
+  // ܂ȂΌ̕тc.
+  auto acmrBefore = AnalyzeVertexCache(indices, positions.size(), cacheSize).acmr;
+  auto acmrAfter = AnalyzeVertexCache(result, positions.size(), cacheSize).acmr;
+  if (acmrAfter > acmrBefore * threshold)
+  {
+    return;
+  }
+  indices.swap(result);
+}
+
+std::vector<uint32_t> MeshOptimizer::OptimizeVertexFetch(std::vector<uint32_t>& indices, size_t vertexCount)
+{
+  std::vector<uint32_t> remap(vertexCount, InvalidIndex);
+  uint32_t next = 0;
+  for (auto& v : indices)
+  {
+    if (remap[v] == InvalidIndex)
+    {
+      remap[v] = next++;
+    }
+    v = remap[v];
+  }
+  for (auto& r : remap)
+  {
+    if (r == InvalidIndex)
+    {
+      r = next++;
+    }
+  }
+  return remap;
+}
+
+std::vector<uint32_t> MeshOptimizer::GenerateProvokingIndices(std::vector<uint32_t>& indices, size_t vertexCount)
+{
+  // c̎Op`̎QƐ. QƂ̏Ȃ_擪ɎgA̎Op`L钸_͌Ɏc.
+  std::vector<uint32_t> remaining(vertexCount, 0);
+  for (auto v : indices)
+  {
+    remaining[v]++;
+  }
+  std::vector<bool> isProvoking(vertexCount, false);
+  std::vector<uint32_t> duplicates;
+  for (size_t t = 0; t + 2 < indices.size(); t += 3)
+  {
+    auto tri = &indices[t];
+    int best = -1;
+    for (int k = 0; k < 3; ++k)
+    {
+      if (!isProvoking[tri[k]] && (best < 0 || remaining[tri[k]] < remaining[tri[best]]))
+      {
+        best = k;
+      }
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+      remaining[tri[k]]--;
+    }
+    if (best < 0)
+    {
+      duplicates.push_back(tri[0]);
+      tri[0] = uint32_t(vertexCount + duplicates.size() - 1);
+      continue;
+    }
+    std::rotate(tri, tri + best, tri + 3);
+    isProvoking[tri[0]] = true;
+  }
+  return duplicates;
+}
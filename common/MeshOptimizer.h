@@ -0,0 +1,87 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+// Op`Xg̃CfbNX/_̕т GPU ɍœK.
+// _LbV(Tipsify), I[o[h[(ÕNX^ɕ`), _tFb`(o) 3 .
+// Op`̏WƊeOp`̒_̏()͕ςȂ.
+class MeshOptimizer
+{
+public:
+  static const uint32_t DefaultCacheSize = 16;
+
+  struct VertexCacheStats
+  {
+    double acmr; // Op`̒_ (0.5 t߂z, ň 3).
+    double atvr; // _̒_ (1 z).
+  };
+  struct Result
+  {
+    VertexCacheStats before;
+    VertexCacheStats after;
+  };
+
+  // FIFO ̒_LbV͋[Č߂.
+  static VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = DefaultCacheSize);
+  static VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = DefaultCacheSize)
+  {
+    return AnalyzeVertexCache(indices.data(), indices.size(), vertexCount, cacheSize);
+  }
+
+  static void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = DefaultCacheSize);
+
+  // OptimizeVertexCache ̌Ɏg. _LbV̒ቺ threshold {܂łɗ}ăNX^ɕA
+  // bV̒SONX^قǐɕ`悤בւ.
+  // בւʂ ACMR  threshold {𒴂ꍇ͉Ȃ.
+  static void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold = 1.05f, uint32_t cacheSize = DefaultCacheSize);
+
+  // CfbNXŏ߂ĎQƂ鏇ɒ_בւ邽߂̑Ή\(remap[ԍ] = Vԍ)ԂA
+  // indices Vԍɏ. QƂȂ_͖ɉ.
+  static std::vector<uint32_t> OptimizeVertexFetch(std::vector<uint32_t>& indices, size_t vertexCount);
+
+  // flat ŖʂƂ̒ln߁AeOp`̐擪(provoking vertex)̎Op`ƏdȂȂ悤
+  // ۂ܂܎Op`Œ_. dȂȂOp`͐擪̒_𕡐.
+  // _̌̔ԍԂ(̐Vԍ vertexCount ̘A).
+  static std::vector<uint32_t> GenerateProvokingIndices(std::vector<uint32_t>& indices, size_t vertexCount);
+
+  template<class T>
+  static void RemapVertices(std::vector<T>& vertices, const std::vector<uint32_t>& remap)
+  {
+    std::vector<T> remapped(vertices);
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+      remapped[remap[i]] = vertices[i];
+    }
+    vertices.swap(remapped);
+  }
+
+  // Position o[_^ɑ΂AL 3 ɍs.
+  // overdrawThreshold  OptimizeOverdraw ɓn ACMR ̋e{. ł͒_LbVȂ.
+  template<class T>
+  static Result Optimize(std::vector<T>& vertices, std::vector<uint32_t>& indices, float overdrawThreshold = 1.0f)
+  {
+    Result result;
+    result.before = AnalyzeVertexCache(indices, vertices.size());
+
+    std::vector<glm::vec3> positions;
+    positions.reserve(vertices.size());
+    for (const auto& v : vertices)
+    {
+      positions.push_back(v.Position);
+    }
+    // ̕т̕ǂꍇ(iqɕׂbVȂ)͂̂܂܎g.
+    auto cacheOptimized = indices;
+    OptimizeVertexCache(cacheOptimized, vertices.size());
+    if (AnalyzeVertexCache(cacheOptimized, vertices.size()).acmr < result.before.acmr)
+    {
+      indices.swap(cacheOptimized);
+    }
+    OptimizeOverdraw(indices, positions, overdrawThreshold);
+    RemapVertices(vertices, OptimizeVertexFetch(indices, vertices.size()));
+
+    result.after = AnalyzeVertexCache(indices, vertices.size());
+    return result;
+  }
+};
@@ -0,0 +1,173 @@
+#include "MeshletBuilder.h"
+#include "FrustumPlanes.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  const uint32_t InvalidIndex = ~0u;
+
+  void CalcBounds(MeshFile::Meshlet& meshlet, const uint32_t* indices, const std::vector<glm::vec3>& positions,
+    const std::vector<glm::vec3>& faceNormals, const uint32_t* triangles, size_t triangleCount)
+  {
+    glm::vec3 minPos = positions[indices[triangles[0] * 3]], maxPos = minPos;
+    glm::vec3 normalSum(0.0f);
+    for (size_t i = 0; i < triangleCount; ++i)
+    {
+      auto t = triangles[i];
+      for (int k = 0; k < 3; ++k)
+      {
+        minPos = (glm::min)(minPos, positions[indices[t * 3 + k]]);
+        maxPos = (glm::max)(maxPos, positions[indices[t * 3 + k]]);
+      }
+      normalSum += faceNormals[t];
+    }
+    auto center = (minPos + maxPos) * 0.5f;
+    float radius = 0.0f;
+    for (size_t i = 0; i < triangleCount; ++i)
+    {
+      auto t = triangles[i];
+      for (int k = 0; k < 3; ++k)
+      {
+        radius = (std::max)(radius, glm::length(positions[indices[t * 3 + k]] - center));
+      }
+    }
+
+    // ~͖̎ʖ@̕. ƍłꂽ@Ƃ̊px𔼊pƂ.
+    glm::vec3 axis(0.0f, 0.0f, 1.0f);
+    float minDot = -1.0f;
+    float len = glm::length(normalSum);
+    if (len > 0.0f)
+    {
+      axis = normalSum / len;
+      minDot = 1.0f;
+      for (size_t i = 0; i < triangleCount; ++i)
+      {
+        const auto& n = faceNormals[triangles[i]];
+        if (n != glm::vec3(0.0f))
+        {
+          minDot = (std::min)(minDot, glm::dot(axis, n));
+        }
+      }
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+      meshlet.center[i] = center[i];
+      meshlet.coneAxis[i] = axis[i];
+    }
+    meshlet.radius = radius;
+    // p 90 xȏ̉~ł́Aǂ猩Ă\̖ʂc肤.
+    meshlet.coneSin = minDot > 0.0f ? std::sqrt(1.0f - minDot * minDot) : 1.0f;
+  }
+}
+
+std::vector<MeshFile::Meshlet> MeshletBuilder::Build(const std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions,
+  uint32_t maxVertices, uint32_t maxTriangles)
+{
+  std::vector<MeshFile::Meshlet> meshlets;
+  auto triangleCount = uint32_t(indices.size() / 3);
+  if (triangleCount == 0 || maxVertices < 3 || maxTriangles == 0)
+  {
+    return meshlets;
+  }
+
+  // Pʖʖ@. ɂȂ悤AŜƂĊOɂȂ镄ɑ.
+  std::vector<glm::vec3> faceNormals(triangleCount);
+  std::vector<glm::vec3> faceCenters(triangleCount);
+  glm::vec3 meshCentroid(0.0f);
+  float meshArea = 0.0f;
+  for (uint32_t t = 0; t < triangleCount; ++t)
+  {
+    const auto& p0 = positions[indices[t * 3 + 0]];
+    const auto& p1 = positions[indices[t * 3 + 1]];
+    const auto& p2 = positions[indices[t * 3 + 2]];
+    auto n = glm::cross(p1 - p0, p2 - p0);
+    float area = glm::length(n);
+    faceNormals[t] = area > 0.0f ? n / area : glm::vec3(0.0f);
+    faceCenters[t] = (p0 + p1 + p2) / 3.0f;
+    meshCentroid += faceCenters[t] * area;
+    meshArea += area;
+  }
+  if (meshArea > 0.0f)
+  {
+    meshCentroid /= meshArea;
+  }
+  float orientation = 0.0f;
+  for (uint32_t t = 0; t < triangleCount; ++t)
+  {
+    orientation += glm::dot(faceCenters[t] - meshCentroid, faceNormals[t]);
+  }
+  if (orientation < 0.0f)
+  {
+    for (auto& n : faceNormals)
+    {
+      n = -n;
+    }
+  }
+
+  // _̃bVbgɊ܂܂邩́AbVbgԍ̈Ŕ肷.
+  std::vector<uint32_t> vertexMark(positions.size(), InvalidIndex);
+  std::vector<uint32_t> triangles;
+  uint32_t vertexCount = 0;
+  auto flush = [&]() {
+    MeshFile::Meshlet meshlet{};
+    meshlet.firstIndex = triangles.front() * 3;
+    meshlet.indexCount = uint32_t(triangles.size() * 3);
+    CalcBounds(meshlet, indices.data(), positions, faceNormals, triangles.data(), triangles.size());
+    meshlets.push_back(meshlet);
+    triangles.clear();
+    vertexCount = 0;
+  };
+  for (uint32_t t = 0; t < triangleCount; ++t)
+  {
+    auto meshletIndex = uint32_t(meshlets.size());
+    uint32_t added = 0;
+    for (int k = 0; k < 3; ++k)
+    {
+      added += vertexMark[indices[t * 3 + k]] != meshletIndex ? 1 : 0;
+    }
+    // 𒴂Op`̎Oŋ؂.
+    if (triangles.size() == maxTriangles || vertexCount + added > maxVertices)
+    {
+      flush();
+      meshletIndex = uint32_t(meshlets.size());
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+      auto v = indices[t * 3 + k];
+      if (vertexMark[v] != meshletIndex)
+      {
+        vertexMark[v] = meshletIndex;
+        ++vertexCount;
+      }
+    }
+    triangles.push_back(t);
+  }
+  flush();
+  return meshlets;
+}
+
+bool MeshletBuilder::IsVisible(const MeshFile::Meshlet& meshlet, const glm::vec4 frustumPlanes[6], const glm::vec3& eye, bool isBackfaceCulling)
+{
+  glm::vec3 center(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+  for (int i = 0; i < 6; ++i)
+  {
+    if (glm::dot(glm::vec3(frustumPlanes[i]), center) + frustumPlanes[i].w < -meshlet.radius)
+    {
+      return false;
+    }
+  }
+  if (!isBackfaceCulling)
+  {
+    return true;
+  }
+  // ܋̂ǂ̓_猩ĂA~ׂ̂Ă̖@_Ɣ΂ĂΔw.
+  glm::vec3 axis(meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2]);
+  auto toCenter = center - eye;
+  return glm::dot(axis, toCenter) <= meshlet.coneSin * glm::length(toCenter) + meshlet.radius;
+}
+
+void MeshletBuilder::CalcFrustumPlanes(const glm::mat4& viewProj, glm::vec4 planes[6])
+{
+  FrustumPlanes::Calc(viewProj, planes);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "MeshFile.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+// Op`Xg𒸓_EOp`ɏ̂鏬ȃNX^(bVbg)ɕ.
+// ebVbgɂ͕܋Ɩ@~AJOƔwʃJONX^Pʂōs悤ɂ.
+class MeshletBuilder
+{
+public:
+  static const uint32_t DefaultMaxVertices = 64;
+  static const uint32_t DefaultMaxTriangles = 64;
+
+  // indices ̎Op`̏(_LbVɍœK)ςɁA
+  // _Op`ɒBƂŋ؂ăbVbgɂ.
+  // בւȂ߁AbVbggȂ`ł_LbV̌͗Ȃ.
+  static std::vector<MeshFile::Meshlet> Build(const std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions,
+    uint32_t maxVertices = DefaultMaxVertices, uint32_t maxTriangles = DefaultMaxTriangles);
+
+  // ʂƎ_̓bVƓWnœn. ʂ͓.
+  // NX^JÕVF[_[Ɠ. @~ɂ锻́A`ŔwʃJOƂ(isBackfaceCulling)s.
+  static bool IsVisible(const MeshFile::Meshlet& meshlet, const glm::vec4 frustumPlanes[6], const glm::vec3& eye, bool isBackfaceCulling);
+
+  static void CalcFrustumPlanes(const glm::mat4& viewProj, glm::vec4 planes[6]);
+};
@@ -0,0 +1,73 @@
+#include "QuadDomainTessellator.h"
+#include <algorithm>
+#include <cmath>
+
+bool QuadDomainTessellator::IsDiscarded(const Levels& levels)
+{
+  for (int i = 0; i < 4; ++i)
+  {
+    // NaN jΏۂɂȂ悤ےŔ肷.
+    if (!(levels.outer[i] > 0.0f))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t QuadDomainTessellator::GetSegmentCount(float level, float maxLevel)
+{
+  // [2, maxLevel] Ɋۂ߂ĂA̋ɐ؂グ.
+  level = (std::min)((std::max)(level, 2.0f), maxLevel);
+  auto n = uint32_t(std::ceil(level));
+  return (n + 1) & ~1u;
+}
+
+QuadDomainTessellator::Counts QuadDomainTessellator::Count(const Levels& levels, float maxLevel)
+{
+  Counts counts{ 0, 0 };
+  if (IsDiscarded(levels))
+  {
+    return counts;
+  }
+  // O: eӂ̍̕v_(p͋L)ɂȂ.
+  uint64_t outerSegments = 0;
+  for (int i = 0; i < 4; ++i)
+  {
+    outerSegments += GetSegmentCount(levels.outer[i], maxLevel);
+  }
+  counts.vertices = outerSegments;
+
+  //  1 Ƃɗ̕ 2 铯S̋`ƂȂA
+  // ǂ炩 0 ɂȂ(܂͓_)ŏI.
+  // ׂ荇̕ӓm( a, b) a+b ̎Op`Ō΂.
+  int64_t n0 = GetSegmentCount(levels.inner[0], maxLevel);
+  int64_t n1 = GetSegmentCount(levels.inner[1], maxLevel);
+  int64_t prevA = 0, prevB = 0;
+  auto ringCount = (std::min)(n0, n1) / 2;
+  for (int64_t k = 1; k <= ringCount; ++k)
+  {
+    int64_t a = n0 - 2 * k;
+    int64_t b = n1 - 2 * k;
+    if (a > 0 && b > 0)
+    {
+      counts.vertices += uint64_t(2 * (a + b));
+    }
+    else
+    {
+      counts.vertices += uint64_t((std::max)(a, b) + 1);
+    }
+
+    if (k == 1)
+    {
+      counts.triangles += outerSegments + uint64_t(2 * a + 2 * b);
+    }
+    else
+    {
+      counts.triangles += uint64_t(2 * (prevA + a) + 2 * (prevB + b));
+    }
+    prevA = a;
+    prevB = b;
+  }
+  return counts;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+// quads hC, fractional_even_spacing ̃ebZ[V CPU ōČA
+// 钸_ƎOp`߂.
+class QuadDomainTessellator
+{
+public:
+  struct Levels
+  {
+    float outer[4];
+    float inner[2];
+  };
+  struct Counts
+  {
+    uint64_t vertices;
+    uint64_t triangles;
+  };
+
+  // Outer ̂ꂩ 0 ȉ(܂ NaN)̃pb`͔j.
+  static bool IsDiscarded(const Levels& levels);
+
+  // fractional_even_spacing ŎۂɎg镪(2 ȏ̋).
+  static uint32_t GetSegmentCount(float level, float maxLevel = 64.0f);
+
+  static Counts Count(const Levels& levels, float maxLevel = 64.0f);
+};
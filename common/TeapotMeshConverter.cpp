@@ -0,0 +1,115 @@
+#include "TeapotMeshConverter.h"
+#include "TeapotModel.h"
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace
+{
+  uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+  {
+    auto p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+      hash ^= p[i];
+      hash *= 0x100000001B3ull;
+    }
+    return hash;
+  }
+
+  // ϊʂɉe\[Xt@C(common tH_̑΃pX).
+  const char* SourceFiles[] = {
+    "TeapotModel.h",
+    "TeapotMeshConverter.h", "TeapotMeshConverter.cpp",
+    "MeshFile.h", "MeshFile.cpp",
+    "MeshOptimizer.h", "MeshOptimizer.cpp",
+    "MeshletBuilder.h", "MeshletBuilder.cpp",
+    "VertexQuantizer.h", "VertexQuantizer.cpp",
+    "FrustumPlanes.h",
+  };
+}
+
+bool TeapotMeshConverter::CalcSourceHash(const char* sourceDirectory, VertexQuantizer::NormalEncoding encoding, uint64_t& hash)
+{
+  hash = 0xCBF29CE484222325ull;
+  for (auto file : SourceFiles)
+  {
+    std::ifstream infile(std::string(sourceDirectory) + "/" + file, std::ios::binary);
+    if (!infile)
+    {
+      return false;
+    }
+    std::string text((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+    text.erase(std::remove(text.begin(), text.end(), '\r'), text.end());
+    hash = HashBytes(hash, text.data(), text.size());
+  }
+  uint32_t values[] = { uint32_t(encoding), Revision, MeshFile::Version };
+  hash = HashBytes(hash, values, sizeof(values));
+  return true;
+}
+
+bool TeapotMeshConverter::IsUpToDate(const char* fileName, uint64_t sourceHash)
+{
+  MappedMeshFile meshFile;
+  return meshFile.Open(fileName) && meshFile.GetHeader().sourceHash == sourceHash;
+}
+
+bool TeapotMeshConverter::Convert(const char* fileName, VertexQuantizer::NormalEncoding encoding, uint64_t sourceHash)
+{
+  std::vector<TeapotModel::Vertex> vertices(std::begin(TeapotModel::TeapotVerticesPN), std::end(TeapotModel::TeapotVerticesPN));
+  std::vector<uint32_t> indices(std::begin(TeapotModel::TeapotIndices), std::end(TeapotModel::TeapotIndices));
+  auto optimizeResult = MeshOptimizer::Optimize(vertices, indices);
+  MeshFile::SourceInfo source{ sourceHash, float(optimizeResult.before.acmr), float(optimizeResult.before.atvr) };
+
+  // œKOp`̏̂܂܋؂ăbVbgɂA_QƏɕג.
+  std::vector<glm::vec3> positions;
+  positions.reserve(vertices.size());
+  for (const auto& v : vertices)
+  {
+    positions.push_back(v.Position);
+  }
+  auto meshlets = MeshletBuilder::Build(indices, positions);
+  MeshOptimizer::RemapVertices(vertices, MeshOptimizer::OptimizeVertexFetch(indices, vertices.size()));
+
+  glm::vec3 boundsMin = vertices[0].Position, boundsMax = vertices[0].Position;
+  for (const auto& v : vertices)
+  {
+    boundsMin = (glm::min)(boundsMin, v.Position);
+    boundsMax = (glm::max)(boundsMax, v.Position);
+  }
+
+  if (encoding == VertexQuantizer::NormalEncoding_Float32)
+  {
+    MeshFile::StreamSource stream;
+    stream.data = vertices.data();
+    stream.stride = uint32_t(sizeof(TeapotModel::Vertex));
+    stream.attributes = {
+      { MeshFile::Semantic_Position, VertexQuantizer::GetPositionFormat(VertexQuantizer::PositionEncoding_Float32), uint32_t(offsetof(TeapotModel::Vertex, Position)) },
+      { MeshFile::Semantic_Normal, VK_FORMAT_R32G32B32_SFLOAT, uint32_t(offsetof(TeapotModel::Vertex, Normal)) },
+    };
+    return MeshFile::Write(fileName, { stream }, uint32_t(vertices.size()),
+      indices.data(), uint32_t(indices.size()), &boundsMin.x, &boundsMax.x, meshlets, source);
+  }
+
+  using QuantizedVertex = VertexQuantizer::QuantizedVertex;
+  std::vector<QuantizedVertex> quantized(vertices.size());
+  for (size_t i = 0; i < vertices.size(); ++i)
+  {
+    VertexQuantizer::EncodePosition(vertices[i].Position, boundsMin, boundsMax, quantized[i].position);
+    quantized[i].normal = VertexQuantizer::EncodeNormal(glm::normalize(vertices[i].Normal), encoding);
+  }
+  MeshFile::StreamSource stream;
+  stream.data = quantized.data();
+  stream.stride = uint32_t(sizeof(QuantizedVertex));
+  stream.attributes = {
+    { MeshFile::Semantic_Position, VertexQuantizer::GetPositionFormat(VertexQuantizer::PositionEncoding_Unorm16), uint32_t(offsetof(QuantizedVertex, position)) },
+    { MeshFile::Semantic_Normal, VertexQuantizer::GetNormalFormat(encoding), uint32_t(offsetof(QuantizedVertex, normal)) },
+  };
+  return MeshFile::Write(fileName, { stream }, uint32_t(quantized.size()),
+    indices.data(), uint32_t(indices.size()), &boundsMin.x, &boundsMax.x, meshlets, source);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "MeshFile.h"
+#include "VertexQuantizer.h"
+
+// TeapotModel.h ̒_/CfbNXzœKăbVt@C(MeshFile)֏o.
+// TeapotMeshConverter.cpp ͕ϊc[(TeapotMeshConverter tH_)ł̂݃rhA
+// eTv TeapotModel.h 荞܂ɏoς݂̃t@Cǂݍ.
+namespace TeapotMeshConverter
+{
+  // ϊ̃\[Xt@CȊO̗Rŕϊʂςꍇɏグ.
+  // \[XnbVɊ܂܂Ãt@C蒼.
+  const uint32_t Revision = 2;
+
+  // @̌`Ƃɕʂ̃t@CƂ(NormalEncoding_Float32 ͗ʎqȂ).
+  inline const char* GetFileName(VertexQuantizer::NormalEncoding encoding)
+  {
+    switch (encoding)
+    {
+    case VertexQuantizer::NormalEncoding_Oct16: return "teapot_oct16.mesh";
+    case VertexQuantizer::NormalEncoding_Packed1010102: return "teapot_1010102.mesh";
+    default: return "teapot.mesh";
+    }
+  }
+
+  // ϊɊւ\[Xt@C(TeapotModel.h, MeshOptimizer, MeshletBuilder, VertexQuantizer Ȃ)̓e,
+  // @̌`, Revision 狁߂nbV(FNV-1a). sourceDirectory  common tH_.
+  // sR[ḧႢł͕ςȂ悤 CR ͏. t@Cǂ߂Ȃ false.
+  bool CalcSourceHash(const char* sourceDirectory, VertexQuantizer::NormalEncoding encoding, uint64_t& hash);
+
+  // t@Cǂ߂āAL^ꂽnbV sourceHash ƈv true.
+  bool IsUpToDate(const char* fileName, uint64_t sourceHash);
+
+  // sourceHash ̓t@CɋL^. s false.
+  bool Convert(const char* fileName, VertexQuantizer::NormalEncoding encoding, uint64_t sourceHash);
+}
@@ -0,0 +1,196 @@
+#include "VertexQuantizer.h"
+#include "MeshFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+namespace
+{
+  // 0 𐳂ƂĈ.
+  float SignNotZero(float v)
+  {
+    return v >= 0.0f ? 1.0f : -1.0f;
+  }
+  uint32_t ToSnorm16(float v)
+  {
+    auto i = int32_t(std::round((std::min)((std::max)(v, -1.0f), 1.0f) * 32767.0f));
+    return uint32_t(i) & 0xFFFFu;
+  }
+  float FromSnorm16(uint32_t bits)
+  {
+    auto i = int16_t(uint16_t(bits & 0xFFFFu));
+    return (std::max)(float(i) / 32767.0f, -1.0f);
+  }
+  uint32_t ToUnorm(float v, uint32_t maxValue)
+  {
+    return uint32_t(std::round((std::min)((std::max)(v, 0.0f), 1.0f) * float(maxValue)));
+  }
+
+  const VkSpecializationMapEntry DecodeMapEntries[] = {
+    { 0, offsetof(VertexQuantizer::DecodeParameters, normalEncoding), sizeof(uint32_t) },
+    { 1, offsetof(VertexQuantizer::DecodeParameters, positionScale) + sizeof(float) * 0, sizeof(float) },
+    { 2, offsetof(VertexQuantizer::DecodeParameters, positionScale) + sizeof(float) * 1, sizeof(float) },
+    { 3, offsetof(VertexQuantizer::DecodeParameters, positionScale) + sizeof(float) * 2, sizeof(float) },
+    { 4, offsetof(VertexQuantizer::DecodeParameters, positionOffset) + sizeof(float) * 0, sizeof(float) },
+    { 5, offsetof(VertexQuantizer::DecodeParameters, positionOffset) + sizeof(float) * 1, sizeof(float) },
+    { 6, offsetof(VertexQuantizer::DecodeParameters, positionOffset) + sizeof(float) * 2, sizeof(float) },
+    { 7, offsetof(VertexQuantizer::DecodeParameters, positionEncoding), sizeof(uint32_t) },
+  };
+}
+
+uint32_t VertexQuantizer::EncodeOctahedral16(const glm::vec3& n)
+{
+  // 8 ʑ̂֎ˉeA͑ΊpŐ܂ԂĐ` [-1,1]^2 Ɏ߂.
+  auto len1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+  glm::vec2 v(n.x / len1, n.y / len1);
+  if (n.z < 0.0f)
+  {
+    v = glm::vec2((1.0f - std::abs(v.y)) * SignNotZero(v.x), (1.0f - std::abs(v.x)) * SignNotZero(v.y));
+  }
+  return ToSnorm16(v.x) | (ToSnorm16(v.y) << 16);
+}
+
+glm::vec3 VertexQuantizer::DecodeOctahedral16(uint32_t packed)
+{
+  glm::vec2 v(FromSnorm16(packed), FromSnorm16(packed >> 16));
+  glm::vec3 n(v.x, v.y, 1.0f - std::abs(v.x) - std::abs(v.y));
+  if (n.z < 0.0f)
+  {
+    n.x = (1.0f - std::abs(v.y)) * SignNotZero(v.x);
+    n.y = (1.0f - std::abs(v.x)) * SignNotZero(v.y);
+  }
+  return glm::normalize(n);
+}
+
+uint32_t VertexQuantizer::EncodePacked1010102(const glm::vec3& n)
+{
+  // UNORM  [-1,1]  [0,1] Ɋ񂹂Ċi[. 2bit  w ͎gȂ.
+  auto x = ToUnorm(n.x * 0.5f + 0.5f, 1023);
+  auto y = ToUnorm(n.y * 0.5f + 0.5f, 1023);
+  auto z = ToUnorm(n.z * 0.5f + 0.5f, 1023);
+  return x | (y << 10) | (z << 20);
+}
+
+glm::vec3 VertexQuantizer::DecodePacked1010102(uint32_t packed)
+{
+  glm::vec3 n(
+    float(packed & 1023u) / 1023.0f,
+    float((packed >> 10) & 1023u) / 1023.0f,
+    float((packed >> 20) & 1023u) / 1023.0f);
+  return glm::normalize(n * 2.0f - glm::vec3(1.0f));
+}
+
+uint32_t VertexQuantizer::EncodeNormal(const glm::vec3& n, NormalEncoding encoding)
+{
+  return encoding == NormalEncoding_Packed1010102 ? EncodePacked1010102(n) : EncodeOctahedral16(n);
+}
+
+void VertexQuantizer::EncodePosition(const glm::vec3& p, const glm::vec3& boundsMin, const glm::vec3& boundsMax, uint16_t out[4])
+{
+  for (int i = 0; i < 3; ++i)
+  {
+    auto extent = boundsMax[i] - boundsMin[i];
+    out[i] = uint16_t(ToUnorm(extent > 0.0f ? (p[i] - boundsMin[i]) / extent : 0.0f, 65535));
+  }
+  out[3] = 65535;
+}
+
+glm::vec3 VertexQuantizer::DecodePosition(const uint16_t q[4], const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+  glm::vec3 p;
+  for (int i = 0; i < 3; ++i)
+  {
+    p[i] = boundsMin[i] + (boundsMax[i] - boundsMin[i]) * (float(q[i]) / 65535.0f);
+  }
+  return p;
+}
+
+VkFormat VertexQuantizer::GetNormalFormat(NormalEncoding encoding)
+{
+  switch (encoding)
+  {
+  case NormalEncoding_Oct16: return VK_FORMAT_R16G16_SNORM;
+  case NormalEncoding_Packed1010102: return VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+  default: return VK_FORMAT_R32G32B32_SFLOAT;
+  }
+}
+
+VkFormat VertexQuantizer::GetPositionFormat(PositionEncoding encoding)
+{
+  return encoding == PositionEncoding_Unorm16 ? VK_FORMAT_R16G16B16A16_UNORM : VK_FORMAT_R32G32B32_SFLOAT;
+}
+
+VertexQuantizer::DecodeParameters VertexQuantizer::GetDecodeParameters(const MappedMeshFile& meshFile)
+{
+  DecodeParameters params{ NormalEncoding_Float32, { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, PositionEncoding_Float32 };
+  const auto& header = meshFile.GetHeader();
+  for (uint32_t i = 0; i < header.streamCount; ++i)
+  {
+    const auto& stream = header.streams[i];
+    for (uint32_t j = 0; j < stream.attributeCount; ++j)
+    {
+      const auto& attr = stream.attributes[j];
+      if (attr.semantic == MeshFile::Semantic_Position && attr.format == VK_FORMAT_R16G16B16A16_UNORM)
+      {
+        params.positionEncoding = PositionEncoding_Unorm16;
+        for (int k = 0; k < 3; ++k)
+        {
+          params.positionScale[k] = header.boundsMax[k] - header.boundsMin[k];
+          params.positionOffset[k] = header.boundsMin[k];
+        }
+      }
+      if (attr.semantic == MeshFile::Semantic_Normal)
+      {
+        if (attr.format == VK_FORMAT_R16G16_SNORM)
+        {
+          params.normalEncoding = NormalEncoding_Oct16;
+        }
+        if (attr.format == VK_FORMAT_A2B10G10R10_UNORM_PACK32)
+        {
+          params.normalEncoding = NormalEncoding_Packed1010102;
+        }
+      }
+    }
+  }
+  return params;
+}
+
+glm::vec3 VertexQuantizer::ReadPosition(const void* vertex, const DecodeParameters& params)
+{
+  glm::vec3 p;
+  if (params.positionEncoding == PositionEncoding_Float32)
+  {
+    memcpy(&p.x, vertex, sizeof(float) * 3);
+    return p;
+  }
+  uint16_t q[4];
+  memcpy(q, vertex, sizeof(q));
+  for (int i = 0; i < 3; ++i)
+  {
+    p[i] = params.positionOffset[i] + params.positionScale[i] * (float(q[i]) / 65535.0f);
+  }
+  return p;
+}
+
+void VertexQuantizer::WriteNormal(void* vertex, uint32_t normalOffset, const glm::vec3& n, NormalEncoding encoding)
+{
+  auto dst = static_cast<uint8_t*>(vertex) + normalOffset;
+  if (encoding == NormalEncoding_Float32)
+  {
+    memcpy(dst, &n.x, sizeof(float) * 3);
+    return;
+  }
+  auto packed = EncodeNormal(n, encoding);
+  memcpy(dst, &packed, sizeof(packed));
+}
+
+VkSpecializationInfo VertexQuantizer::GetSpecializationInfo(const DecodeParameters& params)
+{
+  VkSpecializationInfo info{};
+  info.mapEntryCount = uint32_t(_countof(DecodeMapEntries));
+  info.pMapEntries = DecodeMapEntries;
+  info.dataSize = sizeof(params);
+  info.pData = &params;
+  return info;
+}
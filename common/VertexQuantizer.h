@@ -0,0 +1,67 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+class MappedMeshFile;
+
+// _̈ʒu/@`֗ʎq.
+// ʒu͋E{bNX 16bit K(R16G16B16A16_UNORM)ƂAVF[_[ offset + scale * q ɖ߂.
+// @ 8 ʑ̎ʑ 2x16bit(R16G16_SNORM)Axyz ̂܂܋l߂ 10:10:10:2(A2B10G10R10_UNORM_PACK32).
+// _obt@pƂđSĂ̎ΉK{̌`.
+class VertexQuantizer
+{
+public:
+  enum NormalEncoding : uint32_t
+  {
+    NormalEncoding_Float32, // ʎqȂ(ʒu 32bit _̂܂).
+    NormalEncoding_Oct16,
+    NormalEncoding_Packed1010102,
+  };
+  enum PositionEncoding : uint32_t
+  {
+    PositionEncoding_Float32,
+    PositionEncoding_Unorm16, // E{bNX 16bit K.
+  };
+
+  // ʒu 8 oCg(16bit x 4)+@ 4 oCgŁA_ 24 oCg̔.
+  struct QuantizedVertex
+  {
+    uint16_t position[4];
+    uint32_t normal;
+  };
+
+  // _VF[_[ł̕Ɏgl. ꉻ萔Ƃēn(VF[_[ common/quantize.glsl).
+  // constant_id 0: @̌`, 1-3: ʒũXP[, 4-6: ʒũItZbg, 7: ʒǔ`.
+  struct DecodeParameters
+  {
+    uint32_t normalEncoding;
+    float positionScale[3];
+    float positionOffset[3];
+    uint32_t positionEncoding;
+  };
+
+  static uint32_t EncodeOctahedral16(const glm::vec3& n);
+  static glm::vec3 DecodeOctahedral16(uint32_t packed);
+  static uint32_t EncodePacked1010102(const glm::vec3& n);
+  static glm::vec3 DecodePacked1010102(uint32_t packed);
+  static uint32_t EncodeNormal(const glm::vec3& n, NormalEncoding encoding);
+
+  // E{bNXɑ΂ʒu̗ʎq(w ɂ 1.0 ).
+  static void EncodePosition(const glm::vec3& p, const glm::vec3& boundsMin, const glm::vec3& boundsMax, uint16_t out[4]);
+  static glm::vec3 DecodePosition(const uint16_t q[4], const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+
+  static VkFormat GetNormalFormat(NormalEncoding encoding);
+  static VkFormat GetPositionFormat(PositionEncoding encoding);
+
+  // _̌`ƃwb_[̋E{bNX畜p̒l߂.
+  static DecodeParameters GetDecodeParameters(const MappedMeshFile& meshFile);
+
+  // bVt@C̒_ 1 ̈ʒuǂ / @. ʒu͒_̐擪ɂO.
+  static glm::vec3 ReadPosition(const void* vertex, const DecodeParameters& params);
+  static void WriteNormal(void* vertex, uint32_t normalOffset, const glm::vec3& n, NormalEncoding encoding);
+
+  // params QƂ̂ŁApCvC쐬I܂ params ێĂ.
+  static VkSpecializationInfo GetSpecializationInfo(const DecodeParameters& params);
+};
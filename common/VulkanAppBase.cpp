@@ -510,7 +510,7 @@ void VulkanAppBase::TransferStageBufferToImage(
 }
 
 
-VkRenderPass VulkanAppBase::CreateRenderPass(VkFormat colorFormat, VkFormat depthFormat, VkImageLayout layoutColor)
+VkRenderPass VulkanAppBase::CreateRenderPass(VkFormat colorFormat, VkFormat depthFormat, VkImageLayout layoutColor, uint32_t viewMask)
 {
   VkRenderPass renderPass;
 
@@ -576,6 +576,16 @@ VkRenderPass VulkanAppBase::CreateRenderPass(VkFormat colorFormat, VkFormat dept
     1, &subpassDesc,
     0, nullptr, // Dependency
   };
+  VkRenderPassMultiviewCreateInfo multiviewCI{
+    VK_STRUCTURE_TYPE_RENDER_PASS_MULTIVIEW_CREATE_INFO, nullptr,
+    1, &viewMask,
+    0, nullptr, // ViewOffsets
+    0, nullptr, // CorrelationMasks
+  };
+  if (viewMask != 0)
+  {
+    rpCI.pNext = &multiviewCI;
+  }
   auto result = vkCreateRenderPass(m_device, &rpCI, nullptr, &renderPass);
   ThrowIfFailed(result, "vkCreateRenderPass Failed.");
   return renderPass;
@@ -712,16 +722,22 @@ void VulkanAppBase::CreateDevice()
     extensions.push_back(v.extensionName);
   }
 
-  VkPhysicalDeviceFeatures features{};
-  vkGetPhysicalDeviceFeatures(m_physicalDevice, &features);
+  // Vulkan 1.1 ̋@\(}`r[)킹Ď擾Aĝׂ͂ėLɂ.
+  m_multiviewFeatures = VkPhysicalDeviceMultiviewFeatures{
+    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES, nullptr,
+  };
+  VkPhysicalDeviceFeatures2 features{
+    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, &m_multiviewFeatures,
+  };
+  vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features);
 
   VkDeviceCreateInfo deviceCI{
     VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-    nullptr, 0,
+    &features, 0,
     1, &devQueueCI,
     0, nullptr,
     count, extensions.data(),
-    &features
+    nullptr // pNext  VkPhysicalDeviceFeatures2 Ŏw肷.
   };
   auto result = vkCreateDevice(m_physicalDevice, &deviceCI, nullptr, &m_device);
   ThrowIfFailed(result, "vkCreateDevice Failed.");
@@ -747,6 +763,8 @@ void VulkanAppBase::CreateDescriptorPool()
   VkDescriptorPoolSize poolSize[] = {
     { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1000 },
     { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1000 },
+    { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1000 },
+    { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1000 },
   };
   VkDescriptorPoolCreateInfo descPoolCI{
     VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
@@ -121,7 +121,8 @@ public:
 
 
   // _[pX̐.
-  VkRenderPass CreateRenderPass(VkFormat colorFormat, VkFormat depthFormat = VK_FORMAT_UNDEFINED, VkImageLayout layoutColor = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+  // viewMask  0 ȊOw肷ƃ}`r[̃_[pXɂȂ(erbgA^b`g̃C[ɑΉ).
+  VkRenderPass CreateRenderPass(VkFormat colorFormat, VkFormat depthFormat = VK_FORMAT_UNDEFINED, VkImageLayout layoutColor = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, uint32_t viewMask = 0);
 
   struct ModelData
   {
@@ -134,26 +135,32 @@ public:
   // Pf̃f[^GPU֓].
   template<class T>
   ModelData CreateSimpleModel(const std::vector<T>& vertices, const std::vector<uint32_t>& indices)
+  {
+    return CreateSimpleModel(vertices.data(), uint32_t(sizeof(T)), uint32_t(vertices.size()), indices.data(), uint32_t(indices.size()));
+  }
+  // _/CfbNX̔z񂩂璼ڃXe[WOobt@֏œ](}bvt@CȂ).
+  ModelData CreateSimpleModel(const void* vertices, uint32_t vertexStride, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount)
   {
     ModelData model;
     VkMemoryPropertyFlags srcMemoryProps = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
     VkMemoryPropertyFlags dstMemoryProps = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-    VkBufferUsageFlags usageVB = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-    VkBufferUsageFlags usageIB = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    // _ƃCfbNX̓Rs[gVF[_[ǂ߂悤ɂĂ(NX^JOȂ).
+    VkBufferUsageFlags usageVB = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    VkBufferUsageFlags usageIB = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
     VkBufferCopy copyVB{}, copyIB{};
 
-    auto bufferSize = uint32_t(sizeof(T) * vertices.size());
+    auto bufferSize = vertexStride * vertexCount;
     auto uploadVB = CreateBuffer(bufferSize, usageVB, srcMemoryProps);
     model.resVertexBuffer = CreateBuffer(bufferSize, usageVB, dstMemoryProps);
-    WriteToHostVisibleMemory(uploadVB.memory, bufferSize, vertices.data());
-    model.vertexCount = uint32_t(vertices.size());
+    WriteToHostVisibleMemory(uploadVB.memory, bufferSize, vertices);
+    model.vertexCount = vertexCount;
     copyVB.size = bufferSize;
 
-    bufferSize = uint32_t(sizeof(uint32_t) * indices.size());
+    bufferSize = uint32_t(sizeof(uint32_t) * indexCount);
     auto uploadIB = CreateBuffer(bufferSize, usageIB, srcMemoryProps);
     model.resIndexBuffer = CreateBuffer(bufferSize, usageIB, dstMemoryProps);
-    WriteToHostVisibleMemory(uploadIB.memory, bufferSize, indices.data());
-    model.indexCount = uint32_t(indices.size());
+    WriteToHostVisibleMemory(uploadIB.memory, bufferSize, indices);
+    model.indexCount = indexCount;
     copyIB.size = bufferSize;
 
     auto command = CreateCommandBuffer();
@@ -198,6 +205,7 @@ protected:
   VkInstance m_vkInstance;
 
   VkPhysicalDeviceMemoryProperties m_physicalMemProps;
+  VkPhysicalDeviceMultiviewFeatures m_multiviewFeatures; // foCX쐬ɗLɂ}`r[@\.
   VkQueue m_deviceQueue;
   uint32_t  m_gfxQueueIndex;
   VkCommandPool m_commandPool;
@@ -0,0 +1,41 @@
+// ʎq_̕(VertexQuantizer ƑΉ).
+// p̒l̓pCvC쐬ɓꉻ萔Ŏw肷(VertexQuantizer::GetSpecializationInfo).
+
+layout(constant_id=0) const uint normalEncoding = 0u; // 0: _, 1: 8 ʑ 2x16bit, 2: 10:10:10:2
+layout(constant_id=1) const float positionScaleX = 1.0;
+layout(constant_id=2) const float positionScaleY = 1.0;
+layout(constant_id=3) const float positionScaleZ = 1.0;
+layout(constant_id=4) const float positionOffsetX = 0.0;
+layout(constant_id=5) const float positionOffsetY = 0.0;
+layout(constant_id=6) const float positionOffsetZ = 0.0;
+layout(constant_id=7) const uint positionEncoding = 0u; // 0: _, 1: 16bit UNORM
+
+vec4 DecodePosition(vec4 p)
+{
+  if (positionEncoding == 0u)
+  {
+    return vec4(p.xyz, 1.0);
+  }
+  vec3 scale = vec3(positionScaleX, positionScaleY, positionScaleZ);
+  vec3 offset = vec3(positionOffsetX, positionOffsetY, positionOffsetZ);
+  return vec4(offset + scale * p.xyz, 1.0);
+}
+
+vec3 DecodeNormal(vec4 n)
+{
+  if (normalEncoding == 1u)
+  {
+    vec3 v = vec3(n.xy, 1.0 - abs(n.x) - abs(n.y));
+    if (v.z < 0.0)
+    {
+      vec2 s = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+      v.xy = (1.0 - abs(n.yx)) * s;
+    }
+    return normalize(v);
+  }
+  if (normalEncoding == 2u)
+  {
+    return normalize(n.xyz * 2.0 - 1.0);
+  }
+  return n.xyz;
+}